@@ -11,19 +11,10 @@
 #define PRINT_ASSERT_INFO 0
 
 // Runtime information
+// compiles in the listener tracing, which is then selected with -listener-trace
 #define DEBUG_RUNTIME_LISTENER 1
 #define SUPPORT_PTR 0
 
-// Features
-#define DO_DSTAM 0
-#define DO_ASSERT_VERIFICATION 1
-
-// Encoding
-#define INT_ARITHMETIC 0
-
-// Optimization
-#define O1 1
-#define O2 0
-#define O3 0
+// The encoder features and optimizations are selected at runtime, see klee/Encode/EncodeOptions.h
 
 #endif // CONFIG_DEBUG_MACRO_H
\ No newline at end of file
@@ -16,6 +16,8 @@
 #include "klee/Thread/StackType.h"
 #include "klee/Config/DebugMacro.h"
 
+#include <set>
+
 #define BIT_WIDTH 64
 
 namespace klee {
@@ -32,6 +34,8 @@ public:
   };
 
   BitcodeListener(RuntimeDataManager *rdManager);
+  // copy the shadow memory and stacks, the stacks of the copy refer to its own address space
+  BitcodeListener(const BitcodeListener &other);
   virtual ~BitcodeListener();
 
   ListenerKind kind;
@@ -43,11 +47,17 @@ public:
 
   std::vector<ref<Expr>> arguments;
 
+  // the opcodes passed to beforeExecuteInstruction and afterExecuteInstruction, every instruction if empty
+  std::set<unsigned> opcodes;
+  bool handles(KInstruction *ki) const;
+
   virtual void beforeRunMethodAsMain(ExecutionState &state) = 0;
   virtual void beforeExecuteInstruction(ExecutionState &state, KInstruction *ki) = 0;
   virtual void afterExecuteInstruction(ExecutionState &state, KInstruction *ki) = 0;
   virtual void afterRunMethodAsMain(ExecutionState &state) = 0;
   virtual void executionFailed(ExecutionState &state, KInstruction *ki) = 0;
+  // copy of the listener between two instructions, events are replaced by their copies in eventMap
+  virtual BitcodeListener *snapshot(std::map<Event *, Event *> &eventMap) = 0;
 };
 
 } // namespace klee
@@ -0,0 +1,53 @@
+//===-- BoundedExplorer.h ---------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_CORE_BOUNDEDEXPLORER_H_
+#define LIB_CORE_BOUNDEDEXPLORER_H_
+
+#include <string>
+
+#include "klee/Encode/InterleavingExplorer.h"
+
+namespace klee {
+
+/**
+ * Explores the schedules with at most a bound of preemptions or delays. The unguided part of an execution runs
+ * without preemption, every switch to another enabled thread after the prefix of the trace is scheduled with the
+ * bound of the prefix plus the cost of the switch:
+ * - preemption bounding counts a switch away from a thread which could go on,
+ * - delay bounding counts the enabled threads the switch skips, in the order of the thread ids from the thread which
+ *   runs in the trace.
+ * Schedules over the bound are dropped, BoundedPrefixSearcher runs the scheduled ones by increasing bound.
+ */
+class BoundedExplorer : public InterleavingExplorer {
+public:
+  enum BoundType
+  {
+    Preemption,
+    Delay
+  };
+
+private:
+  BoundType type;
+  unsigned maxBound;
+
+  // the bound the schedule spends to run the thread at position instead of the thread of the trace
+  unsigned getCost(unsigned position, unsigned threadId);
+
+public:
+  BoundedExplorer(RuntimeDataManager *data, BoundType type, unsigned maxBound);
+
+  void work(Prefix *prefix) override;
+
+  static std::string getTypeName(BoundType type);
+};
+
+} // namespace klee
+
+#endif /* LIB_CORE_BOUNDEDEXPLORER_H_ */
@@ -0,0 +1,67 @@
+//===-- DPOR.h --------------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_CORE_DPOR_H_
+#define LIB_CORE_DPOR_H_
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "klee/Encode/InterleavingExplorer.h"
+#include "klee/Thread/VectorClock.h"
+
+namespace klee {
+
+/**
+ * Dynamic partial-order reduction with sleep sets. Two accesses of different threads race if they are dependent (the
+ * same variable with a write among them, or the same synchronization object) and no happens-before relation orders
+ * them. For every race of the current trace a prefix is scheduled which runs the thread of the later access at the
+ * position of the earlier one, so only one interleaving of the independent accesses is explored. The threads a
+ * prefix may not run first without repeating an explored interleaving travel with it as its sleep set.
+ */
+class DPOR : public InterleavingExplorer {
+private:
+  // a thread the position is scheduled for, with the access its pending events end with
+  struct Scheduled {
+    unsigned threadId;
+    // UINT_MAX if the pending events end with a join or the thread exits
+    unsigned access;
+    // the thread the pending events join, 0 unless they end with a join
+    unsigned joined;
+  };
+
+  // per access: the accesses of its thread up to this one, compared with the components of the vector clocks
+  std::vector<unsigned> localIndices;
+  std::vector<VectorClock> clocks;
+  // position -> threads to run there, in the order they are found
+  std::map<unsigned, std::vector<unsigned>> backtrack;
+  // the sleep set of the prefix of the trace and the position each sleeping thread wakes up at
+  std::vector<std::pair<SleepingThread, unsigned>> sleeping;
+  unsigned prefixLength;
+
+  void findRaces();
+  void addBacktrack(unsigned position, unsigned threadId);
+  void initSleepSet(Prefix *prefix);
+  bool isAsleep(unsigned threadId, unsigned position);
+  Scheduled getScheduled(unsigned threadId, unsigned last);
+  bool isIndependent(const SleepingThread &thread, const Scheduled &scheduled);
+  SleepingThread getSleepingThread(const Scheduled &scheduled);
+  void schedule(unsigned position, unsigned threadId, std::vector<Scheduled> &done);
+
+public:
+  // the buffers are kept between the traces, create one DPOR for all of them
+  explicit DPOR(RuntimeDataManager *data);
+
+  void work(Prefix *prefix) override;
+};
+
+} // namespace klee
+
+#endif /* LIB_CORE_DPOR_H_ */
@@ -10,10 +10,12 @@
 #ifndef LIB_CORE_DTAM_
 #define LIB_CORE_DTAM_
 
-#include <map>
 #include <set>
 #include <string>
 #include <sys/time.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "klee/Encode/DTAMPoint.h"
 #include "klee/Encode/FilterSymbolicExpr.h"
@@ -26,21 +28,34 @@ class DTAM {
 private:
   RuntimeDataManager *runtimeData;
   Trace *trace;
-  std::map<std::string, DTAMPoint *> allWrite;
-  std::map<std::string, DTAMPoint *> allRead;
+  // the read points come first, the write points start at firstWrite
+  std::vector<DTAMPoint> points;
+  unsigned firstWrite;
+  std::unordered_map<std::string, unsigned> pointIds;
+  // taint flows from a point to the points it affects, the targets of point p are
+  // targets[offsets[p]] .. targets[offsets[p + 1]] - 1
+  std::vector<unsigned> offsets;
+  std::vector<unsigned> targets;
+  std::vector<bool> tainted;
+  std::vector<unsigned> worklist;
   struct timeval start, finish;
   double cost;
   FilterSymbolicExpr filter;
 
+  unsigned addPoint(Event *event);
+  void buildRows(const std::vector<std::pair<unsigned, unsigned>> &edges);
+
 public:
+  // the buffers are kept between the traces, create one DTAM for all of them
   DTAM(RuntimeDataManager *data);
   virtual ~DTAM();
 
   void prepareDTAMParallel();
   void prepareDTAMhybrid();
-  void initTaint(std::vector<DTAMPoint *> &remainPoint);
-  void propagateTaint(std::vector<DTAMPoint *> &remainPoint);
+  void initTaint();
+  void propagateTaint();
   void logTaint(std::set<std::string> &taint);
+  // analyses the current trace
   void work();
 };
 
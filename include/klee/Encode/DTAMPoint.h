@@ -11,18 +11,16 @@
 #define LIB_CORE_DTAMPOINT_H_
 
 #include <string>
-#include <vector>
+
+#include "klee/Thread/VectorClock.h"
 
 class DTAMPoint {
 public:
   std::string name;
-  bool isTaint;
-  std::vector<DTAMPoint *> affectingPoint;
-  std::vector<DTAMPoint *> affectedPoint;
-  std::vector<unsigned> vectorClock;
+  klee::VectorClock vectorClock;
 
 public:
-  DTAMPoint(std::string _name, std::vector<unsigned> _vectorClock);
+  DTAMPoint(std::string _name, const klee::VectorClock &_vectorClock);
   virtual ~DTAMPoint();
   bool operator<=(DTAMPoint *point);
 };
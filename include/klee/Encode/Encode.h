@@ -10,10 +10,12 @@
 #ifndef ENCODE_H_
 #define ENCODE_H_
 
+#include <cassert>
 #include <stack>
 #include <utility>
 #include <z3++.h>
 
+#include "klee/Encode/EncodeOptions.h"
 #include "klee/Encode/Event.h"
 #include "klee/Encode/FilterSymbolicExpr.h"
 #include "klee/Encode/KQuery2Z3.h"
@@ -33,23 +35,34 @@ private:
   InterpreterHandler *interpreterHandler;
   // all data about encoding
   Trace *trace;
+  EncodeOptions options;
   context z3_ctx;
   solver z3_solver;
   solver z3_taint_solver;
+  // translates the symbolic expressions of the trace, sharing the translation of common subexpressions
+  KQuery2Z3 kqueryToZ3;
   FilterSymbolicExpr filter;
   unsigned formulaNum;
   unsigned solvingTimes;
+  // read-from candidates dropped by happens-before
+  unsigned prunedReadFrom;
 
 public:
-  Encode(RuntimeDataManager *data, InterpreterHandler *ih) : runtimeData(data), z3_solver(z3_ctx), z3_taint_solver(z3_ctx) {
+  Encode(RuntimeDataManager *data, InterpreterHandler *ih, const EncodeOptions &options)
+      : runtimeData(data), options(options), z3_solver(z3_ctx), z3_taint_solver(z3_ctx),
+        kqueryToZ3(z3_ctx, options.intArithmetic) {
     interpreterHandler = ih;
     trace = data->getCurrentTrace();
     formulaNum = 0;
     solvingTimes = 0;
+    prunedReadFrom = 0;
+    coneOfInfluence = NULL;
+    sliceEvents = NULL;
   }
   ~Encode() {
     runtimeData->allFormulaNum += formulaNum;
     runtimeData->solvingTimes += solvingTimes;
+    runtimeData->prunedReadFrom += prunedReadFrom;
   }
   void encodeTraceToFormulas();
   void constraintEncoding();
@@ -67,6 +80,10 @@ private:
   // first--equality, second--constrait which equality must satisfy.
 
   vector<pair<Event *, expr>> ifFormula;
+  // the symbolic expressions of ifFormula
+  vector<ref<Expr>> ifSymbolicExpr;
+  // the branches with a single target, which always keep their direction
+  vector<pair<ref<Expr>, expr>> pathFormula;
   vector<pair<Event *, expr>> assertFormula;
   vector<pair<Event *, expr>> rwFormula;
 
@@ -76,6 +93,10 @@ private:
   void buildPartialOrderFormula(solver z3_solver_po);
   void buildReadWriteFormula(solver z3_solver_rw);
   void buildSynchronizeFormula(solver z3_solver_sync);
+  // a disjunction per pair of critical sections of a mutex which happens-before leaves unordered
+  void buildPairwiseLockFormula(solver z3_solver_sync, vector<LockPair *> &lockPairs);
+  // ranks the critical sections of a mutex, for -lock-encoding=linear
+  void buildLinearLockFormula(solver z3_solver_sync, unsigned mutexIndex, vector<LockPair *> &lockPairs);
   void buildInitTaintFormula(solver z3_solver_it);
   void buildTaintMatchFormula(solver z3_solver_tm);
   void buildTaintProgatationFormula(solver z3_solver_tp);
@@ -83,7 +104,37 @@ private:
 
   expr buildExprForConstantValue(Value *V, bool isLeft, string prefix);
 
-  void concretizeReadValue(Event *curr);
+  // keep the values read before the flipped branch, asserted once for all flips
+  void concretizeReadValue(solver z3_solver_cr);
+  // whether event happens before the branch selected by selectFlippedBranch()
+  expr isBeforeFlippedBranch(Event *event);
+  // the assumption literal which flips ifFormula[index] on z3_solver_flip
+  expr selectFlippedBranch(unsigned index, solver z3_solver_flip);
+  // solve the flips on -flip-threads threads, each with a translated copy of z3_solver
+  void flipIfBranchesInParallel(const vector<unsigned> &flips);
+  // solve the flips of each variable component on the formulas of that component, for -slice-flips
+  void flipIfBranchesSliced(const vector<unsigned> &flips);
+  void buildVariableComponents();
+  // the events whose order matters to the flips of the component of cone: its accesses and branches, the thread
+  // create/join points, the wait/signal and barrier events and the critical sections around its accesses. The
+  // conflicting accesses of the other components are added with the order pairs of the trace between them.
+  void buildSlice(const set<string> &cone, vector<bool> &slice, vector<pair<Event *, Event *>> &keptOrders);
+  // the variables read by ifFormula[i]
+  vector<set<string>> ifRelatedVars;
+  // variable name -> component of the variables connected by branches and stores
+  map<string, unsigned> variableComponents;
+  // restricts the read-write, path condition, initial value and concretized read formulas to these variables when not
+  // NULL
+  const set<string> *coneOfInfluence;
+  bool isInCone(const string &var) { return !coneOfInfluence || coneOfInfluence->count(var); }
+  // restricts the memory model, partial order and lock formulas to these events when not NULL, indexed by eventId
+  const vector<bool> *sliceEvents;
+  bool isInSlice(Event *event) { return !sliceEvents || (*sliceEvents)[event->eventId]; }
+  Event *getFirstInSlice(vector<Event *> &thread);
+  Event *getLastInSlice(vector<Event *> &thread);
+  std::string getFlipName(unsigned index);
+  // schedule the prefix of a successful flip and update the statistics, m is the model of a sat flip
+  void recordFlip(unsigned index, check_result result, double cost, model *m);
 
 private:
   void markLatestWriteForGlobalVar();
@@ -91,7 +142,25 @@ private:
   map<string, Event *> latestWriteOneThread;
   map<int, map<string, Event *>> allThreadLastWrite;
   // int:eventid.add data in function buildMemoryModelFormula
-  map<string, expr> eventNameInZ3;
+  // indexed by Event::orderId, built once the events are clustered
+  vector<expr> orderExprs;
+  vector<bool> hasOrderExpr;
+  // indexed by Event::eventId, the value read or written by a global variable access
+  vector<expr> valueExprs;
+  vector<bool> hasValueExpr;
+  void buildEventTerms();
+  // fork/join vector clocks of the global and lock events, indexed by Event::eventId
+  vector<vector<unsigned>> eventClocks;
+  void buildHappensBefore();
+  bool happensBefore(Event *first, Event *second);
+  // drop the writes the read can not read from, returns whether the read may read the initial value
+  bool pruneReadFrom(Event *read, vector<Event *> &writes);
+  expr &getOrderExpr(Event *event) {
+    assert(event->orderId < orderExprs.size() && hasOrderExpr[event->orderId] &&
+           "the cluster of the event has no order term");
+    return orderExprs[event->orderId];
+  }
+  expr &getValueExpr(Event *event, const z3::sort &varType);
   z3::sort llvmTy_to_z3Ty(const Type *typ);
 
   // key--local var, value--index..like ssa
@@ -105,10 +174,10 @@ private:
   expr taintReadFromWriteFormula(Event *read, Event *write, string var);
   bool taintReadFromInitFormula(Event *read, expr &ret);
 
-  void computePrefix(vector<Event *> &vecEvent, Event *ifEvent);
+  void computePrefix(vector<Event *> &vecEvent, Event *ifEvent, model &m);
   void printAssertionInfo();
-  void printPrefixInfo(Prefix *prefix, Event *ifEvent);
-  void printSolvingSolution(Prefix *prefix, expr ifExpr);
+  void printPrefixInfo(Prefix *prefix, Event *ifEvent, model &m);
+  void printSolvingSolution(Prefix *prefix, expr ifExpr, model &m);
 
   void printSourceLine(string fileName, vector<Event *> &trace);
   string readLine(string filename, unsigned line);
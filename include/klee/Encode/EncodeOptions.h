@@ -0,0 +1,44 @@
+//===-- EncodeOptions.h -----------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_CORE_ENCODEOPTIONS_H_
+#define LIB_CORE_ENCODEOPTIONS_H_
+
+#include <string>
+
+namespace klee {
+
+/**
+ * The optimizations and features of the encoder, the defaults are those of the former compile-time switches in
+ * klee/Config/DebugMacro.h.
+ */
+struct EncodeOptions {
+  // drop the stores, reads and writes no branch or assertion depends on before encoding (formerly O1)
+  bool filterUnusedExprs;
+  // only flip the branches depending on a variable shared by several threads (formerly O2)
+  bool presolveSharedVars;
+  // fix the values read before the flipped branch which the branch does not depend on (formerly O3)
+  bool concretizeReadValues;
+  // carry out the taint analysis after each trace (formerly DO_DSTAM)
+  bool doDSTAM;
+  // verify the assertions on each trace (formerly DO_ASSERT_VERIFICATION)
+  bool verifyAssertions;
+  // encode the integers as unbounded integers instead of 64 bit vectors (formerly INT_ARITHMETIC)
+  bool intArithmetic;
+
+  EncodeOptions();
+  // the options selected on the command line
+  static EncodeOptions fromCommandLine();
+  // a single line, reported next to the costs of the phases
+  std::string toString() const;
+};
+
+} // namespace klee
+
+#endif /* LIB_CORE_ENCODEOPTIONS_H_ */
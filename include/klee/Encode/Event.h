@@ -13,6 +13,7 @@
 #include "klee/ADT/Ref.h"
 #include "klee/Expr/Expr.h"
 #include "klee/Module/KInstruction.h"
+#include "klee/Thread/VectorClock.h"
 
 #include <llvm/IR/Function.h>
 
@@ -33,6 +34,8 @@ public:
   unsigned threadId;
   unsigned eventId;
   unsigned threadEventId;
+  // dense index of the order variable of the event, events clustered by Encode::controlGranularity share one
+  unsigned orderId;
   std::string eventName;
   KInstruction *inst;
   // name of load or store variable
@@ -52,7 +55,7 @@ public:
   bool isFunctionWithSourceCode; 
   // set for called function. all callinst use it.@14.12.02 
   llvm::Function *calledFunction; 
-  std::vector<unsigned> vectorClock;
+  VectorClock vectorClock;
   std::vector<ref<klee::Expr>> instParameter;
   std::vector<ref<klee::Expr>> relatedSymbolicExpr;
 
@@ -0,0 +1,43 @@
+//===-- ExplorationOptions.h ------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_CORE_EXPLORATIONOPTIONS_H_
+#define LIB_CORE_EXPLORATIONOPTIONS_H_
+
+#include <string>
+
+namespace klee {
+
+/**
+ * How the schedules are explored after the initial run, by default the branches of each trace are flipped with the
+ * solver.
+ */
+struct ExplorationOptions {
+  // explore the interleavings by DPOR instead of flipping the branches of each trace with the solver
+  bool dpor;
+  // explore the schedules with at most this many preemptions, or delays, instead of flipping the branches, -1 for
+  // no bounded exploration
+  int scheduleBound;
+  bool delayBounding;
+  // run the program this many times with the PCT scheduler after the initial run instead of exploring the schedules,
+  // they use the seeds pctSeed, pctSeed+1, ..., pctSeed+pctRuns-1
+  unsigned pctRuns;
+  unsigned pctDepth;
+  unsigned pctSeed;
+
+  ExplorationOptions();
+  // the options selected on the command line
+  static ExplorationOptions fromCommandLine();
+  // a single line, reported next to the encoder options
+  std::string toString() const;
+};
+
+} // namespace klee
+
+#endif /* LIB_CORE_EXPLORATIONOPTIONS_H_ */
@@ -0,0 +1,97 @@
+//===-- InterleavingExplorer.h ----------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_CORE_INTERLEAVINGEXPLORER_H_
+#define LIB_CORE_INTERLEAVINGEXPLORER_H_
+
+#include <climits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "klee/Encode/Prefix.h"
+#include "klee/Encode/RuntimeDataManager.h"
+#include "klee/Encode/Trace.h"
+
+namespace klee {
+
+/**
+ * Schedules other interleavings of the current trace without the solver: a prefix replays the path up to a position
+ * and then runs the pending events of another thread there. The explorer indexes the accesses of the path to
+ * variables and synchronization objects, which are the only events where running another thread makes a
+ * difference.
+ */
+class InterleavingExplorer {
+protected:
+  // an access of an event of Trace::path to a variable or a synchronization object
+  struct Access {
+    unsigned position;
+    unsigned threadId;
+    unsigned object;
+    // the lock, wait, signal and barrier accesses are writes
+    bool isWrite;
+    // a lock acquires the mutex released by the last unlock
+    bool isLock;
+    // a pthread_cond_wait, which blocks until the condition is signalled
+    bool isWait;
+  };
+
+  RuntimeDataManager *runtimeData;
+  Trace *trace;
+  std::vector<std::string> objects;
+  std::unordered_map<std::string, unsigned> objectIds;
+  // ordered by position
+  std::vector<Access> accesses;
+  // positions of the events of each thread
+  std::map<unsigned, std::vector<unsigned>> threadEvents;
+  // thread id -> position of the pthread_create of the thread
+  std::map<unsigned, unsigned> createdAt;
+  // position of a pthread_create -> the created thread
+  std::multimap<unsigned, unsigned> creates;
+  // position of a pthread_join -> the joined thread
+  std::map<unsigned, unsigned> joins;
+  // position of an unlock -> the released mutex
+  std::multimap<unsigned, unsigned> releases;
+  // (mutex, lock position, unlock position) of every lock, the unlock position is UINT_MAX if it is never unlocked
+  std::vector<std::pair<unsigned, std::pair<unsigned, unsigned>>> lockSpans;
+  // the events which end the pending events of a thread: the accesses and the joins
+  std::vector<bool> stops;
+
+  // indexes the current trace
+  void indexTrace();
+  // the first access at position, UINT_MAX if there is none
+  unsigned getAccessAt(unsigned position);
+  // the events the thread executes next at position, up to and including its next access or join
+  bool getPendingEvents(unsigned threadId, unsigned position, std::vector<unsigned> &pending);
+  // the thread has called a lock, join or wait before position which has not returned there
+  bool isBlocked(unsigned threadId, unsigned position);
+  bool isEnabled(unsigned threadId, unsigned position);
+  // a prefix running the pending events of the thread at position, the caller schedules it
+  Prefix *createPrefix(unsigned position, unsigned threadId, const std::string &name);
+
+private:
+  unsigned getObject(const std::string &name);
+  void addAccess(Event *event, unsigned position, const std::string &name, bool isWrite, bool isLock, bool isWait);
+  // the mutex is locked at position by another thread than threadId
+  bool isHeld(unsigned object, unsigned position, unsigned threadId);
+
+public:
+  explicit InterleavingExplorer(RuntimeDataManager *data);
+  virtual ~InterleavingExplorer() = default;
+
+  // schedules the interleavings of the current trace, prefix is the one it was executed with, NULL for the first
+  // execution
+  virtual void work(Prefix *prefix) = 0;
+};
+
+} // namespace klee
+
+#endif /* LIB_CORE_INTERLEAVINGEXPLORER_H_ */
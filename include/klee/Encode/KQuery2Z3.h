@@ -14,12 +14,16 @@
 #define KQUERY2Z3_H_
 
 #include "klee/Expr/Expr.h"
+#include "klee/Expr/ExprHashMap.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/Support/DataTypes.h"
 
 #include <assert.h>
 #include <iostream>
+#include <map>
 #include <sstream>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <z3++.h>
 #include <z3.h>
@@ -39,7 +43,21 @@ private:
   std::vector<ref<Expr>> kqueryExpr;
   // the parameter convert means convert a none float point to a float point.
   z3::expr eachExprToZ3(ref<Expr> &ele);
+  z3::expr translateExpr(ref<Expr> &ele);
   z3::context &z3_ctx;
+  // integers are unbounded integers instead of bit vectors
+  bool intArithmetic;
+  // the translated subexpressions, keyed by structure and by the float signature they were translated with, since
+  // Expr::compare ignores the isFloat flags the translation depends on
+  ExprHashMap<std::vector<std::pair<unsigned, z3::expr>>> z3Exprs;
+  // (isFloat, float signatures of the kids) -> float signature, equal signatures mean equal flags
+  std::map<std::vector<unsigned>, unsigned> floatSignatures;
+  // the float signatures of the expressions looked up since the last isFloat flag was set
+  std::unordered_map<const Expr *, std::pair<ref<Expr>, unsigned>> exprSignatures;
+  // number of isFloat flags set by the translation
+  unsigned floatMarks;
+  void markFloat(ref<Expr> &e);
+  unsigned getFloatSignature(const ref<Expr> &e);
   std::vector<z3::expr> vecZ3Expr;
   std::vector<z3::expr> vecZ3ExprTest;
   std::vector<ref<Expr>> kqueryExprTest;
@@ -47,8 +65,8 @@ private:
   int validNum(std::string &str);
 
 public:
-  KQuery2Z3(std::vector<ref<Expr>> &_queryExpr, z3::context &_z3_ctx);
-  KQuery2Z3(z3::context &_z3_ctx);
+  KQuery2Z3(std::vector<ref<Expr>> &_queryExpr, z3::context &_z3_ctx, bool _intArithmetic = false);
+  KQuery2Z3(z3::context &_z3_ctx, bool _intArithmetic = false);
   ~KQuery2Z3();
 
   // only public function for call to complete convert kqueryExpr to z3Expr
@@ -14,11 +14,15 @@
 
 #include "../../../lib/Core/ExecutionState.h"
 #include "klee/Encode/BitcodeListener.h"
+#include "klee/Encode/EncodeOptions.h"
+#include "klee/Encode/ExplorationOptions.h"
 #include "klee/Encode/RuntimeDataManager.h"
+#include "klee/Module/KInstruction.h"
 
 namespace klee {
 class DTAM;
 class Encode;
+class InterleavingExplorer;
 } /* namespace klee */
 
 namespace klee {
@@ -31,8 +35,27 @@ private:
   InterpreterHandler *interpreterHandler;
   Encode *encoder;
   DTAM *dtam;
+  // DPOR or the bounded exploration, created for the first trace
+  InterleavingExplorer *explorer;
   struct timeval start, finish;
   double cost;
+  EncodeOptions encodeOptions;
+  ExplorationOptions explorationOptions;
+
+  // the listeners of an execution are deleted once it ends
+  void deleteListeners();
+
+  // whether the listener is called for the instruction, the answer of every listener kind is cached in ki
+  static bool isDispatched(BitcodeListener *bit, KInstruction *ki) {
+    unsigned kindBit = 1u << bit->kind;
+    if (!(ki->listenerKindsChecked & kindBit)) {
+      ki->listenerKindsChecked |= kindBit;
+      if (bit->handles(ki)) {
+        ki->listenerKindsHandling |= kindBit;
+      }
+    }
+    return ki->listenerKindsHandling & kindBit;
+  }
 
 public:
   ListenerService(Executor *executor);
@@ -44,6 +67,8 @@ public:
   void popListener();
 
   RuntimeDataManager *getRuntimeDataManager();
+  const EncodeOptions &getEncodeOptions();
+  const ExplorationOptions &getExplorationOptions();
   void printCurrentTrace(bool);
   void Preparation();
   void beforeRunMethodAsMain(Executor *executor, ExecutionState &state, llvm::Function *f, MemoryObject *argvMO,
@@ -56,6 +81,11 @@ public:
   void startControl(Executor *executor);
   void endControl(Executor *executor);
 
+  // copy the listeners and the current trace for a checkpoint
+  void snapshot(std::vector<BitcodeListener *> &listeners, Trace *&trace);
+  // replace the listeners pushed by startControl with copies of the ones saved in a checkpoint
+  void restore(Executor *executor, const std::vector<BitcodeListener *> &listeners, Trace *trace);
+
   void taintAnalysis();
 };
 
@@ -0,0 +1,52 @@
+//===-- ListenerTrace.h -----------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_CORE_LISTENERTRACE_H_
+#define LIB_CORE_LISTENERTRACE_H_
+
+#include "klee/Config/DebugMacro.h"
+
+#include <string>
+
+namespace klee {
+struct KInstruction;
+
+/**
+ * Debug tracing of the listeners, selected with -listener-trace and narrowed down to some threads, functions or
+ * opcodes with -listener-trace-thread, -listener-trace-function and -listener-trace-opcode. It is off by default,
+ * and compiled out entirely when DEBUG_RUNTIME_LISTENER is 0.
+ */
+class ListenerTrace {
+public:
+  enum Level
+  {
+    Off,
+    // every executed instruction
+    Instructions,
+    // in addition the values the listeners compute
+    Details
+  };
+
+  static Level level;
+
+  static bool isEnabled(Level l) { return DEBUG_RUNTIME_LISTENER && level >= l; }
+  // whether the instruction passes the thread, function and opcode filters
+  static bool matches(unsigned threadId, KInstruction *ki);
+  static void traceInstruction(unsigned threadId, KInstruction *ki);
+  // whether the values the listeners compute for the instruction are traced
+  static bool isTracingDetails(unsigned threadId, KInstruction *ki) {
+    return isEnabled(Details) && matches(threadId, ki);
+  }
+  // trace a value computed for the instruction if isTracingDetails(), check it first to skip building the message
+  static void traceDetails(unsigned threadId, KInstruction *ki, const std::string &message);
+};
+
+} // namespace klee
+
+#endif /* LIB_CORE_LISTENERTRACE_H_ */
@@ -45,6 +45,7 @@ namespace klee {
 class PSOListener : public BitcodeListener {
 public:
   PSOListener(Executor *executor, RuntimeDataManager *rdManager);
+  PSOListener(const PSOListener &other, std::map<Event *, Event *> &eventMap);
   virtual ~PSOListener();
 
   void beforeRunMethodAsMain(ExecutionState &initialState);
@@ -52,6 +53,7 @@ public:
   void afterExecuteInstruction(ExecutionState &state, KInstruction *ki);
   void afterRunMethodAsMain(ExecutionState &state);
   void executionFailed(ExecutionState &state, KInstruction *ki);
+  BitcodeListener *snapshot(std::map<Event *, Event *> &eventMap);
 
 private:
   Executor *executor;
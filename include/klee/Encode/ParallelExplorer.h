@@ -0,0 +1,88 @@
+//===-- ParallelExplorer.h --------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_CORE_PARALLELEXPLORER_H_
+#define LIB_CORE_PARALLELEXPLORER_H_
+
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+#include "klee/Encode/Prefix.h"
+#include "klee/Encode/RuntimeDataManager.h"
+#include "klee/Encode/Trace.h"
+
+namespace klee {
+class KModule;
+
+/**
+ * One end of the pipe pair between the coordinator and a forked worker. Every message is a single line, the first
+ * word is the message kind:
+ *   coordinator -> worker: RUN <traceId> [prefix], NEW, OLD, QUIT
+ *   worker -> coordinator: TRACE <traceId> <n> <abstract>..., PREFIX <prefix>, DONE <traceId>, STATS <statistics>
+ */
+class WorkerChannel {
+private:
+  int readFd;
+  int writeFd;
+  std::string buffer;
+
+public:
+  pid_t pid;
+  // the worker is running a prefix, only used by the coordinator
+  bool busy;
+  unsigned traceId;
+  // the bound of the prefix the worker is running, -1 if there is none
+  int bound;
+
+  WorkerChannel(int readFd, int writeFd, pid_t pid);
+  ~WorkerChannel();
+
+  int getReadFd() { return readFd; }
+  bool writeLine(const std::string &line);
+  // blocking read of the next complete line
+  bool readLine(std::string &line);
+  // non-blocking variant, only consumes what is buffered or available on the pipe
+  bool fillBuffer();
+  bool nextBufferedLine(std::string &line);
+
+  // worker side: ask the coordinator whether the trace has been explored by any worker
+  bool isTraceUntested(Trace *trace);
+};
+
+/**
+ * Coordinator of the multi-worker verification mode. It owns the queue of prefixes in the RuntimeDataManager, hands
+ * one prefix at a time to each idle worker and collects the traces and new prefixes they report back.
+ */
+class ParallelExplorer {
+private:
+  RuntimeDataManager *rdManager;
+  std::vector<KInstruction *> instructions;
+  std::vector<WorkerChannel *> workers;
+  unsigned nextTraceId;
+
+  bool dispatch(WorkerChannel *worker, Prefix *prefix);
+  void handleMessage(WorkerChannel *worker, const std::string &line);
+  void shutdownWorkers();
+
+public:
+  ParallelExplorer(RuntimeDataManager *rdManager, KModule *kmodule);
+  ~ParallelExplorer();
+
+  // fork workerNum workers. Returns the channel to the coordinator in a worker process, NULL in the coordinator.
+  WorkerChannel *spawnWorkers(unsigned workerNum);
+  // drain the prefix queue with the workers until no prefix is left and every worker is idle
+  void coordinate();
+
+  const std::vector<KInstruction *> &getInstructions() { return instructions; }
+};
+
+} // namespace klee
+
+#endif /* LIB_CORE_PARALLELEXPLORER_H_ */
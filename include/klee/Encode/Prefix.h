@@ -20,6 +20,19 @@
 #include <vector>
 
 namespace klee {
+class KModule;
+class Trace;
+
+// a thread put to sleep by a DPOR prefix: running its next access first leads to an interleaving explored elsewhere,
+// until a thread executes an access dependent with it
+struct SleepingThread {
+  unsigned threadId;
+  // the variable or synchronization object of the next access of the thread, empty if it joins or exits next
+  std::string object;
+  bool isWrite;
+  // the thread the next join of the thread waits for, 0 if it does not join next
+  unsigned joined;
+};
 
 class Prefix {
 public:
@@ -30,12 +43,22 @@ private:
   std::map<Event *, uint64_t> threadIdMap;
   EventIterator position;
   std::string name;
+  // events rebuilt by deserialize(), which belong to the prefix instead of a trace
+  std::vector<Event *> ownedEvents;
+  // the threads sleeping where the prefix ends, empty unless the prefix is scheduled by DPOR
+  std::vector<SleepingThread> sleepSet;
+  // the preemptions or delays of the schedule, -1 unless the prefix is scheduled by a bounded exploration
+  int bound;
+  // the trace the events belong to, set by RuntimeDataManager when the prefix is scheduled
+  Trace *trace;
 
 public:
   Prefix(std::vector<Event *> &eventList, std::map<Event *, uint64_t> &threadIdMap, std::string name);
   virtual ~Prefix();
   std::vector<Event *> *getEventList();
   void increasePosition();
+  // skip the first index events, used when the execution is resumed from a checkpoint
+  void setPosition(unsigned index);
   void reuse();
   bool isFinished();
   EventIterator begin();
@@ -47,6 +70,20 @@ public:
   void print(llvm::raw_ostream &out);
   KInstruction *getCurrentInst();
   std::string getName();
+  std::vector<SleepingThread> &getSleepSet();
+  int getBound();
+  void setBound(int bound);
+  Trace *getTrace();
+  void setTrace(Trace *trace);
+  // whether the events were rebuilt by deserialize() instead of referring to a trace
+  bool ownsEvents();
+
+  // write the prefix as one whitespace separated record, instructions are referred by InstructionInfo::id
+  void serialize(std::ostream &out);
+  // rebuild a prefix written by serialize(), instructions is indexed by InstructionInfo::id
+  static Prefix *deserialize(std::istream &in, const std::vector<KInstruction *> &instructions);
+  // the instructions of kmodule indexed by InstructionInfo::id, as deserialize() expects them
+  static void indexInstructions(KModule *kmodule, std::vector<KInstruction *> &instructions);
 };
 
 } /* namespace klee */
@@ -0,0 +1,164 @@
+//===-- PrefixSearcher.h ----------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_CORE_PREFIXSEARCHER_H_
+#define LIB_CORE_PREFIXSEARCHER_H_
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "klee/ADT/RNG.h"
+#include "klee/Encode/Prefix.h"
+#include "klee/Encode/Trace.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+namespace klee {
+
+/**
+ * A PrefixSearcher decides which of the scheduled prefixes is executed next, like Searcher does for states. The
+ * searcher owns the prefixes until they are selected.
+ */
+class PrefixSearcher {
+public:
+  enum SearchType
+  {
+    FIFO,
+    Shortest,
+    UncoveredBranch,
+    FewestContextSwitches,
+    Random
+  };
+
+  virtual ~PrefixSearcher() = default;
+
+  // removes the selected prefix from the searcher, returns NULL if no prefix is left
+  virtual Prefix *selectPrefix() = 0;
+  virtual void addPrefix(Prefix *prefix) = 0;
+  // notifies the searcher about an executed trace
+  virtual void update(Trace *trace) {}
+  // notifies the searcher that a selected prefix is run, the selected prefixes dropped as redundant are not
+  virtual void run(Prefix *prefix) {}
+  virtual unsigned long size() = 0;
+  bool empty() { return size() == 0; }
+  // the prefixes left, in no particular order
+  virtual void getPrefixes(std::vector<Prefix *> &prefixes) = 0;
+  virtual void printName(llvm::raw_ostream &os) = 0;
+
+  static PrefixSearcher *create(SearchType type, unsigned seed);
+};
+
+// the prefixes are executed in the order they are found
+class FIFOPrefixSearcher final : public PrefixSearcher {
+  std::deque<Prefix *> prefixes;
+
+public:
+  Prefix *selectPrefix() override;
+  void addPrefix(Prefix *prefix) override;
+  unsigned long size() override { return prefixes.size(); }
+  void getPrefixes(std::vector<Prefix *> &result) override;
+  void printName(llvm::raw_ostream &os) override { os << "FIFOPrefixSearcher\n"; }
+};
+
+// the prefix with the smallest weight first, prefixes of the same weight in the order they are found
+class WeightedPrefixSearcher final : public PrefixSearcher {
+public:
+  enum WeightType
+  {
+    EventNum,
+    ContextSwitchNum
+  };
+
+private:
+  // (weight, sequence number), kept as a min-heap
+  typedef std::pair<std::pair<uint64_t, uint64_t>, Prefix *> HeapEntry;
+  std::vector<HeapEntry> heap;
+  WeightType type;
+  uint64_t nextSequence;
+
+  uint64_t getWeight(Prefix *prefix);
+
+public:
+  explicit WeightedPrefixSearcher(WeightType type);
+  Prefix *selectPrefix() override;
+  void addPrefix(Prefix *prefix) override;
+  unsigned long size() override { return heap.size(); }
+  void getPrefixes(std::vector<Prefix *> &result) override;
+  void printName(llvm::raw_ostream &os) override;
+};
+
+// prefixes flipping a branch direction which no executed or selected prefix has taken yet go first
+class UncoveredBranchPrefixSearcher final : public PrefixSearcher {
+  std::list<Prefix *> prefixes;
+  // (InstructionInfo::id, direction) of the covered branches
+  std::set<uint64_t> coveredBranches;
+
+  static uint64_t getFlippedBranch(Prefix *prefix);
+
+public:
+  Prefix *selectPrefix() override;
+  void addPrefix(Prefix *prefix) override;
+  void update(Trace *trace) override;
+  unsigned long size() override { return prefixes.size(); }
+  void getPrefixes(std::vector<Prefix *> &result) override;
+  void printName(llvm::raw_ostream &os) override { os << "UncoveredBranchPrefixSearcher\n"; }
+};
+
+// picks a prefix uniformly at random, the order only depends on the seed
+class RandomPrefixSearcher final : public PrefixSearcher {
+  std::vector<Prefix *> prefixes;
+  RNG theRNG;
+  unsigned seed;
+
+public:
+  explicit RandomPrefixSearcher(unsigned seed);
+  Prefix *selectPrefix() override;
+  void addPrefix(Prefix *prefix) override;
+  unsigned long size() override { return prefixes.size(); }
+  void getPrefixes(std::vector<Prefix *> &result) override;
+  void printName(llvm::raw_ostream &os) override;
+};
+
+// the prefixes of a bounded exploration by increasing bound, reports the executions and the branch directions
+// covered when it moves on to the next bound or runs out of prefixes
+class BoundedPrefixSearcher final : public PrefixSearcher {
+  // (bound, sequence number), kept as a min-heap
+  typedef std::pair<std::pair<uint64_t, uint64_t>, Prefix *> HeapEntry;
+  std::vector<HeapEntry> heap;
+  uint64_t nextSequence;
+  std::string boundName;
+  unsigned currentBound;
+  // the executions selected with the current bound, including the first execution for bound 0
+  unsigned executions;
+  // no execution has been selected since the current bound was reported
+  bool reported;
+  // (InstructionInfo::id, direction) of the covered branches
+  std::set<uint64_t> coveredBranches;
+
+  void reportBound();
+
+public:
+  explicit BoundedPrefixSearcher(const std::string &boundName);
+  Prefix *selectPrefix() override;
+  void addPrefix(Prefix *prefix) override;
+  void update(Trace *trace) override;
+  void run(Prefix *prefix) override;
+  unsigned long size() override { return heap.size(); }
+  void getPrefixes(std::vector<Prefix *> &result) override;
+  void printName(llvm::raw_ostream &os) override;
+};
+
+} // namespace klee
+
+#endif /* LIB_CORE_PREFIXSEARCHER_H_ */
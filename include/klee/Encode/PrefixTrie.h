@@ -0,0 +1,80 @@
+//===-- PrefixTrie.h --------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_CORE_PREFIXTRIE_H_
+#define LIB_CORE_PREFIXTRIE_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "klee/Encode/Event.h"
+#include "klee/Encode/Prefix.h"
+#include "klee/Encode/Trace.h"
+
+namespace klee {
+
+/**
+ * Index of the prefixes which have been scheduled and of the paths of the executed traces. A step of the trie is an
+ * executed instruction: its thread, its instruction and, for a conditional branch, the chosen direction. A prefix is
+ * indexed with its last branch flipped, since that is the path it asks the executor to take. A path taken within a
+ * lower preemption or delay bound than before is not a duplicate: the bounded exploration goes on further from it.
+ */
+class PrefixTrie {
+private:
+  struct Node {
+    std::vector<std::pair<uint64_t, Node *>> children;
+    // the lowest bound of the scheduled prefixes which end at this node, NOT_REACHED if there is none
+    unsigned scheduledBound;
+    // the lowest bound of the executed traces which pass through this node, NOT_REACHED if there is none
+    unsigned exploredBound;
+    // the scheduled prefix of scheduledBound while it waits in the schedule set
+    Prefix *queued;
+
+    Node() : scheduledBound(NOT_REACHED), exploredBound(NOT_REACHED), queued(NULL) {}
+    Node *getChild(uint64_t step);
+    Node *getOrCreateChild(uint64_t step);
+  };
+
+  static const unsigned NOT_REACHED = ~0U;
+
+  Node root;
+
+  Node *find(Prefix *prefix);
+  // the bound of a prefix, 0 if it is not scheduled by a bounded exploration
+  static unsigned getBound(Prefix *prefix);
+
+public:
+  PrefixTrie() {}
+  ~PrefixTrie();
+  PrefixTrie(const PrefixTrie &) = delete;
+  PrefixTrie &operator=(const PrefixTrie &) = delete;
+
+  // index the prefix, returns false if the same prefix has been scheduled or an executed trace already took its path,
+  // within the same or a lower bound. If the same prefix still waits to be run, only the threads sleeping in both
+  // prefixes keep sleeping in it.
+  bool addPrefix(Prefix *prefix);
+  // the prefix leaves the schedule set, returns false if an executed trace took its path within the same or a lower
+  // bound, or the same prefix was scheduled within a lower bound, after it was scheduled
+  bool takePrefix(Prefix *prefix);
+  // a prefix taken by takePrefix() waits in the schedule set again
+  void returnPrefix(Prefix *prefix);
+  // bound is the one of the prefix which guided the trace, -1 if it was not guided by a bounded exploration
+  void addTrace(Trace *trace, int bound);
+
+  // the step of an executed event, flip takes the other direction of a conditional branch
+  static uint64_t getStep(Event *event, bool flip);
+  // rebuild the event of a step in trace, instructions is indexed by InstructionInfo::id. Returns NULL if the step
+  // refers to an unknown instruction.
+  static Event *createEvent(Trace *trace, uint64_t step, const std::vector<KInstruction *> &instructions);
+};
+
+} // namespace klee
+
+#endif /* LIB_CORE_PREFIXTRIE_H_ */
@@ -14,20 +14,30 @@
 #include <list>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "Prefix.h"
+#include "PrefixSearcher.h"
+#include "PrefixTrie.h"
 #include "Trace.h"
 
 namespace klee {
+class WorkerChannel;
 
 class RuntimeDataManager {
 
 private:
-  std::vector<Trace *> traceList;    // store all traces;
+  std::vector<Trace *> traceList;    // traces which have not been released
   Trace *currentTrace;               // trace associated with current execution
-  std::set<Trace *> testedTraceList; // traces which have been examined
-  std::list<Prefix *> scheduleSet;   // prefixes which have not been examined
+  unsigned traceNum;                 // all traces, including the released ones
+  unsigned testedTraceNum;           // traces which have been examined
+  // fingerprints of the examined traces
+  std::unordered_set<TraceFingerprint, TraceFingerprintHash> testedFingerprints;
+  PrefixSearcher *scheduleSet;       // prefixes which have not been examined
+  PrefixTrie prefixTrie;             // scheduled prefixes and paths of executed traces
+
+  void releaseTrace(Trace *trace);
 
 public:
   unsigned allFormulaNum;
@@ -37,9 +47,28 @@ public:
   unsigned satBranch;
   unsigned unSatBranchBySolve;
   unsigned unSatBranchByPreSolve;
+  // branches -slice-flips does not flip since their condition reads no shared variable
+  unsigned constantBranch;
+  // prefixes dropped because they were scheduled before or their path has been explored
+  unsigned redundantPrefix;
+  // read-from candidates the encoder dropped by happens-before
+  unsigned prunedReadFrom;
+  // prefixes DPOR scheduled for a race, and the ones it skipped since the racing thread was asleep
+  unsigned backtrackPoints;
+  unsigned sleepSetPruned;
+  // schedules the bounded exploration dropped for exceeding the bound
+  unsigned boundPruned;
 
   double runningCost;
   double solvingCost;
+  // the phases of solvingCost and the assertion verification, for comparing the encoder options
+  double encodeCost;
+  double flipCost;
+  double verifyCost;
+  // EncodeOptions::toString() of the run
+  std::string encodeOptions;
+  // ExplorationOptions::toString() of the run
+  std::string explorationOptions;
   double satCost;
   double unSatCost;
 
@@ -80,12 +109,28 @@ public:
   std::vector<unsigned> Send_Data_Hybrid;
   std::vector<unsigned> Send_Data_PTS;
 
+  // set in a verification worker, redundant traces are then detected across all workers by the coordinator
+  WorkerChannel *coordinator;
+
   RuntimeDataManager();
   virtual ~RuntimeDataManager();
 
   Trace *createNewTrace(unsigned traceId);
+  // continue recording in a trace restored from a checkpoint
+  void addResumedTrace(Trace *trace);
   Trace *getCurrentTrace();
-  void addToScheduleSet(Prefix *prefix);
+  // ends the current trace, it is freed with its events once no scheduled or running prefix refers to them
+  void releaseCurrentTrace();
+  // deletes a prefix returned by getNextPrefix(), and the trace it was built from if it was the last one
+  void releasePrefix(Prefix *prefix);
+  // puts a prefix returned by getNextPrefix() which could not be run back into the schedule set
+  void returnPrefix(Prefix *prefix);
+  // replaces the searcher deciding the order of the prefixes, the prefixes scheduled so far are moved over
+  void setPrefixSearcher(PrefixSearcher *searcher);
+  // takes the ownership of prefix, returns false and deletes it if it is redundant
+  bool addToScheduleSet(Prefix *prefix);
+  // bound is the one of the prefix which guided the trace, -1 if there is none
+  void addExploredTrace(Trace *trace, int bound);
   void printCurrentTrace(bool toFile);
   Prefix *getNextPrefix();
   void clearAllPrefix();
@@ -94,6 +139,10 @@ public:
   void printAllTrace(std::ostream &out);
   std::string getResultString();
   unsigned getTestedPathsNumber();
+  unsigned long getPrefixNumber();
+  // counters of a worker's runs, summed up by the coordinator
+  std::string getStatisticsRecord();
+  void mergeStatisticsRecord(std::istream &in);
 };
 
 } // namespace klee
@@ -42,6 +42,7 @@ public:
   void afterExecuteInstruction(ExecutionState &state, KInstruction *ki);
   void afterRunMethodAsMain(ExecutionState &state);
   void executionFailed(ExecutionState &state, KInstruction *ki);
+  BitcodeListener *snapshot(std::map<Event *, Event *> &eventMap);
 
 private:
   Executor *executor;
@@ -17,6 +17,9 @@
 #include <llvm/IR/Constant.h>
 #include <llvm/Support/raw_ostream.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <map>
 #include <set>
 #include <sstream>
@@ -27,6 +30,20 @@
 using namespace llvm;
 namespace klee {
 
+// 128-bit fingerprint of the branch abstract of a trace. Two traces with the same abstract, in any thread order, have
+// the same fingerprint.
+struct TraceFingerprint {
+  uint64_t low;
+  uint64_t high;
+
+  TraceFingerprint() : low(0), high(0) {}
+  bool operator==(const TraceFingerprint &other) const { return low == other.low && high == other.high; }
+};
+
+struct TraceFingerprintHash {
+  size_t operator()(const TraceFingerprint &fingerprint) const { return fingerprint.low ^ fingerprint.high; }
+};
+
 // added by xdzhang
 struct Wait_Lock {
   Event *wait;
@@ -40,7 +57,14 @@ struct LockPair {
   Event *unlockEvent;
 };
 
+/**
+ * A Trace owns the events it creates, they are freed together with the trace. Prefixes built from a trace refer to
+ * its events, so RuntimeDataManager keeps a trace until the last of its prefixes is released.
+ */
 class Trace {
+private:
+  // storage of the events, a deque never moves them
+  std::deque<Event> eventPool;
 
 public:
   enum TraceType
@@ -61,6 +85,8 @@ public:
   bool isUntested;
   // the type of trace
   TraceType traceType;
+  // prefixes built from the trace which are scheduled or running
+  unsigned prefixNum;
 
   std::vector<ref<klee::Expr>> storeSymbolicExpr;
   std::vector<ref<klee::Expr>> taintExpr;
@@ -133,6 +159,14 @@ public:
 
   void createAbstract();
   bool isEqual(Trace *trace);
+  TraceFingerprint getFingerprint();
+
+  // deep copy of the trace recorded so far, eventMap maps the events of this trace to their copies
+  Trace *snapshot(std::map<Event *, Event *> &eventMap);
+  // the copy of event in eventMap, created in this trace on demand
+  Event *copyEvent(Event *event, std::map<Event *, Event *> &eventMap);
+  // the copy of event made by snapshot(), NULL if event is not part of the copied trace
+  static Event *findCopy(Event *event, const std::map<Event *, Event *> &eventMap);
 
   std::string getAssemblyLine(std::string name);
   std::string getLine(std::string name);
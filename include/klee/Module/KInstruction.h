@@ -42,6 +42,11 @@ namespace klee {
     /// Destination register index.
     unsigned dest;
 
+    /// Bitcode listener kinds which have been asked whether they handle the
+    /// instruction, and those which do, see ListenerService.
+    unsigned listenerKindsChecked = 0;
+    unsigned listenerKindsHandling = 0;
+
   public:
     virtual ~KInstruction();
     std::string getSourceLocation() const;
@@ -25,6 +25,7 @@ namespace klee {
   extern llvm::cl::OptionCategory SolvingCat;
   extern llvm::cl::OptionCategory TerminationCat;
   extern llvm::cl::OptionCategory TestGenCat;
+  extern llvm::cl::OptionCategory VerificationCat;
 }
 
 #endif /* KLEE_OPTIONCATEGORIES_H */
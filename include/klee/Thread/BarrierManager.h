@@ -11,22 +11,31 @@
 #define BARRIERMANAGER_H_
 
 #include "klee/Thread/Barrier.h"
-#include <map>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace klee {
 
 class BarrierManager {
 private:
-  std::map<std::string, Barrier *> barrierPool;
+  // barriers[id - 1] is the barrier with that id
+  std::vector<Barrier> barriers;
+  // address -> barrier id, shared by the copies of the manager until one of them adds a barrier
+  std::shared_ptr<std::unordered_map<uint64_t, unsigned>> barrierIds;
 
 public:
   BarrierManager();
   virtual ~BarrierManager();
-  bool init(std::string barrierName, unsigned count, std::string &errorMsg);
-  bool wait(std::string barrierName, unsigned threadId, bool &isReleased, std::vector<unsigned> &blockedList,
+  bool init(uint64_t address, unsigned count, std::string &errorMsg);
+  bool wait(uint64_t address, unsigned threadId, bool &isReleased, std::vector<unsigned> &blockedList,
             std::string &errorMsg);
-  bool addBarrier(std::string barrierName, std::string &errorMsg);
-  Barrier *getBarrier(std::string barrierName);
+  bool addBarrier(uint64_t address, std::string &errorMsg);
+  // NULL if no barrier is at address, the pointer is valid until the next addBarrier
+  Barrier *getBarrier(uint64_t address);
   void clear();
   void print(std::ostream &out);
 };
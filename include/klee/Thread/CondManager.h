@@ -10,9 +10,11 @@
 #ifndef CONDMANAGER_H_
 #define CONDMANAGER_H_
 
+#include <cstdint>
 #include <iostream>
-#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "klee/Thread/Condition.h"
@@ -25,23 +27,31 @@ namespace klee {
 
 class CondManager {
 private:
-  std::map<std::string, Condition *> condPool;
+  // conditions[id - 1] is the condition with that id
+  std::vector<Condition *> conditions;
+  // address -> condition id, shared by the copies of the manager until one of them adds a condition
+  std::shared_ptr<std::unordered_map<uint64_t, unsigned>> conditionIds;
   MutexManager *mutexManager;
-  unsigned nextConditionId;
+
+  void addCondition(Condition *cond, uint64_t address);
 
 public:
   CondManager();
   CondManager(MutexManager *mutexManaget);
+  // the copy still refers to the mutex manager of other, reset it with setMutexManager
+  CondManager(const CondManager &other);
   virtual ~CondManager();
-  bool wait(std::string condName, std::string mutexName, unsigned threadId, std::string &errorMsg);
-  bool signal(std::string condName, unsigned &releasedThreadId, std::string &errorMsg);
-  bool broadcast(std::string condName, std::vector<unsigned> &threads, std::string &errorMsg);
-  bool addCondition(std::string condName, std::string &errorMsg);
-  bool addCondition(std::string condName, std::string &errorMsg, Prefix *prefix);
-  Condition *getCondition(std::string condName);
+  bool wait(uint64_t condAddress, uint64_t mutexAddress, unsigned threadId, std::string &errorMsg);
+  bool signal(uint64_t condAddress, unsigned &releasedThreadId, std::string &errorMsg);
+  bool broadcast(uint64_t condAddress, std::vector<unsigned> &threads, std::string &errorMsg);
+  bool addCondition(uint64_t address, std::string &errorMsg);
+  bool addCondition(uint64_t address, std::string &errorMsg, Prefix *prefix);
+  Condition *getCondition(uint64_t address);
   void setMutexManager(MutexManager *mutexManager) {
     this->mutexManager = mutexManager;
   }
+  // guide all conditions with the prefix
+  void guide(Prefix *prefix);
   void clear();
   void print(std::ostream &out);
   unsigned getNextConditionId();
@@ -38,6 +38,10 @@ public:
   virtual WaitParam *removeItem(WaitParam *param) = 0;
   virtual WaitParam *removeItem(unsigned threadId) = 0;
   virtual void printAllItem(std::ostream &os) = 0;
+  // deep copy, the waiting items are copied too
+  virtual CondScheduler *clone() = 0;
+  // let the prefix decide which item is released first, the result takes over this scheduler
+  virtual CondScheduler *guide(Prefix *prefix);
 };
 
 class FIFSCondScheduler : public CondScheduler {
@@ -49,6 +53,7 @@ public:
     os << "FIFS Condition Scheduler\n";
   }
   FIFSCondScheduler();
+  FIFSCondScheduler(const FIFSCondScheduler &other);
   virtual ~FIFSCondScheduler();
   WaitParam *selectNextItem();
   void popAllItem(std::vector<WaitParam *> &allItem);
@@ -58,6 +63,7 @@ public:
   WaitParam *removeItem(WaitParam *param);
   WaitParam *removeItem(unsigned threadId);
   void printAllItem(std::ostream &os);
+  CondScheduler *clone();
 };
 
 class PreemptiveCondScheduler : public CondScheduler {
@@ -69,6 +75,7 @@ public:
     os << "Preemptive Condition Scheduler\n";
   }
   PreemptiveCondScheduler();
+  PreemptiveCondScheduler(const PreemptiveCondScheduler &other);
   virtual ~PreemptiveCondScheduler();
   WaitParam *selectNextItem();
   void popAllItem(std::vector<WaitParam *> &allItem);
@@ -78,6 +85,7 @@ public:
   WaitParam *removeItem(WaitParam *param);
   WaitParam *removeItem(unsigned threadId);
   void printAllItem(std::ostream &os);
+  CondScheduler *clone();
 };
 
 class GuidedCondScheduler : public CondScheduler {
@@ -90,6 +98,7 @@ public:
     os << "Guided Condition Scheduler\n";
   }
   GuidedCondScheduler(CondSchedulerType secondarySchedulerType, Prefix *prefix);
+  GuidedCondScheduler(CondScheduler *baseScheduler, Prefix *prefix);
   virtual ~GuidedCondScheduler();
   WaitParam *selectNextItem();
   void popAllItem(std::vector<WaitParam *> &allItem);
@@ -99,6 +108,8 @@ public:
   WaitParam *removeItem(WaitParam *param);
   WaitParam *removeItem(unsigned threadId);
   void printAllItem(std::ostream &os);
+  CondScheduler *clone();
+  CondScheduler *guide(Prefix *prefix);
 };
 
 CondScheduler *getCondSchedulerByType(CondScheduler::CondSchedulerType type);
@@ -34,12 +34,16 @@ public:
 
   Condition(unsigned id, std::string name, CondScheduler::CondSchedulerType schedulerType, Prefix *prefix);
 
+  Condition(const Condition &other);
+
   void wait(WaitParam *waitParam);
 
   WaitParam *signal();
 
   void broadcast(std::vector<WaitParam *> &allWait);
 
+  void guide(Prefix *prefix);
+
   virtual ~Condition();
 };
 
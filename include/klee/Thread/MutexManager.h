@@ -10,9 +10,13 @@
 #ifndef MUTEXMANAGER_H_
 #define MUTEXMANAGER_H_
 
+#include <cstdint>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "klee/Thread/Mutex.h"
 
@@ -20,23 +24,27 @@ namespace klee {
 
 class MutexManager {
 private:
-  std::map<std::string, Mutex *> mutexPool;
-  std::map<unsigned, Mutex *> blockedThreadPool;
-  unsigned nextMutexId;
+  // mutexes[id - 1] is the mutex with that id
+  std::vector<Mutex> mutexes;
+  // address -> mutex id, shared by the copies of the manager until one of them adds a mutex
+  std::shared_ptr<std::unordered_map<uint64_t, unsigned>> mutexIds;
+  // thread id -> id of the mutex the thread is blocked on
+  std::map<unsigned, unsigned> blockedThreadPool;
 
 public:
   MutexManager();
   virtual ~MutexManager();
-  bool lock(std::string mutexName, unsigned threadId, bool &isBlocked, std::string &errorMsg);
+  bool lock(uint64_t address, unsigned threadId, bool &isBlocked, std::string &errorMsg);
   bool lock(Mutex *mutex, unsigned threadId, bool &isBlocked, std::string &errorMsg);
-  bool unlock(std::string mutexName, std::string &errorMsg);
+  bool unlock(uint64_t address, std::string &errorMsg);
   bool unlock(Mutex *mutex, std::string &errorMsg);
-  bool addMutex(std::string mutexName, std::string &errorMsg);
-  Mutex *getMutex(std::string mutexName);
+  bool addMutex(uint64_t address, std::string &errorMsg);
+  // NULL if no mutex is at address, the pointer is valid until the next addMutex
+  Mutex *getMutex(uint64_t address);
   void clear();
   void print(std::ostream &out);
   unsigned getNextMutexId();
-  void addBlockedThread(unsigned threadId, std::string mutexName);
+  void addBlockedThread(unsigned threadId, uint64_t address);
   bool tryToLockForBlockedThread(unsigned threadId, bool &isBlocked, std::string &errorMsg);
 };
 
@@ -0,0 +1,81 @@
+//===-- ReadyQueue.h --------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_CORE_READYQUEUE_H_
+#define LIB_CORE_READYQUEUE_H_
+
+#include <vector>
+
+#include "klee/Thread/Thread.h"
+
+namespace klee {
+class ThreadList;
+
+/**
+ * The threads a ThreadScheduler can run, as a doubly linked list threaded through arrays indexed by thread id: adding,
+ * removing and moving a thread take constant time. A copy refers to the threads of the original until it is rebound
+ * to the threads of the same ids of another state.
+ */
+class ReadyQueue {
+private:
+  // thread id -> the thread while it is queued, NULL otherwise. The thread ids start at 1, 0 is the head of the list.
+  std::vector<Thread *> threads;
+  std::vector<unsigned> next;
+  std::vector<unsigned> prev;
+  unsigned count;
+
+  void reserve(unsigned threadId);
+  // link the thread before the one of id position, 0 links it at the back
+  void link(unsigned threadId, unsigned position);
+
+public:
+  class iterator {
+  private:
+    const ReadyQueue *queue;
+    unsigned threadId;
+
+  public:
+    iterator(const ReadyQueue *queue, unsigned threadId) : queue(queue), threadId(threadId) {}
+    iterator &operator++() {
+      threadId = queue->next[threadId];
+      return *this;
+    }
+    Thread *operator*() const { return queue->threads[threadId]; }
+    bool operator==(const iterator &another) const { return threadId == another.threadId; }
+    bool operator!=(const iterator &another) const { return threadId != another.threadId; }
+  };
+
+  ReadyQueue();
+
+  iterator begin() const { return iterator(this, next[0]); }
+  iterator end() const { return iterator(this, 0); }
+  bool empty() const { return count == 0; }
+  unsigned size() const { return count; }
+  bool contains(Thread *thread) const {
+    return thread->threadId < threads.size() && threads[thread->threadId] == thread;
+  }
+  // the queued thread of the id, NULL if there is none
+  Thread *find(unsigned threadId) const { return threadId < threads.size() ? threads[threadId] : nullptr; }
+  Thread *front() const { return threads[next[0]]; }
+  Thread *back() const { return threads[prev[0]]; }
+
+  void pushBack(Thread *thread);
+  void pushFront(Thread *thread);
+  // position has to be queued, NULL inserts at the back
+  void insertBefore(Thread *position, Thread *thread);
+  // does nothing if the thread is not queued
+  void remove(Thread *thread);
+  void clear();
+  // refer to the threads of threadList with the ids of the queued threads
+  void rebind(ThreadList &threadList);
+};
+
+} // namespace klee
+
+#endif /* LIB_CORE_READYQUEUE_H_ */
@@ -14,6 +14,7 @@
 
 #include "klee/Module/KInstIterator.h"
 #include "klee/Thread/StackType.h"
+#include "klee/Thread/VectorClock.h"
 
 namespace klee {
 
@@ -36,7 +37,9 @@ public:
   ThreadState threadState;
   AddressSpace *addressSpace;
   StackType *stack;
-  std::vector<unsigned> vectorClock;
+  VectorClock vectorClock;
+  // the states sharing the thread, the copy of a state shares its terminated threads instead of copying them
+  unsigned refCount;
 
 public:
   Thread(unsigned threadId, Thread *parentThread, KFunction *kf, AddressSpace *addressSpace);
@@ -19,8 +19,8 @@ namespace klee {
 class ThreadList {
 
 private:
+    // thread id -> thread, NULL for the ids without a thread
     std::vector<Thread*> allThreads;
-    std::vector<unsigned> index;
     int threadNum;
 
 
@@ -35,6 +35,8 @@ public:
         ThreadList* threadList;
         unsigned currentPos;
 
+        // move on to the next id with a thread
+        void skipEmpty();
 
     public:
         iterator(ThreadList* threadList, unsigned pos = 0);
@@ -59,11 +61,11 @@ public:
     std::map<unsigned, Thread*> getAllUnfinishedThreads();
     Thread* findThreadById(unsigned threadId);
     int getThreadNum();
+    // the thread of the highest id
     Thread* getLastThread();
 
     // Добавляем методы доступа к данным для iterator
     const std::vector<Thread*>& getAllThreads() const { return allThreads; }
-    const std::vector<unsigned>& getIndex() const { return index; }
 };
 
 
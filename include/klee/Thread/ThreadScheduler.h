@@ -9,17 +9,21 @@
 #ifndef LIB_CORE_THREADSCHEDULER_H_
 #define LIB_CORE_THREADSCHEDULER_H_
 
+#include <cstdint>
+#include <functional>
 #include <iostream>
-#include <list>
 #include <map>
 #include <vector>
 #include <memory>
 
+#include "klee/ADT/RNG.h"
+#include "klee/Thread/ReadyQueue.h"
 #include "klee/Thread/Thread.h"
 
 namespace klee {
 class Prefix;
 class ExecutionState;
+class ThreadList;
 
 class ThreadScheduler {
 public:
@@ -27,7 +31,8 @@ public:
   {
     RR,
     FIFS,
-    Preemptive
+    Preemptive,
+    PCT
   };
   ThreadScheduler() = default;
   virtual ~ThreadScheduler() = default;
@@ -42,9 +47,14 @@ public:
   virtual void printAllItem(std::ostream &os) = 0;
   virtual void reSchedule() = 0;
   virtual ThreadScheduler::ThreadSchedulerType getType() const = 0;        // Виртуальный getType()
-  virtual const std::list<Thread*>& getQueue() const = 0; // Виртуальный getQueue()
+  virtual const ReadyQueue &getQueue() const = 0;
+  // the copy refers to the threads of the original until it is rebound to the copied threads
   virtual ThreadScheduler* clone() const = 0;           // Виртуальный clone() 
-  virtual void setQueue(std::list<Thread*> queue) = 0;
+  virtual void rebind(ThreadList &threadList) = 0;
+  // the queued thread runs next unless the scheduler decides by something else than the order of the queue
+  virtual void promote(Thread *item) = 0;
+  // let the prefix of state decide the schedule, the result takes over this scheduler
+  virtual ThreadScheduler *guide(ExecutionState *state, Prefix *prefix);
 };
 
 /**
@@ -52,13 +62,11 @@ public:
  */
 class RRThreadScheduler : public ThreadScheduler {
 private:
-  std::list<Thread *> queue;
+  ReadyQueue queue;
   unsigned int count;
 
 public:
   RRThreadScheduler();
-  RRThreadScheduler(const RRThreadScheduler& scheduler);
-  RRThreadScheduler(RRThreadScheduler &scheduler, std::map<unsigned, Thread *> &threadMap);
   ~RRThreadScheduler() override = default;  // Деструктор больше не нужен
   void printName(std::ostream &os) {
     os << "RR Thread Scheduler\n";
@@ -75,9 +83,10 @@ public:
   void reSchedule();
   void setCountZero();
   ThreadSchedulerType getType() const override;
-  const std::list<Thread*>& getQueue() const override;
+  const ReadyQueue &getQueue() const override;
   ThreadScheduler* clone() const override; // Объявление clone()
-  void setQueue(std::list<Thread*> queue) override;
+  void rebind(ThreadList &threadList) override;
+  void promote(Thread *item) override;
 };
 
 /**
@@ -85,12 +94,10 @@ public:
  */
 class FIFSThreadScheduler : public ThreadScheduler {
 private:
-  std::list<Thread *> queue;
+  ReadyQueue queue;
 
 public:
   FIFSThreadScheduler();
-  FIFSThreadScheduler(const FIFSThreadScheduler& scheduler);
-  FIFSThreadScheduler(FIFSThreadScheduler &scheduler, std::map<unsigned, Thread *> &threadMap);
   ~FIFSThreadScheduler() override = default;
   void printName(std::ostream &os) {
     os << "FIFS Thread Scheduler\n";
@@ -106,19 +113,18 @@ public:
   void printAllItem(std::ostream &os);
   void reSchedule();
   ThreadSchedulerType getType() const override;
-  const std::list<Thread*>& getQueue() const override;
+  const ReadyQueue &getQueue() const override;
   ThreadScheduler* clone() const override; // Объявление clone()
-  void setQueue(std::list<Thread*> queue) override;
+  void rebind(ThreadList &threadList) override;
+  void promote(Thread *item) override;
 };
 
 class PreemptiveThreadScheduler : public ThreadScheduler {
 private:
-  std::list<Thread *> queue;
+  ReadyQueue queue;
 
 public:
   PreemptiveThreadScheduler();
-  PreemptiveThreadScheduler(const PreemptiveThreadScheduler& scheduler);
-  PreemptiveThreadScheduler(PreemptiveThreadScheduler &scheduler, std::map<unsigned, Thread *> &threadMap);
   ~PreemptiveThreadScheduler() override = default;
   void printName(std::ostream &os) {
     os << "Preemptive Thread Scheduler\n";
@@ -134,9 +140,68 @@ public:
   void printAllItem(std::ostream &os);
   void reSchedule();
   ThreadSchedulerType getType() const override;
-  const std::list<Thread*>& getQueue() const override;
+  const ReadyQueue &getQueue() const override;
   ThreadScheduler* clone() const override; // Объявление clone()
-  void setQueue(std::list<Thread*> queue) override;
+  void rebind(ThreadList &threadList) override;
+  void promote(Thread *item) override;
+};
+
+/**
+ * PCT Scheduler (probabilistic concurrency testing): runs the ready thread of the highest priority. The threads get
+ * random priorities above depth when they are created, and at depth-1 random change points among the expected steps
+ * the running thread drops below all of them. A bug which needs depth ordering constraints is found with a probability
+ * of at least 1/(n*k^(depth-1)) per run for n threads and k steps. The schedule only depends on the seed, the depth
+ * and the steps.
+ */
+class PCTThreadScheduler : public ThreadScheduler {
+private:
+  // ordered by decreasing priority
+  ReadyQueue queue;
+  // thread id -> priority, kept while the thread is swapped out, 0 until the thread is added
+  std::vector<uint64_t> priorities;
+  // the queued thread ids by decreasing priority, finds the position of a thread in the queue in logarithmic time
+  std::multimap<uint64_t, unsigned, std::greater<uint64_t>> byPriority;
+  RNG theRNG;
+  unsigned seed;
+  unsigned depth;
+  // the steps the priority of the running thread changes at, ascending
+  std::vector<uint64_t> changePoints;
+  unsigned nextChangePoint;
+  uint64_t step;
+  // the blocked threads of the highest priorities reSchedule has skipped since the last step
+  unsigned skipped;
+  bool rescheduled;
+  // the thread selected last, 0 before the first step
+  unsigned lastThreadId;
+
+  // behind the threads of the same or a higher priority
+  void insertByPriority(Thread *thread);
+  // does nothing if the thread is not queued
+  void removeByPriority(Thread *thread);
+  Thread *getSelected();
+
+public:
+  PCTThreadScheduler(unsigned seed, unsigned depth, uint64_t steps);
+  ~PCTThreadScheduler() override = default;
+  void printName(std::ostream &os) {
+    os << "PCT Thread Scheduler (seed " << seed << ", depth " << depth << ")\n";
+  }
+
+  Thread *selectCurrentItem();
+  Thread *selectNextItem();
+  void popAllItem(std::vector<Thread *> &allItem);
+  int itemNum();
+  bool isSchedulerEmpty();
+  void addItem(Thread *item);
+  void removeItem(Thread *item);
+  void printAllItem(std::ostream &os);
+  void reSchedule();
+  ThreadSchedulerType getType() const override;
+  const ReadyQueue &getQueue() const override;
+  ThreadScheduler* clone() const override;
+  void rebind(ThreadList &threadList) override;
+  void promote(Thread *item) override;
+  unsigned getSeed() const { return seed; }
 };
 
 class GuidedThreadScheduler : public ThreadScheduler {
@@ -144,9 +209,12 @@ private:
   Prefix *prefix;
   ThreadScheduler *subScheduler;
   ExecutionState *state;
+  // the thread the prefix ends with has been promoted in the sub scheduler
+  bool resumed;
 
 public:
   GuidedThreadScheduler(ExecutionState *state, ThreadSchedulerType schedulerType, Prefix *prefix);
+  GuidedThreadScheduler(ExecutionState *state, ThreadScheduler *subScheduler, Prefix *prefix);
   GuidedThreadScheduler(const GuidedThreadScheduler& other);  
   ~GuidedThreadScheduler() override = default;
   void printName(std::ostream &os) {
@@ -163,9 +231,11 @@ public:
   void printAllItem(std::ostream &os);
   void reSchedule();
   ThreadSchedulerType getType() const override;
-  const std::list<Thread*>& getQueue() const override;
+  const ReadyQueue &getQueue() const override;
   ThreadScheduler* clone() const override;
-  void setQueue(std::list<Thread*> queue) override;
+  void rebind(ThreadList &threadList) override;
+  void promote(Thread *item) override;
+  ThreadScheduler *guide(ExecutionState *state, Prefix *prefix) override;
 };
 
 ThreadScheduler *getThreadSchedulerByType(ThreadScheduler::ThreadSchedulerType type);
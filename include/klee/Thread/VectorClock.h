@@ -0,0 +1,47 @@
+//===-- VectorClock.h -------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LIB_CORE_VECTORCLOCK_H_
+#define LIB_CORE_VECTORCLOCK_H_
+
+#include <memory>
+#include <vector>
+
+namespace klee {
+
+/**
+ * Vector clock indexed by thread id, it grows with the largest thread id it has seen and the missing components are
+ * 0. Copies share the components until one of them is changed, so recording the clock of a thread in an event does
+ * not copy it.
+ */
+class VectorClock {
+private:
+  // NULL while every component is 0
+  std::shared_ptr<std::vector<unsigned>> clock;
+
+  // the components, not shared with any other clock and at least size long
+  std::vector<unsigned> &getWritable(unsigned size);
+
+public:
+  VectorClock() {}
+
+  unsigned size() const { return clock ? clock->size() : 0; }
+  unsigned operator[](unsigned threadId) const {
+    return clock && threadId < clock->size() ? (*clock)[threadId] : 0;
+  }
+  void increment(unsigned threadId);
+  // componentwise maximum, for the clock of a thread released by another one
+  void join(const VectorClock &other);
+  // no component is larger than the one of other and some is smaller
+  bool happensBefore(const VectorClock &other) const;
+};
+
+} /* namespace klee */
+
+#endif /* LIB_CORE_VECTORCLOCK_H_ */
@@ -10,17 +10,17 @@
 #ifndef WAITPARAM_H_
 #define WAITPARAM_H_
 
-#include <string>
+#include <cstdint>
 
 namespace klee {
 
 class WaitParam {
 public:
-  std::string mutexName;
+  uint64_t mutexAddress;
   unsigned threadId;
 
   WaitParam();
-  WaitParam(std::string mutexName, unsigned threadId);
+  WaitParam(uint64_t mutexAddress, unsigned threadId);
   virtual ~WaitParam();
 };
 
@@ -66,6 +66,12 @@ namespace klee {
 
     AddressSpace() : cowKey(1) {}
     AddressSpace(const AddressSpace &b) : cowKey(++b.cowKey), objects(b.objects) { }
+    /// Replace the objects with the ones of b, shared copy-on-write as with
+    /// the copy constructor.
+    void shareObjects(const AddressSpace &b) {
+      cowKey = ++b.cowKey;
+      objects = b.objects;
+    }
     ~AddressSpace() {}
 
     /// Resolve address to an ObjectPair in result.
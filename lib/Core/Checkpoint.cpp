@@ -0,0 +1,106 @@
+//===-- Checkpoint.cpp ------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Checkpoint.h"
+
+#include "ExecutionState.h"
+#include "MemoryManager.h"
+
+#include "klee/Encode/BitcodeListener.h"
+#include "klee/Encode/Prefix.h"
+#include "klee/Encode/Trace.h"
+
+using namespace klee;
+
+CheckpointRun::~CheckpointRun() { delete memory; }
+
+Checkpoint::~Checkpoint() {
+  // the state and the listeners refer to the memory objects of run, release
+  // them before run
+  delete state;
+  for (auto listener : listeners)
+    delete listener;
+  delete trace;
+}
+
+CheckpointManager::CheckpointManager(unsigned interval, unsigned maxCheckpoints)
+    : interval(interval), maxCheckpoints(maxCheckpoints) {}
+
+CheckpointManager::~CheckpointManager() {
+  for (auto checkpoint : checkpoints)
+    delete checkpoint;
+}
+
+Checkpoint *CheckpointManager::findCheckpoint(Prefix *prefix) {
+  if (!prefix)
+    return nullptr;
+  std::vector<Event *> &events = *prefix->getEventList();
+  // length of the common prefix of every run with the prefix
+  std::map<CheckpointRun *, unsigned> matched;
+  Checkpoint *result = nullptr;
+  for (auto checkpoint : checkpoints) {
+    CheckpointRun *run = checkpoint->run.get();
+    auto mi = matched.find(run);
+    if (mi == matched.end()) {
+      unsigned length = 0;
+      while (length < run->history.size() && length < events.size() &&
+             run->history[length].first == events[length]->threadId &&
+             run->history[length].second == events[length]->inst)
+        length++;
+      mi = matched.insert(std::make_pair(run, length)).first;
+    }
+    if (checkpoint->position <= mi->second &&
+        (!result || checkpoint->position > result->position))
+      result = checkpoint;
+  }
+  return result;
+}
+
+void CheckpointManager::startRun(Checkpoint *checkpoint) {
+  currentRun = std::make_shared<CheckpointRun>();
+  if (checkpoint) {
+    currentRun->parent = checkpoint->run;
+    currentRun->history.assign(checkpoint->run->history.begin(),
+                               checkpoint->run->history.begin() +
+                                   checkpoint->position);
+  }
+}
+
+void CheckpointManager::recordInstruction(unsigned threadId,
+                                          KInstruction *ki) {
+  currentRun->history.push_back(std::make_pair(threadId, ki));
+}
+
+bool CheckpointManager::isCheckpointDue() const {
+  unsigned executed = currentRun->history.size();
+  return executed && executed % interval == 0;
+}
+
+void CheckpointManager::addCheckpoint(
+    Checkpoint *checkpoint,
+    const std::map<const llvm::GlobalValue *, MemoryObject *> &globalObjects,
+    const std::map<const llvm::GlobalValue *, ref<ConstantExpr>>
+        &globalAddresses) {
+  if (currentRun->globalObjects.empty()) {
+    currentRun->globalObjects = globalObjects;
+    currentRun->globalAddresses = globalAddresses;
+  }
+  checkpoint->run = currentRun;
+  checkpoint->position = currentRun->history.size();
+  checkpoints.push_back(checkpoint);
+  while (checkpoints.size() > maxCheckpoints) {
+    delete checkpoints.front();
+    checkpoints.pop_front();
+  }
+}
+
+void CheckpointManager::finishRun(MemoryManager *memory) {
+  currentRun->memory = memory;
+  currentRun.reset();
+}
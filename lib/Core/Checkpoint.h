@@ -0,0 +1,100 @@
+//===-- Checkpoint.h --------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_CHECKPOINT_H
+#define KLEE_CHECKPOINT_H
+
+#include "klee/ADT/Ref.h"
+#include "klee/Expr/Expr.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+class GlobalValue;
+}
+
+namespace klee {
+class BitcodeListener;
+class ExecutionState;
+struct KInstruction;
+class MemoryManager;
+class MemoryObject;
+class Prefix;
+class Trace;
+
+/// One execution of the program from main, or from a checkpoint of an
+/// earlier execution. It keeps the memory objects of the execution alive as
+/// long as one of its checkpoints, or of the executions resumed from them,
+/// still refers to them.
+struct CheckpointRun {
+  /// (thread id, instruction) of every instruction executed so far
+  std::vector<std::pair<unsigned, KInstruction *>> history;
+  MemoryManager *memory;
+  std::map<const llvm::GlobalValue *, MemoryObject *> globalObjects;
+  std::map<const llvm::GlobalValue *, ref<ConstantExpr>> globalAddresses;
+  std::shared_ptr<CheckpointRun> parent;
+
+  CheckpointRun() : memory(nullptr) {}
+  ~CheckpointRun();
+};
+
+/// Everything needed to continue an execution after its first
+/// \c position instructions: the execution state with its threads and
+/// synchronization objects, the listeners with their shadow memory and the
+/// trace recorded so far.
+struct Checkpoint {
+  std::shared_ptr<CheckpointRun> run;
+  unsigned position;
+  ExecutionState *state;
+  std::vector<BitcodeListener *> listeners;
+  Trace *trace;
+
+  explicit Checkpoint(ExecutionState *state)
+      : position(0), state(state), trace(nullptr) {}
+  ~Checkpoint();
+};
+
+/// Takes checkpoints every \c interval instructions and finds the deepest
+/// checkpoint a prefix can be resumed from, so prefix-guided executions do
+/// not replay the part they share with an earlier execution.
+class CheckpointManager {
+  unsigned interval;
+  unsigned maxCheckpoints;
+  std::list<Checkpoint *> checkpoints;
+  std::shared_ptr<CheckpointRun> currentRun;
+
+public:
+  CheckpointManager(unsigned interval, unsigned maxCheckpoints);
+  ~CheckpointManager();
+
+  /// The checkpoint with the most instructions in common with the prefix,
+  /// or null if the prefix has to be executed from main.
+  Checkpoint *findCheckpoint(Prefix *prefix);
+
+  /// Start recording an execution, resumed from \c checkpoint if not null.
+  void startRun(Checkpoint *checkpoint);
+  void recordInstruction(unsigned threadId, KInstruction *ki);
+  bool isCheckpointDue() const;
+  void addCheckpoint(
+      Checkpoint *checkpoint,
+      const std::map<const llvm::GlobalValue *, MemoryObject *> &globalObjects,
+      const std::map<const llvm::GlobalValue *, ref<ConstantExpr>>
+          &globalAddresses);
+  /// Take over the memory manager of the finished execution, it is deleted
+  /// once no checkpoint refers to the execution any more.
+  void finishRun(MemoryManager *memory);
+};
+
+} // namespace klee
+
+#endif /* KLEE_CHECKPOINT_H */
@@ -81,13 +81,28 @@ ExecutionState::ExecutionState(KFunction *kf, Prefix *prefix)
   currentThread = thread;
 }
 
+ExecutionState::ExecutionState(KFunction *kf, ThreadScheduler *threadScheduler)
+    : depth(0), ptreeNode(nullptr), steppedInstructions(0), instsSinceCovNew(0),
+      coveredNew(false), forkDisabled(false), nextThreadId(1), mutexManager(),
+      condManager() {
+  condManager.setMutexManager(&mutexManager);
+  this->threadScheduler = threadScheduler;
+  Thread *thread = new Thread(getNextThreadId(), NULL, kf, &addressSpace);
+  currentStack = thread->stack;
+  threadList.addThread(thread);
+  threadScheduler->addItem(thread);
+  currentThread = thread;
+}
+
 ExecutionState::~ExecutionState() {
   for (const auto &cur_mergehandler: openMergeStack){
     cur_mergehandler->removeOpenState(this);
   }
 
   for (Thread* thread : threadList) { 
-    delete thread; //  Удаляем потоки
+    if (--thread->refCount == 0) {
+      delete thread; //  Удаляем потоки
+    }
   }
 
   delete threadScheduler; 
@@ -110,42 +125,51 @@ ExecutionState::ExecutionState(const ExecutionState& state):
                              ? state.unwindingInformation->clone()
                              : nullptr),
     coveredNew(state.coveredNew),
-    forkDisabled(state.forkDisabled) {
+    forkDisabled(state.forkDisabled),
+    nextThreadId(state.nextThreadId),
+    mutexManager(state.mutexManager),
+    condManager(state.condManager),
+    barrierManager(state.barrierManager),
+    joinRecord(state.joinRecord) {
     
   
   for (const auto &cur_mergehandler: openMergeStack)
     cur_mergehandler->addOpenState(this);
 
-  currentStack = new StackType(*state.currentStack);
+  condManager.setMutexManager(&mutexManager);
 
-  std::map<Thread*, Thread*> threadMap;
-  
-  for (Thread* thread : state.threadList) { 
-    Thread* newThread = new Thread(*thread, &addressSpace); //  !!!
-    threadList.addThread(newThread);      
-    threadMap[thread] = newThread;       
+  // the threads keep their ids, which is all the copies of the scheduler and the parents refer to. A terminated thread
+  // does not change any more, only its id, state and vector clock are read, so the copies share it
+  for (Thread *thread : state.threadList) {
+    if (thread->isTerminated()) {
+      thread->refCount++;
+      threadList.addThread(thread);
+    } else {
+      threadList.addThread(new Thread(*thread, &addressSpace));
+    }
   }
-  
-  //  Используем map для получения копии currentThread
-  currentThread = threadMap[state.currentThread];  // <<< ИСПРАВЛЕНО
+  for (Thread *thread : threadList) {
+    if (thread->parentThread && !thread->isTerminated()) {
+      thread->parentThread = threadList.findThreadById(thread->parentThread->threadId);
+    }
+  }
+  currentThread = state.currentThread ? threadList.findThreadById(state.currentThread->threadId) : nullptr;
+  assert(currentThread && "currentThread not found after copy");
+  currentStack = currentThread->stack;
 
   threadScheduler = state.threadScheduler->clone();
-  
-  // Копируем очередь потоков из старого планировщика, заменяя старые потоки на новые
-  std::list<Thread*> newQueue;
-  for (Thread* thread : state.threadScheduler->getQueue()) {
-    newQueue.push_back(threadMap[thread]); // Копируем указатель на новый поток
-  }
-    threadScheduler->setQueue(newQueue);
-  if (currentThread) { // Проверка на всякий случай
-    currentStack = currentThread->stack; // ПРЕДПОЛОЖЕНИЕ: у Thread есть поле 'stack'
-  } else {
-  // Что делать, если currentThread не найден? Возможно, ошибка?
-  // Или скопировать из родителя?
-  // Безопаснее может быть установить в nullptr или вызвать ошибку.
-    currentStack = nullptr; // Или обработать как ошибку
-    assert(0 && "currentThread not found after copy");
-  }
+  threadScheduler->rebind(threadList);
+}
+
+ExecutionState *ExecutionState::snapshot() const {
+  auto *state = new ExecutionState(*this);
+  state->setID();
+  return state;
+}
+
+void ExecutionState::guide(Prefix *prefix) {
+  threadScheduler = threadScheduler->guide(this, prefix);
+  condManager.guide(prefix);
 }
 
 ExecutionState *ExecutionState::branch() {
@@ -430,9 +454,7 @@ bool ExecutionState::examineAllThreadFinalState() {
 }
 
 unsigned ExecutionState::getNextThreadId() {
-	unsigned threadId = nextThreadId++;
-	assert (nextThreadId < 17 && "vector clock 只有16个");
-	return threadId;
+	return nextThreadId++;
 }
 
 Thread* ExecutionState::createThread(KFunction *kf) {
@@ -445,7 +467,6 @@ Thread* ExecutionState::createThread(KFunction *kf) {
 Thread* ExecutionState::createThread(KFunction *kf, unsigned threadId) {
 	if (threadId >= nextThreadId) {
 		nextThreadId = threadId + 1;
-		assert (nextThreadId < 17 && "vector clock 只有16个");
 	}
 	Thread* newThread = new Thread(threadId, currentThread, kf, &addressSpace);
 	threadList.addThread(newThread);
@@ -467,6 +488,8 @@ void ExecutionState::swapOutThread(Thread* thread, bool isCondBlocked, bool isBa
 	}
 	if (isTerminated) {
 		thread->threadState = Thread::TERMINATED;
+		// a shared terminated thread must not refer to the threads of one of the states
+		thread->parentThread = NULL;
 	}
 }
 
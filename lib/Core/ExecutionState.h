@@ -227,6 +227,8 @@ public:
   // only to create the initial state
   explicit ExecutionState(KFunction *kf);
   ExecutionState(KFunction *kf, Prefix *prefix);
+  // the initial state of a run scheduled by threadScheduler, which the state takes over
+  ExecutionState(KFunction *kf, ThreadScheduler *threadScheduler);
   // no copy assignment, use copy constructor
   ExecutionState &operator=(const ExecutionState &) = delete;
   // no move ctor
@@ -237,6 +239,10 @@ public:
   ~ExecutionState();
 
   ExecutionState *branch();
+  // copy of the whole state including threads and synchronization, used as a checkpoint
+  ExecutionState *snapshot() const;
+  // follow the prefix from its current position on
+  void guide(Prefix *prefix);
 
   void addSymbolic(const MemoryObject *mo, const Array *array);
 
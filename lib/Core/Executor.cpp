@@ -9,6 +9,7 @@
 
 #include "Executor.h"
 
+#include "Checkpoint.h"
 #include "Context.h"
 #include "CoreStats.h"
 #include "ExecutionState.h"
@@ -83,7 +84,9 @@ typedef unsigned TypeSize;
 #include "llvm/Support/raw_ostream.h"
 
 #include "klee/Encode/Event.h"
+#include "klee/Encode/ParallelExplorer.h"
 #include "klee/Encode/Prefix.h"
+#include "klee/Encode/PrefixSearcher.h"
 #include "klee/Encode/RuntimeDataManager.h"
 #include "klee/Encode/Trace.h"
 #include "klee/Encode/Transfer.h"
@@ -106,6 +109,7 @@ typedef unsigned TypeSize;
 #include <sstream>
 #include <string>
 #include <sys/mman.h>
+#include <unistd.h>
 #include <vector>
 
 using namespace llvm;
@@ -130,6 +134,9 @@ cl::OptionCategory
 cl::OptionCategory TestGenCat("Test generation options",
                               "These options impact test generation.");
 
+cl::OptionCategory VerificationCat("Verification options",
+                                   "These options control the exploration of thread schedules and branches.");
+
 cl::opt<std::string> MaxTime(
     "max-time",
     cl::desc("Halt execution after the specified duration.  "
@@ -437,6 +444,50 @@ cl::opt<bool> DebugCheckForImpliedValues(
     cl::desc("Debug the implied value optimization"),
     cl::cat(DebugCat));
 
+/*** Verification options ***/
+
+cl::opt<unsigned> VerificationWorkers(
+    "verification-workers", cl::init(0),
+    cl::desc("Number of forked processes exploring prefixes in parallel, "
+             "0 or 1 runs the exploration in this process (default=0)"),
+    cl::cat(VerificationCat));
+
+cl::opt<unsigned> CheckpointInterval(
+    "checkpoint-interval", cl::init(0),
+    cl::desc("Save the execution every N instructions, prefix-guided executions "
+             "are resumed from the deepest matching checkpoint instead of "
+             "replaying from main. Set to 0 to disable (default=0)"),
+    cl::cat(VerificationCat));
+
+cl::opt<unsigned> MaxCheckpoints(
+    "max-checkpoints", cl::init(32),
+    cl::desc("Number of checkpoints kept, the oldest ones are dropped first "
+             "(default=32)"),
+    cl::cat(VerificationCat));
+
+cl::opt<PrefixSearcher::SearchType> PrefixSearch(
+    "prefix-search", cl::desc("Order in which the prefixes are executed (default=fifo)"),
+    cl::values(clEnumValN(PrefixSearcher::FIFO, "fifo", "in the order the prefixes are found"),
+               clEnumValN(PrefixSearcher::Shortest, "shortest", "the prefix with the fewest events first"),
+               clEnumValN(PrefixSearcher::UncoveredBranch, "uncovered-branch",
+                          "prefixes flipping a branch direction that is not covered yet first"),
+               clEnumValN(PrefixSearcher::FewestContextSwitches, "fewest-switches",
+                          "the prefix with the fewest context switches first"),
+               clEnumValN(PrefixSearcher::Random, "random", "a random prefix, see -prefix-search-seed")
+                   KLEE_LLVM_CL_VAL_END),
+    cl::init(PrefixSearcher::FIFO), cl::cat(VerificationCat));
+
+cl::opt<unsigned> PrefixSearchSeed(
+    "prefix-search-seed", cl::init(1),
+    cl::desc("Seed of -prefix-search=random, the same seed executes the prefixes in the same order (default=1)"),
+    cl::cat(VerificationCat));
+
+cl::opt<std::string> ReplayPrefix(
+    "replay-prefix",
+    cl::desc("Run the prefix written to this file once, like the pct-Trace*.prefix files of the failed -pct-runs, "
+             "instead of the verification"),
+    cl::cat(VerificationCat));
+
 } // namespace
 
 // XXX hack
@@ -471,7 +522,8 @@ Executor::Executor(LLVMContext &ctx, const InterpreterOptions &opts,
       replayKTest(0), replayPath(0), usingSeeds(0),
       atMemoryLimit(false), inhibitForking(false), haltExecution(false),
       ivcEnabled(false), debugLogBuffer(debugBufferString), 
-      isFinished(false), prefix(NULL), executionNum(0), execStatus(SUCCESS){
+      isFinished(false), prefix(NULL), runScheduler(NULL), executionNum(0), execStatus(SUCCESS),
+      checkpoints(NULL) {
 
 
   const time::Span maxTime{MaxTime};
@@ -593,6 +645,7 @@ Executor::setModule(std::vector<std::unique_ptr<llvm::Module>> &modules,
 }
 
 Executor::~Executor() {
+  delete checkpoints;
   delete memory;
   delete externalDispatcher;
   delete specialFunctionHandler;
@@ -3789,11 +3842,12 @@ void Executor::run(ExecutionState &initialState) {
   std::vector<ExecutionState *> newStates(states.begin(), states.end());
   searcher->update(0, newStates, std::vector<ExecutionState *>());
 
-  handleInitializers(initialState);
-
   // main interpreter loop
   while (!states.empty() && !haltExecution) {
     ExecutionState &state = searcher->selectState();
+    if (checkpoints && checkpoints->isCheckpointDue()) {
+      takeCheckpoint(state);
+    }
     Thread *thread = state.getNextThread();
     bool isAbleToRun = true;
     switch (thread->threadState) {
@@ -3872,6 +3926,9 @@ void Executor::run(ExecutionState &initialState) {
       updateStates(&state);
       break;
     }
+    if (checkpoints) {
+      checkpoints->recordInstruction(thread->threadId, ki);
+    }
     stepInstruction(state);
     listenerService->beforeExecuteInstruction(this, state, ki);
     executeInstruction(state, ki);
@@ -4691,6 +4748,14 @@ void Executor::runFunctionAsMain(Function *f,
 				 int argc,
 				 char **argv,
 				 char **envp) {
+  if (checkpoints) {
+    if (Checkpoint *checkpoint = checkpoints->findCheckpoint(prefix)) {
+      resumeFromCheckpoint(checkpoint);
+      return;
+    }
+    checkpoints->startRun(NULL);
+  }
+
   std::vector<ref<Expr> > arguments;
 
   // force deterministic initialization of memory objects
@@ -4738,6 +4803,9 @@ void Executor::runFunctionAsMain(Function *f,
   ExecutionState *state;
 	if (prefix) {
 		state = new ExecutionState(kmodule->functionMap[f], prefix);
+	} else if (runScheduler) {
+		state = new ExecutionState(kmodule->functionMap[f], runScheduler);
+		runScheduler = NULL;
 	} else {
 		state = new ExecutionState(kmodule->functionMap[f]);
 	}
@@ -4784,22 +4852,60 @@ void Executor::runFunctionAsMain(Function *f,
   initializeGlobals(*state);
   processTree = std::make_unique<PTree>(state);
   listenerService->beforeRunMethodAsMain(this, *state, f, argvMO, arguments, argc, argv, envp);
+  handleInitializers(*state);
 
   run(*state);
   processTree = nullptr;
 
-  // hack to clear memory objects
-  delete memory;
-  memory = new MemoryManager(NULL);
+  clearRunMemory();
 
-  globalObjects.clear();
-  globalAddresses.clear();
+  if (statsTracker)
+    statsTracker->done();
+  listenerService->afterRunMethodAsMain(*state);
+}
+
+void Executor::resumeFromCheckpoint(Checkpoint *checkpoint) {
+  kleem_note("Resume %s from the checkpoint after %u instructions.", prefix->getName().c_str(),
+             checkpoint->position);
+  checkpoints->startRun(checkpoint);
+  globalObjects = checkpoint->run->globalObjects;
+  globalAddresses = checkpoint->run->globalAddresses;
+
+  prefix->setPosition(checkpoint->position);
+  ExecutionState *state = checkpoint->state->snapshot();
+  state->guide(prefix);
+  processTree = std::make_unique<PTree>(state);
+  listenerService->restore(this, checkpoint->listeners, checkpoint->trace);
+
+  run(*state);
+  processTree = nullptr;
+
+  clearRunMemory();
 
   if (statsTracker)
     statsTracker->done();
   listenerService->afterRunMethodAsMain(*state);
 }
 
+void Executor::takeCheckpoint(ExecutionState &state) {
+  Checkpoint *checkpoint = new Checkpoint(state.snapshot());
+  listenerService->snapshot(checkpoint->listeners, checkpoint->trace);
+  checkpoints->addCheckpoint(checkpoint, globalObjects, globalAddresses);
+}
+
+void Executor::clearRunMemory() {
+  // hack to clear memory objects, the checkpoints of the run keep them alive
+  if (checkpoints) {
+    checkpoints->finishRun(memory);
+  } else {
+    delete memory;
+  }
+  memory = new MemoryManager(NULL);
+
+  globalObjects.clear();
+  globalAddresses.clear();
+}
+
 unsigned Executor::getPathStreamID(const ExecutionState &state) {
   assert(pathWriter);
   return state.pathOS.getID();
@@ -5137,6 +5243,48 @@ bool Executor::isFunctionSpecial(Function *f) {
 
 void Executor::runVerification(llvm::Function *f, int argc, char **argv, char **envp) {
   kleem_note("Start to exhaust thread schedules and branches under current input.");
+  if (CheckpointInterval) {
+    if (memory->isDeterministic()) {
+      klee_warning("Checkpoints are disabled with deterministic allocation.");
+    } else {
+      checkpoints = new CheckpointManager(CheckpointInterval, MaxCheckpoints);
+    }
+  }
+  if (!ReplayPrefix.empty()) {
+    replayPrefix(f, argc, argv, envp);
+    return;
+  }
+  const ExplorationOptions &exploration = listenerService->getExplorationOptions();
+  if (exploration.pctRuns) {
+    runPCT(f, argc, argv, envp);
+    return;
+  }
+  if (exploration.dpor && exploration.scheduleBound >= 0) {
+    klee_warning("-schedule-bound is ignored, -dpor explores the interleavings of every race without a bound");
+  }
+  if (PrefixSearch != PrefixSearcher::FIFO && exploration.scheduleBound >= 0 && !exploration.dpor) {
+    klee_warning("-prefix-search is ignored, the bounded exploration runs the prefixes by increasing bound");
+  } else if (PrefixSearch != PrefixSearcher::FIFO) {
+    PrefixSearcher *prefixSearcher = PrefixSearcher::create(PrefixSearch, PrefixSearchSeed);
+    std::string searcherName;
+    llvm::raw_string_ostream os(searcherName);
+    prefixSearcher->printName(os);
+    kleem_note("Prefixes are selected by %s", StringRef(os.str()).rtrim().str().c_str());
+    listenerService->getRuntimeDataManager()->setPrefixSearcher(prefixSearcher);
+  }
+  if (VerificationWorkers > 1) {
+    ParallelExplorer explorer(listenerService->getRuntimeDataManager(), kmodule.get());
+    WorkerChannel *coordinator = explorer.spawnWorkers(VerificationWorkers);
+    if (coordinator) {
+      runVerificationWorker(f, argc, argv, envp, explorer, coordinator);
+      // the coordinator reports the results, skip the destructors and output of the worker
+      fflush(NULL);
+      _exit(0);
+    }
+    explorer.coordinate();
+    kleem_note("Exhaustive analysis terminated.");
+    return;
+  }
   // while (!isFinished && execStatus != RUNTIMEERROR) {
   while (!isFinished) {
     execStatus = SUCCESS;
@@ -5148,6 +5296,128 @@ void Executor::runVerification(llvm::Function *f, int argc, char **argv, char **
   kleem_note("Exhaustive analysis terminated.");
 }
 
+void Executor::runVerificationWorker(llvm::Function *f, int argc, char **argv, char **envp,
+                                     ParallelExplorer &explorer, WorkerChannel *coordinator) {
+  RuntimeDataManager *rdManager = listenerService->getRuntimeDataManager();
+  rdManager->coordinator = coordinator;
+  std::string line;
+  while (coordinator->readLine(line)) {
+    std::istringstream in(line);
+    std::string kind;
+    in >> kind;
+    if (kind == "RUN") {
+      unsigned traceId;
+      in >> traceId >> std::ws;
+      // startControl numbers the trace with the next executionNum
+      executionNum = traceId - 1;
+      prefix = NULL;
+      if (in.peek() != EOF) {
+        prefix = Prefix::deserialize(in, explorer.getInstructions());
+      }
+      execStatus = SUCCESS;
+      listenerService->startControl(this);
+      runFunctionAsMain(f, argc, argv, envp);
+      listenerService->endControl(this);
+      while (Prefix *newPrefix = rdManager->getNextPrefix()) {
+        std::stringstream ss;
+        ss << "PREFIX ";
+        newPrefix->serialize(ss);
+        coordinator->writeLine(ss.str());
+        rdManager->releasePrefix(newPrefix);
+      }
+      delete prefix;
+      prefix = NULL;
+      coordinator->writeLine("DONE " + Transfer::uint64toString(traceId));
+    } else if (kind == "QUIT") {
+      coordinator->writeLine("STATS " + rdManager->getStatisticsRecord());
+      break;
+    }
+  }
+  rdManager->coordinator = NULL;
+  delete coordinator;
+}
+
+void Executor::runPCT(llvm::Function *f, int argc, char **argv, char **envp) {
+  const ExplorationOptions &options = listenerService->getExplorationOptions();
+  RuntimeDataManager *rdManager = listenerService->getRuntimeDataManager();
+  if (VerificationWorkers > 1) {
+    klee_warning("-verification-workers is ignored by -pct-runs, run several instances with disjoint -pct-seed "
+                 "ranges instead");
+  }
+  if (options.dpor) {
+    klee_warning("-dpor is ignored, -pct-runs runs random schedules instead of exploring them");
+  }
+  if (options.scheduleBound >= 0) {
+    klee_warning("-schedule-bound is ignored, -pct-runs runs random schedules instead of exploring them");
+  }
+  kleem_note("Run the program %u times with the PCT scheduler of depth %u, starting with seed %u.", options.pctRuns,
+             options.pctDepth, options.pctSeed);
+  auto seeds = interpreterHandler->openKleemOutputFile("pct-seeds.txt");
+  assert(seeds && "Can't create file to log the PCT seeds.");
+  // the change points are drawn among the steps of the longest run so far, starting with the initial run
+  uint64_t steps = 0;
+  unsigned failures = 0;
+  for (unsigned run = 0; run <= options.pctRuns && !haltExecution; run++) {
+    // the initial run is not a PCT run, the first PCT run uses -pct-seed itself
+    unsigned seed = options.pctSeed + run - 1;
+    if (run) {
+      runScheduler = new PCTThreadScheduler(seed, options.pctDepth, steps);
+    }
+    execStatus = SUCCESS;
+    listenerService->startControl(this);
+    runFunctionAsMain(f, argc, argv, envp);
+    Trace *trace = rdManager->getCurrentTrace();
+    unsigned traceId = trace->Id;
+    steps = std::max<uint64_t>(steps, trace->path.size());
+    // the schedule of a failed run, or the one the assertion verification found, is kept as a prefix
+    std::stringstream failed;
+    if (execStatus == RUNTIMEERROR) {
+      Prefix replay(trace->path, trace->createThreadPoint, "pct_Trace" + Transfer::uint64toString(traceId));
+      replay.serialize(failed);
+    }
+    listenerService->endControl(this);
+    while (Prefix *assertion = rdManager->getNextPrefix()) {
+      if (failed.str().empty()) {
+        assertion->serialize(failed);
+      }
+      rdManager->releasePrefix(assertion);
+    }
+
+    *seeds << "Trace" << traceId << " " << (run ? "seed=" + Transfer::uint64toString(seed) : "initial");
+    if (failed.str().empty()) {
+      *seeds << " passed\n";
+      continue;
+    }
+    failures++;
+    std::string fileName = "pct-Trace" + Transfer::uint64toString(traceId) + ".prefix";
+    auto os = interpreterHandler->openKleemOutputFile(fileName);
+    assert(os && "Can't create file to log the failed schedule.");
+    *os << failed.str() << "\n";
+    *seeds << " failed " << fileName << "\n";
+    kleem_note("Trace%u failed, replay it with -replay-prefix=%s.", traceId, fileName.c_str());
+  }
+  seeds->flush();
+  kleem_note("PCT testing terminated, %u of %u runs failed.", failures, options.pctRuns + 1);
+}
+
+void Executor::replayPrefix(llvm::Function *f, int argc, char **argv, char **envp) {
+  std::ifstream in(ReplayPrefix.c_str());
+  std::vector<KInstruction *> instructions;
+  Prefix::indexInstructions(kmodule.get(), instructions);
+  prefix = in ? Prefix::deserialize(in, instructions) : NULL;
+  if (!prefix) {
+    klee_error("Cannot read a prefix from %s.", ReplayPrefix.c_str());
+  }
+  kleem_note("Replay %s from %s.", prefix->getName().c_str(), ReplayPrefix.c_str());
+  execStatus = SUCCESS;
+  listenerService->startControl(this);
+  runFunctionAsMain(f, argc, argv, envp);
+  listenerService->endControl(this);
+  kleem_note("Replay terminated%s.", execStatus == RUNTIMEERROR ? " with a runtime error" : "");
+  delete prefix;
+  prefix = NULL;
+}
+
 void Executor::prepareNextExecution() {
   for (std::set<ExecutionState *>::const_iterator it = states.begin(), ie = states.end(); it != ie; ++it) {
     llvm::errs() << "=====================\n";
@@ -5158,7 +5428,9 @@ void Executor::prepareNextExecution() {
 }
 
 void Executor::prepareNewPrefix() {
-  delete this->prefix;
+  if (this->prefix) {
+    listenerService->getRuntimeDataManager()->releasePrefix(this->prefix);
+  }
   Prefix *pref = listenerService->getRuntimeDataManager()->getNextPrefix();
   if (pref) {
     this->prefix = pref;
@@ -5278,10 +5550,8 @@ unsigned Executor::executePThreadCreate(ExecutionState &state, KInstruction *ki,
 
     // vector clock : creat
     Thread *thread = state.getCurrentThread();
-    for (unsigned i = 0; i < thread->vectorClock.size(); i++) {
-      newThread->vectorClock[i] = thread->vectorClock[i];
-    }
-    newThread->vectorClock[newThread->threadId]++;
+    newThread->vectorClock = thread->vectorClock;
+    newThread->vectorClock.increment(newThread->threadId);
 
     state.currentStack = newThread->stack;
     bindArgument(kthreadEntrance, 0, state, arguments[3]);
@@ -5342,10 +5612,9 @@ unsigned Executor::executePThreadCondWait(ExecutionState &state, KInstruction *k
   if (!condAddress) {
     assert(0 && "cond address is not const");
   }
-  std::string condName = Transfer::uint64toString(condAddress->getZExtValue());
-  std::string mutexName = Transfer::uint64toString(mutexAddress->getZExtValue());
   std::string errorMsg;
-  bool isSuccess = state.condManager.wait(condName, mutexName, state.currentThread->threadId, errorMsg);
+  bool isSuccess = state.condManager.wait(condAddress->getZExtValue(), mutexAddress->getZExtValue(),
+                                          state.currentThread->threadId, errorMsg);
   if (isSuccess) {
     state.swapOutThread(state.currentThread, true, false, false, false);
   } else {
@@ -5362,10 +5631,9 @@ unsigned Executor::executePThreadCondSignal(ExecutionState &state, KInstruction
   if (!condAddress) {
     assert(0 && "cond address is not const");
   }
-  std::string condName = Transfer::uint64toString(condAddress->getZExtValue());
   std::string errorMsg;
   unsigned releasedThreadId;
-  bool isSuccess = state.condManager.signal(condName, releasedThreadId, errorMsg);
+  bool isSuccess = state.condManager.signal(condAddress->getZExtValue(), releasedThreadId, errorMsg);
   if (isSuccess) {
     if (releasedThreadId != 0) {
       state.swapInThread(releasedThreadId, false, true);
@@ -5373,12 +5641,8 @@ unsigned Executor::executePThreadCondSignal(ExecutionState &state, KInstruction
       // vector clock : signal
       Thread *thread = state.getCurrentThread();
       Thread *tthread = state.findThreadById(releasedThreadId);
-      for (unsigned i = 0; i < tthread->vectorClock.size(); i++) {
-        if (tthread->vectorClock[i] < thread->vectorClock[i]) {
-          tthread->vectorClock[i] = thread->vectorClock[i];
-        }
-      }
-      thread->vectorClock[thread->threadId]++;
+      tthread->vectorClock.join(thread->vectorClock);
+      thread->vectorClock.increment(thread->threadId);
     }
   } else {
     llvm::errs() << errorMsg << "\n";
@@ -5394,10 +5658,9 @@ unsigned Executor::executePThreadCondBroadcast(ExecutionState &state, KInstructi
   if (!condAddress) {
     assert(0 && "cond address is not const");
   }
-  std::string condName = Transfer::uint64toString(condAddress->getZExtValue());
   std::vector<unsigned> threadList;
   std::string errorMsg;
-  bool isSuccess = state.condManager.broadcast(condName, threadList, errorMsg);
+  bool isSuccess = state.condManager.broadcast(condAddress->getZExtValue(), threadList, errorMsg);
   if (isSuccess) {
     std::vector<unsigned>::iterator ti, te;
     std::vector<bool>::iterator bi;
@@ -5407,12 +5670,8 @@ unsigned Executor::executePThreadCondBroadcast(ExecutionState &state, KInstructi
       // vector clock : signal
       Thread *thread = state.getCurrentThread();
       Thread *tthread = state.findThreadById(*ti);
-      for (unsigned i = 0; i < tthread->vectorClock.size(); i++) {
-        if (tthread->vectorClock[i] < thread->vectorClock[i]) {
-          tthread->vectorClock[i] = thread->vectorClock[i];
-        }
-      }
-      thread->vectorClock[thread->threadId]++;
+      tthread->vectorClock.join(thread->vectorClock);
+      thread->vectorClock.increment(thread->threadId);
     }
   } else {
     llvm::errs() << errorMsg << "\n";
@@ -5427,10 +5686,10 @@ unsigned Executor::executePThreadMutexLock(ExecutionState &state, KInstruction *
   ConstantExpr *mutexAddress = dyn_cast<ConstantExpr>(address);
   // cerr << " lock param : " << mutexAddress->getZExtValue();
   if (mutexAddress) {
-    std::string key = Transfer::uint64toString(mutexAddress->getZExtValue());
     std::string errorMsg;
     bool isBlocked;
-    bool isSuccess = state.mutexManager.lock(key, state.currentThread->threadId, isBlocked, errorMsg);
+    bool isSuccess =
+        state.mutexManager.lock(mutexAddress->getZExtValue(), state.currentThread->threadId, isBlocked, errorMsg);
     if (isSuccess) {
       if (isBlocked) {
         state.switchThreadToMutexBlocked(state.currentThread);
@@ -5451,9 +5710,8 @@ unsigned Executor::executePThreadMutexUnlock(ExecutionState &state, KInstruction
   ref<Expr> address = arguments[0];
   ConstantExpr *mutexAddress = dyn_cast<ConstantExpr>(address);
   if (mutexAddress) {
-    std::string key = Transfer::uint64toString(mutexAddress->getZExtValue());
     std::string errorMsg;
-    bool isSuccess = state.mutexManager.unlock(key, errorMsg);
+    bool isSuccess = state.mutexManager.unlock(mutexAddress->getZExtValue(), errorMsg);
     if (!isSuccess) {
       llvm::errs() << errorMsg << "\n";
       assert(0 && "unlock error");
@@ -5475,9 +5733,8 @@ unsigned Executor::executePThreadBarrierInit(ExecutionState &state, KInstruction
   if (!count) {
     assert(0 && "count is not const");
   }
-  std::string barrierName = Transfer::uint64toString(barrierAddress->getZExtValue());
   std::string errorMsg;
-  bool isSuccess = state.barrierManager.init(barrierName, count->getZExtValue(), errorMsg);
+  bool isSuccess = state.barrierManager.init(barrierAddress->getZExtValue(), count->getZExtValue(), errorMsg);
   if (!isSuccess) {
     llvm::errs() << errorMsg << "\n";
     assert(0 && "barrier init error");
@@ -5492,12 +5749,12 @@ unsigned Executor::executePThreadBarrierWait(ExecutionState &state, KInstruction
   if (!barrierAddress) {
     assert(0 && "barrier address is not const");
   }
-  std::string barrierName = Transfer::uint64toString(barrierAddress->getZExtValue());
   std::vector<unsigned> blockedList;
   bool isReleased = false;
   std::string errorMsg;
   bool isSuccess =
-      state.barrierManager.wait(barrierName, state.currentThread->threadId, isReleased, blockedList, errorMsg);
+      state.barrierManager.wait(barrierAddress->getZExtValue(), state.currentThread->threadId, isReleased, blockedList,
+                                errorMsg);
   if (isSuccess) {
     if (isReleased) {
       // may be a bottleneck as time complexity is O(n*n)
@@ -5594,20 +5851,17 @@ void Executor::createSpecialElement(ExecutionState &state, Type *type, uint64_t
           startAddress = (startAddress / alignment + 1) * alignment;
         }
         if (type->getStructName() == "union.pthread_mutex_t") {
-          std::string mutexName = Transfer::uint64toString(startAddress);
-          state.mutexManager.addMutex(mutexName, errorMsg);
-          // llvm::errs() << "mutexName : " << mutexName << "\n";
+          state.mutexManager.addMutex(startAddress, errorMsg);
           startAddress += kmodule->targetData->getTypeSizeInBits(type) / 8;
         } else if (type->getStructName() == "union.pthread_cond_t") {
-          std::string condName = Transfer::uint64toString(startAddress);
           if (prefix) {
-            state.condManager.addCondition(condName, errorMsg, prefix);
+            state.condManager.addCondition(startAddress, errorMsg, prefix);
           } else {
-            state.condManager.addCondition(condName, errorMsg);
+            state.condManager.addCondition(startAddress, errorMsg);
           }
           startAddress += kmodule->targetData->getTypeSizeInBits(type) / 8;
         } else if (type->getStructName() == "union.pthread_barrier_t") {
-          state.barrierManager.addBarrier(Transfer::uint64toString(startAddress), errorMsg);
+          state.barrierManager.addBarrier(startAddress, errorMsg);
           startAddress += kmodule->targetData->getTypeSizeInBits(type) / 8;
         } else {
           unsigned num = type->getStructNumElements();
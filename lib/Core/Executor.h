@@ -81,6 +81,10 @@ namespace klee {
   class TreeStreamWriter;
   class MergeHandler;
   class MergingSearcher;
+  class ParallelExplorer;
+  class CheckpointManager;
+  struct Checkpoint;
+  class WorkerChannel;
   template<class T> class ref;
 
 
@@ -240,10 +244,14 @@ private:
 
   Prefix *prefix; // prefix used to guide execution
 
+  ThreadScheduler *runScheduler; // scheduler of the next run without prefix, null for the default one
+
   unsigned executionNum; // total number of execution
 
   ExecStatus execStatus;
 
+  CheckpointManager *checkpoints; // null unless -checkpoint-interval is set
+
   static bool hasInitialized;
 
   /// Return the typeid corresponding to a certain `type_info`
@@ -629,7 +637,17 @@ public:
   TimingSolver *getTimeSolver() { return solver; }
   bool isFunctionSpecial(llvm::Function *f);
   void runVerification(llvm::Function *f, int argc, char **argv, char **envp);
+  // serve the prefixes handed out by the coordinator until it sends QUIT
+  void runVerificationWorker(llvm::Function *f, int argc, char **argv, char **envp, ParallelExplorer &explorer,
+                             WorkerChannel *coordinator);
+  // run the initial execution and then -pct-runs executions with the PCT scheduler
+  void runPCT(llvm::Function *f, int argc, char **argv, char **envp);
+  // run the prefix of -replay-prefix once
+  void replayPrefix(llvm::Function *f, int argc, char **argv, char **envp);
   void prepareNextExecution();
+  void resumeFromCheckpoint(Checkpoint *checkpoint);
+  void takeCheckpoint(ExecutionState &state);
+  void clearRunMemory();
   void prepareNewPrefix();
   void printInstrcution(ExecutionState &state, KInstruction *ki);
   void printPrefix();
@@ -47,6 +47,7 @@ public:
   void deallocate(const MemoryObject *mo);
   void markFreed(MemoryObject *mo);
   ArrayCache *getArrayCache() const { return arrayCache; }
+  bool isDeterministic() const { return deterministicSpace != 0; }
 
   /*
    * Returns the size used by deterministic allocation in bytes
@@ -8,8 +8,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "klee/Encode/BitcodeListener.h"
+#include "klee/Module/KInstruction.h"
 #include "klee/Thread/StackType.h"
 
+#include <llvm/IR/Instruction.h>
+
 namespace klee {
 
 BitcodeListener::BitcodeListener(RuntimeDataManager *rdManager) : kind(defaultKind), rdManager(rdManager) {
@@ -17,6 +20,18 @@ BitcodeListener::BitcodeListener(RuntimeDataManager *rdManager) : kind(defaultKi
   stack[1]->realStack.reserve(10);
 }
 
+BitcodeListener::BitcodeListener(const BitcodeListener &other)
+    : kind(other.kind), rdManager(other.rdManager), addressSpace(other.addressSpace), arguments(other.arguments),
+      opcodes(other.opcodes) {
+  for (auto &item : other.stack) {
+    stack[item.first] = new StackType(&addressSpace, item.second);
+  }
+}
+
 BitcodeListener::~BitcodeListener() {}
 
+bool BitcodeListener::handles(KInstruction *ki) const {
+  return opcodes.empty() || opcodes.count(ki->inst->getOpcode());
+}
+
 } // namespace klee
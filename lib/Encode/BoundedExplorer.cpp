@@ -0,0 +1,100 @@
+//===-- BoundedExplorer.cpp -------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Encode/BoundedExplorer.h"
+#include "klee/Support/ErrorHandling.h"
+
+#include <sstream>
+
+using namespace std;
+
+namespace klee {
+
+BoundedExplorer::BoundedExplorer(RuntimeDataManager *data, BoundType type, unsigned maxBound)
+    : InterleavingExplorer(data), type(type), maxBound(maxBound) {}
+
+unsigned BoundedExplorer::getCost(unsigned position, unsigned threadId) {
+  unsigned current = trace->path[position]->threadId;
+  if (type == Preemption) {
+    // switching away from the thread which ran the event before is a preemption if it could go on
+    if (position == 0) {
+      return 0;
+    }
+    unsigned previous = trace->path[position - 1]->threadId;
+    if (previous == threadId) {
+      return 0;
+    }
+    return previous == current || isEnabled(previous, position) ? 1 : 0;
+  }
+  // every enabled thread from the one of the trace up to threadId in the order of the thread ids is delayed
+  unsigned delays = 0;
+  bool counting = false;
+  for (unsigned round = 0; round < 2; round++) {
+    for (auto &thread : threadEvents) {
+      if (thread.first == current) {
+        counting = true;
+      }
+      if (!counting) {
+        continue;
+      }
+      if (thread.first == threadId) {
+        return delays;
+      }
+      if (thread.first == current || isEnabled(thread.first, position)) {
+        delays++;
+      }
+    }
+  }
+  return delays;
+}
+
+void BoundedExplorer::work(Prefix *prefix) {
+  indexTrace();
+  // the guided part of the trace has been explored by the executions before, its bound is spent already
+  unsigned start = prefix ? prefix->getEventList()->size() : 0;
+  unsigned spent = prefix && prefix->getBound() > 0 ? prefix->getBound() : 0;
+
+  for (unsigned i = start; i < trace->path.size(); i++) {
+    unsigned current = trace->path[i]->threadId;
+    // another thread only makes a difference before an access or a join, or where the trace switches anyway
+    if (!stops[i] && i != 0 && trace->path[i - 1]->threadId == current) {
+      continue;
+    }
+    for (auto &thread : threadEvents) {
+      if (thread.first == current || !isEnabled(thread.first, i)) {
+        continue;
+      }
+      unsigned bound = spent + getCost(i, thread.first);
+      if (bound > maxBound) {
+        runtimeData->boundPruned++;
+        continue;
+      }
+      stringstream ss;
+      ss << "Trace" << trace->Id << "-" << getTypeName(type) << bound << "-" << trace->path[i]->eventName << "-T"
+         << thread.first;
+      Prefix *scheduled = createPrefix(i, thread.first, ss.str());
+      scheduled->setBound(bound);
+      kleem_exploration("Schedule thread %u at %s of Trace%d with %s bound %u.", thread.first,
+                        trace->path[i]->eventName.c_str(), trace->Id, getTypeName(type).c_str(), bound);
+      runtimeData->addToScheduleSet(scheduled);
+    }
+  }
+}
+
+string BoundedExplorer::getTypeName(BoundType type) {
+  switch (type) {
+    case Preemption:
+      return "preemption";
+    case Delay:
+      return "delay";
+  }
+  return "";
+}
+
+} // namespace klee
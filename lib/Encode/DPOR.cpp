@@ -0,0 +1,242 @@
+//===-- DPOR.cpp ------------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Encode/DPOR.h"
+#include "klee/Support/ErrorHandling.h"
+
+#include <algorithm>
+#include <climits>
+#include <sstream>
+
+using namespace std;
+
+namespace klee {
+
+DPOR::DPOR(RuntimeDataManager *data) : InterleavingExplorer(data), prefixLength(0) {}
+
+void DPOR::findRaces() {
+  // the clocks count the accesses of every thread, an access happens before another one if the clock of the later
+  // access has reached its local index
+  vector<VectorClock> threadClocks;
+  auto clockOf = [&threadClocks](unsigned threadId) -> VectorClock & {
+    if (threadId >= threadClocks.size()) {
+      threadClocks.resize(threadId + 1);
+    }
+    return threadClocks[threadId];
+  };
+  localIndices.assign(accesses.size(), 0);
+  clocks.assign(accesses.size(), VectorClock());
+  // the last write, the reads after it and the clock of the last unlock of every object
+  vector<int> lastWrite(objects.size(), -1);
+  vector<vector<unsigned>> reads(objects.size());
+  vector<VectorClock> released(objects.size());
+
+  unsigned next = 0;
+  vector<unsigned> dependent;
+  for (unsigned i = 0; i < trace->path.size(); i++) {
+    for (; next < accesses.size() && accesses[next].position == i; next++) {
+      Access &access = accesses[next];
+      VectorClock &clock = clockOf(access.threadId);
+      clock.increment(access.threadId);
+      localIndices[next] = clock[access.threadId];
+
+      dependent.clear();
+      if (lastWrite[access.object] >= 0) {
+        dependent.push_back(lastWrite[access.object]);
+      }
+      if (access.isWrite) {
+        dependent.insert(dependent.end(), reads[access.object].begin(), reads[access.object].end());
+      }
+      for (auto d : dependent) {
+        Access &earlier = accesses[d];
+        if (earlier.threadId != access.threadId && localIndices[d] > clock[earlier.threadId]) {
+          addBacktrack(earlier.position, access.threadId);
+        }
+      }
+      // dependent accesses are ordered from now on
+      for (auto d : dependent) {
+        clock.join(clocks[d]);
+      }
+      if (access.isLock) {
+        clock.join(released[access.object]);
+      }
+      clocks[next] = clock;
+
+      if (access.isWrite) {
+        lastWrite[access.object] = next;
+        reads[access.object].clear();
+      } else {
+        reads[access.object].push_back(next);
+      }
+    }
+
+    // copies share the components, and clockOf may move the clocks
+    VectorClock current = clockOf(trace->path[i]->threadId);
+    for (auto ri = releases.lower_bound(i), re = releases.upper_bound(i); ri != re; ri++) {
+      released[ri->second] = current;
+    }
+    for (auto ci = creates.lower_bound(i), ce = creates.upper_bound(i); ci != ce; ci++) {
+      clockOf(ci->second).join(current);
+    }
+    auto ji = joins.find(i);
+    if (ji != joins.end()) {
+      VectorClock joined = clockOf(ji->second);
+      clockOf(trace->path[i]->threadId).join(joined);
+    }
+  }
+}
+
+void DPOR::addBacktrack(unsigned position, unsigned threadId) {
+  vector<unsigned> &threads = backtrack[position];
+  if (isEnabled(threadId, position)) {
+    if (find(threads.begin(), threads.end(), threadId) == threads.end()) {
+      threads.push_back(threadId);
+    }
+    return;
+  }
+  // the racing thread cannot run there, any thread which can might lead to it
+  for (auto &thread : threadEvents) {
+    if (thread.first != trace->path[position]->threadId && isEnabled(thread.first, position) &&
+        find(threads.begin(), threads.end(), thread.first) == threads.end()) {
+      threads.push_back(thread.first);
+    }
+  }
+}
+
+void DPOR::initSleepSet(Prefix *prefix) {
+  sleeping.clear();
+  prefixLength = prefix ? prefix->getEventList()->size() : 0;
+  if (!prefix) {
+    return;
+  }
+  for (auto &thread : prefix->getSleepSet()) {
+    // a thread wakes up when it runs or when another thread executes an access dependent with its next one
+    unsigned wake = UINT_MAX;
+    auto oi = objectIds.find(thread.object);
+    for (auto &access : accesses) {
+      if (access.position < prefixLength) {
+        continue;
+      }
+      if (access.threadId == thread.threadId ||
+          (oi != objectIds.end() && access.object == oi->second && (access.isWrite || thread.isWrite))) {
+        wake = access.position;
+        break;
+      }
+    }
+    // a joining thread also wakes up when the joined thread runs towards its exit
+    auto ti = thread.joined ? threadEvents.find(thread.joined) : threadEvents.end();
+    if (ti != threadEvents.end()) {
+      auto ei = lower_bound(ti->second.begin(), ti->second.end(), prefixLength);
+      if (ei != ti->second.end() && *ei < wake) {
+        wake = *ei;
+      }
+    }
+    sleeping.push_back(make_pair(thread, wake));
+  }
+}
+
+bool DPOR::isAsleep(unsigned threadId, unsigned position) {
+  if (position < prefixLength) {
+    return false;
+  }
+  for (auto &thread : sleeping) {
+    if (thread.first.threadId == threadId && position < thread.second) {
+      return true;
+    }
+  }
+  return false;
+}
+
+DPOR::Scheduled DPOR::getScheduled(unsigned threadId, unsigned last) {
+  Scheduled scheduled;
+  scheduled.threadId = threadId;
+  scheduled.access = getAccessAt(last);
+  auto ji = joins.find(last);
+  scheduled.joined = ji != joins.end() ? ji->second : 0;
+  return scheduled;
+}
+
+bool DPOR::isIndependent(const SleepingThread &thread, const Scheduled &scheduled) {
+  // a join depends on the exit of the joined thread, and so on everything the joined thread runs before it
+  if ((scheduled.joined && scheduled.joined == thread.threadId) ||
+      (thread.joined && thread.joined == scheduled.threadId)) {
+    return false;
+  }
+  if (scheduled.access == UINT_MAX || thread.object.empty()) {
+    return true;
+  }
+  return thread.object != objects[accesses[scheduled.access].object] ||
+         (!thread.isWrite && !accesses[scheduled.access].isWrite);
+}
+
+SleepingThread DPOR::getSleepingThread(const Scheduled &scheduled) {
+  SleepingThread thread;
+  thread.threadId = scheduled.threadId;
+  thread.object = scheduled.access == UINT_MAX ? "" : objects[accesses[scheduled.access].object];
+  thread.isWrite = scheduled.access != UINT_MAX && accesses[scheduled.access].isWrite;
+  thread.joined = scheduled.joined;
+  return thread;
+}
+
+void DPOR::schedule(unsigned position, unsigned threadId, vector<Scheduled> &done) {
+  if (isAsleep(threadId, position)) {
+    runtimeData->sleepSetPruned++;
+    return;
+  }
+  vector<unsigned> pending;
+  getPendingEvents(threadId, position, pending);
+  Scheduled scheduled = getScheduled(threadId, pending.back());
+
+  stringstream ss;
+  ss << "Trace" << trace->Id << "-dpor-" << trace->path[position]->eventName << "-T" << threadId;
+  Prefix *prefix = createPrefix(position, threadId, ss.str());
+
+  // the threads run at this position before, and the ones still sleeping here, keep sleeping while they are
+  // independent of the scheduled thread
+  vector<SleepingThread> &sleepSet = prefix->getSleepSet();
+  for (auto &other : done) {
+    SleepingThread thread = getSleepingThread(other);
+    if (isIndependent(thread, scheduled)) {
+      sleepSet.push_back(thread);
+    }
+  }
+  if (position >= prefixLength) {
+    for (auto &thread : sleeping) {
+      if (position < thread.second && thread.first.threadId != threadId &&
+          isIndependent(thread.first, scheduled)) {
+        sleepSet.push_back(thread.first);
+      }
+    }
+  }
+  done.push_back(scheduled);
+
+  runtimeData->backtrackPoints++;
+  kleem_exploration("Schedule thread %u at %s of Trace%d.", threadId, trace->path[position]->eventName.c_str(),
+                    trace->Id);
+  runtimeData->addToScheduleSet(prefix);
+}
+
+void DPOR::work(Prefix *prefix) {
+  indexTrace();
+  backtrack.clear();
+  initSleepSet(prefix);
+  findRaces();
+
+  for (auto &point : backtrack) {
+    unsigned position = point.first;
+    // the thread of the trace has run at this position already
+    vector<Scheduled> done;
+    done.push_back(getScheduled(trace->path[position]->threadId, position));
+    for (auto threadId : point.second) {
+      schedule(position, threadId, done);
+    }
+  }
+}
+
+} // namespace klee
@@ -7,11 +7,6 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include <iostream>
-#include <iterator>
-#include <utility>
-#include <vector>
-
 #include "klee/ADT/Ref.h"
 #include "klee/Encode/DTAM.h"
 #include "klee/Encode/Event.h"
@@ -19,145 +14,120 @@
 
 namespace klee {
 
-DTAM::DTAM(RuntimeDataManager *data) : runtimeData(data) {
-  trace = runtimeData->getCurrentTrace();
+DTAM::DTAM(RuntimeDataManager *data) : runtimeData(data), trace(NULL), firstWrite(0) {
   cost = 0;
 }
 
-DTAM::~DTAM() {
-  for (auto &it : allWrite) {
-    delete it.second;
+DTAM::~DTAM() {}
+
+unsigned DTAM::addPoint(Event *event) {
+  auto pi = pointIds.insert(std::make_pair(event->globalName, points.size()));
+  if (pi.second) {
+    points.push_back(DTAMPoint(event->globalName, event->vectorClock));
+  }
+  return pi.first->second;
+}
+
+void DTAM::buildRows(const std::vector<std::pair<unsigned, unsigned>> &edges) {
+  offsets.assign(points.size() + 1, 0);
+  for (auto &edge : edges) {
+    offsets[edge.first + 1]++;
+  }
+  for (unsigned i = 0; i < points.size(); i++) {
+    offsets[i + 1] += offsets[i];
   }
-  for (auto &it : allRead) {
-    delete it.second;
+  targets.resize(edges.size());
+  std::vector<unsigned> next(offsets.begin(), offsets.end() - 1);
+  for (auto &edge : edges) {
+    targets[next[edge.first]++] = edge.second;
   }
 }
 
 void DTAM::prepareDTAMParallel() {
-
-  for (std::map<std::string, std::vector<Event *>>::iterator it = trace->allReadSet.begin(),
-                                                             ie = trace->allReadSet.end();
-       it != ie; it++) {
-    std::vector<Event *> var = (*it).second;
-    for (std::vector<Event *>::iterator itt = var.begin(), iee = var.end(); itt != iee; itt++) {
-      std::string globalVarFullName = (*itt)->globalName;
-      DTAMPoint *point = new DTAMPoint(globalVarFullName, (*itt)->vectorClock);
-      allRead[globalVarFullName] = point;
+  points.clear();
+  pointIds.clear();
+  for (auto &var : trace->allReadSet) {
+    for (auto read : var.second) {
+      addPoint(read);
     }
   }
-
-  for (std::map<std::string, std::vector<Event *>>::iterator it = trace->allWriteSet.begin(),
-                                                             ie = trace->allWriteSet.end();
-       it != ie; it++) {
-    std::vector<Event *> var = (*it).second;
-    for (std::vector<Event *>::iterator itt = var.begin(), iee = var.end(); itt != iee; itt++) {
-      std::string globalVarFullName = (*itt)->globalName;
-      DTAMPoint *point = new DTAMPoint(globalVarFullName, (*itt)->vectorClock);
-      for (std::vector<ref<klee::Expr>>::iterator ittt = (*itt)->relatedSymbolicExpr.begin(),
-                                                  ieee = (*itt)->relatedSymbolicExpr.end();
-           ittt != ieee; ittt++) {
-        std::string value = FilterSymbolicExpr::getGlobalName(*ittt);
-        point->affectedPoint.push_back(allRead[value]);
-        allRead[value]->affectingPoint.push_back(point);
+  firstWrite = points.size();
+
+  std::vector<std::pair<unsigned, unsigned>> edges;
+  for (auto &var : trace->allWriteSet) {
+    for (auto write : var.second) {
+      unsigned writeId = addPoint(write);
+      // the reads the written value is computed from
+      for (auto &expr : write->relatedSymbolicExpr) {
+        auto pi = pointIds.find(FilterSymbolicExpr::getGlobalName(expr));
+        if (pi != pointIds.end()) {
+          edges.push_back(std::make_pair(pi->second, writeId));
+        }
       }
-      std::string varName = (*itt)->name;
-      for (std::vector<Event *>::iterator ittt = trace->allReadSet[varName].begin(),
-                                          ieee = trace->allReadSet[varName].end();
-           ittt != ieee; ittt++) {
-        std::string value = (*ittt)->globalName;
-        point->affectingPoint.push_back(allRead[value]);
-        allRead[value]->affectedPoint.push_back(point);
+      // every read of the variable may read the written value
+      auto ri = trace->allReadSet.find(write->name);
+      if (ri != trace->allReadSet.end()) {
+        for (auto read : ri->second) {
+          edges.push_back(std::make_pair(writeId, pointIds[read->globalName]));
+        }
       }
-      allWrite[globalVarFullName] = point;
     }
   }
+  buildRows(edges);
 }
 
 void DTAM::prepareDTAMhybrid() {
-
-  for (std::map<std::string, DTAMPoint *>::iterator it = allWrite.begin(), ie = allWrite.end(); it != ie; it++) {
-    DTAMPoint *point = (*it).second;
-    std::string name = point->name;
-    for (std::vector<DTAMPoint *>::iterator itt = point->affectingPoint.begin(); itt < point->affectingPoint.end();) {
-      if ((*point) <= (*itt)) {
-        itt++;
-      } else {
-        for (std::vector<DTAMPoint *>::iterator ittt = (*itt)->affectingPoint.begin();
-             ittt < (*itt)->affectingPoint.end(); ittt++) {
-          if (*ittt == point) {
-            (*itt)->affectedPoint.erase(ittt);
-          }
-        }
-        point->affectingPoint.erase(itt);
+  // drop the edges from a write to the reads which happen before it, in place
+  unsigned kept = 0;
+  for (unsigned p = 0; p < points.size(); p++) {
+    unsigned begin = offsets[p], end = offsets[p + 1];
+    offsets[p] = kept;
+    for (unsigned i = begin; i < end; i++) {
+      if (p >= firstWrite && !(points[p] <= &points[targets[i]])) {
+        continue;
       }
+      targets[kept++] = targets[i];
     }
   }
+  offsets[points.size()] = kept;
+  targets.resize(kept);
 }
 
-void DTAM::initTaint(std::vector<DTAMPoint *> &remainPoint) {
-
-  remainPoint.clear();
-
-  for (std::map<std::string, DTAMPoint *>::iterator it = allWrite.begin(), ie = allWrite.end(); it != ie; it++) {
-    DTAMPoint *point = (*it).second;
-    std::string name = point->name;
-    if (trace->DTAMSerial.find(name) != trace->DTAMSerial.end()) {
-      point->isTaint = true;
-      remainPoint.push_back(point);
-    } else {
-      point->isTaint = false;
-    }
-  }
-
-  for (std::map<std::string, DTAMPoint *>::iterator it = allRead.begin(), ie = allRead.end(); it != ie; it++) {
-    DTAMPoint *point = (*it).second;
-    std::string name = point->name;
-    if (trace->DTAMSerial.find(name) != trace->DTAMSerial.end()) {
-      point->isTaint = true;
-      remainPoint.push_back(point);
-    } else {
-      point->isTaint = false;
+void DTAM::initTaint() {
+  tainted.assign(points.size(), false);
+  worklist.clear();
+  for (unsigned p = 0; p < points.size(); p++) {
+    if (trace->DTAMSerial.find(points[p].name) != trace->DTAMSerial.end()) {
+      tainted[p] = true;
+      worklist.push_back(p);
     }
   }
 }
 
-void DTAM::propagateTaint(std::vector<DTAMPoint *> &remainPoint) {
-
-  std::vector<DTAMPoint *>::iterator it;
-  while (!remainPoint.empty()) {
-    it = remainPoint.end();
-    it--;
-    DTAMPoint *point = (*it);
-    remainPoint.pop_back();
-    for (auto point : point->affectingPoint) {
-      if (point->isTaint) {
-        continue;
+void DTAM::propagateTaint() {
+  while (!worklist.empty()) {
+    unsigned p = worklist.back();
+    worklist.pop_back();
+    for (unsigned i = offsets[p]; i < offsets[p + 1]; i++) {
+      unsigned target = targets[i];
+      if (!tainted[target]) {
+        tainted[target] = true;
+        worklist.push_back(target);
       }
-      point->isTaint = true;
-      remainPoint.push_back(point);
     }
   }
 }
 
 void DTAM::logTaint(std::set<std::string> &taint) {
-  for (std::map<std::string, DTAMPoint *>::iterator it = allWrite.begin(), ie = allWrite.end(); it != ie; it++) {
-    DTAMPoint *point = (*it).second;
-    if (point->isTaint == true) {
-      std::string name = point->name;
-      taint.insert(name);
-    }
-  }
-
-  for (std::map<std::string, DTAMPoint *>::iterator it = allRead.begin(), ie = allRead.end(); it != ie; it++) {
-    DTAMPoint *point = (*it).second;
-    if (point->isTaint == true) {
-      std::string name = point->name;
-      taint.insert(name);
+  for (unsigned p = 0; p < points.size(); p++) {
+    if (tainted[p]) {
+      taint.insert(points[p].name);
     }
   }
 }
 
 void DTAM::work() {
+  trace = runtimeData->getCurrentTrace();
   for (auto name : trace->DTAMSerial) {
     runtimeData->allDTAMSerialMap.insert(trace->getAssemblyLine(name));
     trace->DTAMSerialMap.insert(trace->getAssemblyLine(name));
@@ -167,9 +137,8 @@ void DTAM::work() {
 
   gettimeofday(&start, NULL);
   prepareDTAMParallel();
-  std::vector<DTAMPoint *> remainPoint;
-  initTaint(remainPoint);
-  propagateTaint(remainPoint);
+  initTaint();
+  propagateTaint();
   logTaint(trace->DTAMParallel);
   for (auto name : trace->DTAMParallel) {
     runtimeData->allDTAMParallelMap.insert(trace->getAssemblyLine(name));
@@ -185,8 +154,8 @@ void DTAM::work() {
 
   gettimeofday(&start, NULL);
   prepareDTAMhybrid();
-  initTaint(remainPoint);
-  propagateTaint(remainPoint);
+  initTaint();
+  propagateTaint();
   logTaint(trace->DTAMhybrid);
   for (auto name : trace->DTAMhybrid) {
     runtimeData->allDTAMhybridMap.insert(trace->getAssemblyLine(name));
@@ -22,8 +22,10 @@
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/raw_ostream.h>
 
+#include <algorithm>
 #include <assert.h>
 #include <cctype>
+#include <climits>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -31,14 +33,19 @@
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <string>
 #include <sys/time.h>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include "klee/ADT/Ref.h"
 #include "klee/Config/DebugMacro.h"
+#include "klee/Config/Version.h"
 #include "klee/Encode/Encode.h"
 #include "klee/Encode/Prefix.h"
 #include "klee/Expr/Expr.h"
@@ -46,6 +53,9 @@
 #include "klee/Module/KInstruction.h"
 #include "klee/Support/ErrorHandling.h"
 #include "klee/Support/FileHandling.h"
+#include "klee/Support/OptionCategories.h"
+
+#include <llvm/Support/CommandLine.h>
 
 #define BUFFERSIZE 300
 #define BIT_WIDTH 64
@@ -53,6 +63,33 @@
 using namespace llvm;
 using namespace std;
 using namespace z3;
+
+namespace {
+cl::opt<unsigned> FlipThreads("flip-threads", cl::init(1),
+                              cl::desc("Number of threads solving the branch flips of a trace, each with its own copy "
+                                       "of the formula in a separate Z3 context (default=1)"),
+                              cl::cat(klee::VerificationCat));
+
+enum LockEncodingType { PairwiseLockEncoding, LinearLockEncoding };
+
+cl::opt<LockEncodingType> LockEncoding(
+    "lock-encoding",
+    cl::desc("Encoding of the mutual exclusion of the critical sections of a mutex "
+             "(default=pairwise)"),
+    cl::values(clEnumValN(PairwiseLockEncoding, "pairwise",
+                          "one disjunction per pair of critical sections not ordered by thread create/join"),
+               clEnumValN(LinearLockEncoding, "linear",
+                          "rank the critical sections of a mutex, linear in their number")
+                   KLEE_LLVM_CL_VAL_END),
+    cl::init(PairwiseLockEncoding), cl::cat(klee::VerificationCat));
+
+cl::opt<bool> SliceFlips("slice-flips", cl::init(false),
+                         cl::desc("Solve each branch flip on the cone of influence of the branch, the variables "
+                                  "connected to it by branches and stores, instead of on the whole trace "
+                                  "(default=false)"),
+                         cl::cat(klee::VerificationCat));
+} // namespace
+
 namespace klee {
 
 void Encode::encodeTraceToFormulas() {
@@ -62,6 +99,7 @@ void Encode::encodeTraceToFormulas() {
   // Prepare
   // level: 0 bitcode; 1 source code; 2 block
   controlGranularity(1);
+  buildEventTerms();
 
   buildInitValueFormula(z3_solver);
   buildPathCondition(z3_solver);
@@ -85,6 +123,9 @@ void Encode::encodeTraceToFormulas() {
 }
 
 void Encode::buildPTSFormula() {
+  if (orderExprs.empty()) {
+    buildEventTerms();
+  }
   buildInitValueFormula(z3_taint_solver);
   buildPathCondition(z3_taint_solver);
   buildReadWriteFormula(z3_taint_solver);
@@ -100,14 +141,13 @@ void Encode::buildPTSFormula() {
 
 // true :: assert can't be violated. false :: assert can be violated.
 bool Encode::verifyAssertion() {
-  KQuery2Z3 *kq = new KQuery2Z3(z3_ctx);
   unsigned int totalAssertEvent = trace->assertEvent.size();
   unsigned int totalAssertSymbolic = trace->assertSymbolicExpr.size();
   assert(totalAssertEvent == totalAssertSymbolic && "the number of brEvent is not equal to brSymbolic");
   z3::expr res = z3_ctx.bool_val(true);
   for (unsigned int i = 0; i < totalAssertEvent; i++) {
     Event *event = trace->assertEvent[i];
-    res = kq->getZ3Expr(trace->assertSymbolicExpr[i]);
+    res = kqueryToZ3.getZ3Expr(trace->assertSymbolicExpr[i]);
     unsigned line = event->inst->info->line;
     if (line != 0)
       assertFormula.push_back(make_pair(event, res));
@@ -129,8 +169,8 @@ bool Encode::verifyAssertion() {
         continue;
       }
       Event *temp = assertFormula[j].first;
-      expr currIf = z3_ctx.int_const(currAssert->eventName.c_str());
-      expr tempIf = z3_ctx.int_const(temp->eventName.c_str());
+      expr currIf = getOrderExpr(currAssert);
+      expr tempIf = getOrderExpr(temp);
       expr constraint = z3_ctx.bool_val(1);
       if (currAssert->threadId == temp->threadId) {
         if (currAssert->eventId > temp->eventId)
@@ -143,8 +183,8 @@ bool Encode::verifyAssertion() {
     // 发生在当前assert语句之前的if分支要保证不变
     for (unsigned j = 0; j < ifFormula.size(); j++) {
       Event *temp = ifFormula[j].first;
-      expr currIf = z3_ctx.int_const(currAssert->eventName.c_str());
-      expr tempIf = z3_ctx.int_const(temp->eventName.c_str());
+      expr currIf = getOrderExpr(currAssert);
+      expr tempIf = getOrderExpr(temp);
       expr constraint = z3_ctx.bool_val(1);
       if (currAssert->threadId == temp->threadId) {
         if (currAssert->eventId > temp->eventId)
@@ -159,15 +199,16 @@ bool Encode::verifyAssertion() {
 
     if (result == z3::sat) {
       vector<Event *> vecEvent;
-      computePrefix(vecEvent, assertFormula[i].first);
+      model m = z3_solver.get_model();
+      computePrefix(vecEvent, assertFormula[i].first, m);
       Prefix *prefix = new Prefix(vecEvent, trace->createThreadPoint, "assert_" + assertFormula[i].first->eventName);
-      runtimeData->addToScheduleSet(prefix);
       kleem_verifyassert("Assertion Failure at %s:L%d", assertFormula[i].first->inst->info->file.c_str(),
                          assertFormula[i].first->inst->info->line);
 #if PRINT_SOLVING_RESULT
-      printPrefixInfo(prefix, assertFormula[i].first);
-      printSolvingSolution(prefix, assertFormula[i].second);
+      printPrefixInfo(prefix, assertFormula[i].first, m);
+      printSolvingSolution(prefix, assertFormula[i].second, m);
 #endif
+      runtimeData->addToScheduleSet(prefix);
       // Once a assertion is failed, exit the verification.
       return false;
     }
@@ -196,90 +237,481 @@ std::string Encode::solvingInfo(check_result result) {
   return ret;
 }
 
+expr Encode::isBeforeFlippedBranch(Event *event) {
+  // the same relation as between the branches in verifyAssertion: program order in the thread of the flipped branch,
+  // the order variables in the other threads
+  expr flipThread = z3_ctx.int_const("FLIP_THREAD");
+  expr flipEventId = z3_ctx.int_const("FLIP_EVENT_ID");
+  expr flipOrder = z3_ctx.int_const("FLIP_ORDER");
+  expr threadId = z3_ctx.int_val(event->threadId);
+  expr order = getOrderExpr(event);
+  return (flipThread == threadId && z3_ctx.int_val(event->eventId) < flipEventId) ||
+         (flipThread != threadId && order < flipOrder);
+}
+
+expr Encode::selectFlippedBranch(unsigned index, solver z3_solver_flip) {
+  Event *curr = ifFormula[index].first;
+  stringstream ss;
+  ss << "FLIP_" << index;
+  expr flip = z3_ctx.bool_const(ss.str().c_str());
+  expr target = z3_ctx.int_const("FLIP_THREAD") == z3_ctx.int_val(curr->threadId) &&
+                z3_ctx.int_const("FLIP_EVENT_ID") == z3_ctx.int_val(curr->eventId) &&
+                z3_ctx.int_const("FLIP_ORDER") == getOrderExpr(curr);
+  z3_solver_flip.add(implies(flip, target && !ifFormula[index].second));
+  return flip;
+}
+
 void Encode::flipIfBranches() {
   kleem_exploration("Start to filp the branches on trace, totally %lu branches.", ifFormula.size());
+  vector<unsigned> flips;
   for (unsigned i = 0; i < ifFormula.size(); i++) {
-    stringstream ss;
-    ss << "Trace" << trace->Id << "-L" << ifFormula[i].first->inst->info->line << "-" << ifFormula[i].first->eventName
-       << "-" << ifFormula[i].first->brCondition << "-" << !(ifFormula[i].first->brCondition);
-    std::string prefixName = ss.str();
-    // create a backstracking point
-    z3_solver.push();
-#if O2
-    bool presolve = filter.filterUselessWithSet(trace, trace->brRelatedSymbolicExpr[i]);
-#else
     bool presolve = true;
-#endif
+    if (options.presolveSharedVars) {
+      presolve = filter.filterUselessWithSet(trace, trace->brRelatedSymbolicExpr[i]);
+    }
     if (presolve) {
-      Event *curr = ifFormula[i].first;
-#if O3
-      concretizeReadValue(curr);
-#endif
-      z3_solver.add(!ifFormula[i].second);
-      for (unsigned j = 0; j < ifFormula.size(); j++) {
-        if (j == i) {
-          continue;
-        }
-        Event *temp = ifFormula[j].first;
-        expr currIf = z3_ctx.int_const(curr->eventName.c_str());
-        expr tempIf = z3_ctx.int_const(temp->eventName.c_str());
-        expr constraint = z3_ctx.bool_val(1);
-        if (curr->threadId == temp->threadId) {
-          if (curr->eventId > temp->eventId)
-            constraint = ifFormula[j].second;
-        } else {
-          constraint = implies(tempIf < currIf, ifFormula[j].second);
-        }
-        z3_solver.add(constraint);
-      }
-      // statics
-      formulaNum = formulaNum + ifFormula.size() - 1;
+      flips.push_back(i);
+    } else {
+      runtimeData->unSatBranchByPreSolve++;
+    }
+  }
+  if (SliceFlips) {
+    flipIfBranchesSliced(flips);
+    return;
+  }
+  // Every branch before the flipped one keeps its direction. The constraints are asserted once for all flips,
+  // guarded by the position of the flipped branch, and each flip only assumes the literal selecting its branch, so
+  // the solver keeps what it has learned from one flip to the next.
+  z3_solver.push();
+  for (unsigned j = 0; j < ifFormula.size(); j++) {
+    z3_solver.add(implies(isBeforeFlippedBranch(ifFormula[j].first), ifFormula[j].second));
+  }
+  // statics
+  formulaNum += ifFormula.size();
+  if (options.concretizeReadValues) {
+    concretizeReadValue(z3_solver);
+  }
+  if (FlipThreads > 1 && flips.size() > 1) {
+    flipIfBranchesInParallel(flips);
+  } else {
+    for (auto i : flips) {
+      expr_vector assumptions(z3_ctx);
+      assumptions.push_back(selectFlippedBranch(i, z3_solver));
       struct timeval start, finish;
       gettimeofday(&start, NULL);
       check_result result;
       try {
-        result = z3_solver.check();
+        result = z3_solver.check(assumptions);
       } catch (z3::exception &ex) {
-        kleem_exploration("Flip branch %s, unexpected solving error: %s", prefixName.c_str(), ex.msg());
+        kleem_exploration("Flip branch %s, unexpected solving error: %s", getFlipName(i).c_str(), ex.msg());
         continue;
       }
       gettimeofday(&finish, NULL);
       double cost =
           (double)(finish.tv_sec * 1000000UL + finish.tv_usec - start.tv_sec * 1000000UL - start.tv_usec) / 1000000UL;
-
-      solvingTimes++;
       if (result == z3::sat) {
-        vector<Event *> vecEvent;
-        computePrefix(vecEvent, ifFormula[i].first);
-        Prefix *prefix = new Prefix(vecEvent, trace->createThreadPoint, prefixName);
-        runtimeData->addToScheduleSet(prefix);
-        runtimeData->satBranch++;
-        runtimeData->satCost += cost;
-#if PRINT_SOLVING_RESULT
-        printPrefixInfo(prefix, ifFormula[i].first);
-        printSolvingSolution(prefix, ifFormula[i].second);
-#endif
+        model m = z3_solver.get_model();
+        recordFlip(i, result, cost, &m);
       } else {
-        runtimeData->unSatBranchBySolve++;
-        runtimeData->unSatCost += cost;
+        recordFlip(i, result, cost, NULL);
       }
+    }
+  }
+  // backstracking
+  z3_solver.pop();
+}
 
+void Encode::buildVariableComponents() {
+  // union-find over the variable names: a branch or a store connects all the variables it reads
+  map<string, unsigned> ids;
+  vector<unsigned> parent;
+  auto getId = [&](const string &var) {
+    map<string, unsigned>::iterator it = ids.find(var);
+    if (it != ids.end()) {
+      return it->second;
+    }
+    ids[var] = parent.size();
+    parent.push_back(parent.size());
+    return (unsigned)parent.size() - 1;
+  };
+  auto find = [&](unsigned id) {
+    while (parent[id] != id) {
+      parent[id] = parent[parent[id]];
+      id = parent[id];
+    }
+    return id;
+  };
+  auto connect = [&](const set<string> &vars) {
+    if (vars.empty()) {
+      return;
+    }
+    unsigned root = find(getId(*vars.begin()));
+    for (auto &var : vars) {
+      unsigned other = find(getId(var));
+      if (other != root) {
+        parent[other] = root;
+      }
+    }
+  };
+
+  ifRelatedVars.assign(ifFormula.size(), set<string>());
+  for (unsigned i = 0; i < ifFormula.size(); i++) {
+    FilterSymbolicExpr::resolveSymbolicExpr(ifSymbolicExpr[i], ifRelatedVars[i]);
+    connect(ifRelatedVars[i]);
+  }
+  for (auto &related : trace->allRelatedSymbolicExprs) {
+    set<string> vars(related.second);
+    vars.insert(related.first);
+    connect(vars);
+  }
+  for (auto &store : trace->pathConditionRelatedToBranch) {
+    set<string> vars;
+    FilterSymbolicExpr::resolveSymbolicExpr(store, vars);
+    connect(vars);
+  }
+  for (auto &branch : pathFormula) {
+    set<string> vars;
+    FilterSymbolicExpr::resolveSymbolicExpr(branch.first, vars);
+    connect(vars);
+  }
+
+  variableComponents.clear();
+  for (auto &id : ids) {
+    variableComponents[id.first] = find(id.second);
+  }
+}
+
+void Encode::flipIfBranchesSliced(const vector<unsigned> &flips) {
+  // The branches reading only variables of one component are flipped together on a solver holding the formulas of
+  // that component: its reads, writes, stores and branches, and the order formulas of the events in its slice. The
+  // other components keep their branches through the order of their conflicting accesses in the trace, which is
+  // cheaper than their read-write formulas.
+  buildVariableComponents();
+  map<unsigned, vector<unsigned>> componentFlips;
+  for (auto i : flips) {
+    if (ifRelatedVars[i].empty()) {
+      // the condition does not read the memory, no interleaving changes it
+      runtimeData->constantBranch++;
+      continue;
+    }
+    componentFlips[variableComponents[*ifRelatedVars[i].begin()]].push_back(i);
+  }
+
+  for (auto &component : componentFlips) {
+    set<string> cone;
+    for (auto &var : variableComponents) {
+      if (var.second == component.first) {
+        cone.insert(var.first);
+      }
+    }
+    vector<bool> slice;
+    vector<pair<Event *, Event *>> keptOrders;
+    buildSlice(cone, slice, keptOrders);
+    solver z3_solver_slice(z3_ctx);
+    coneOfInfluence = &cone;
+    sliceEvents = &slice;
+    buildInitValueFormula(z3_solver_slice);
+    buildPathCondition(z3_solver_slice);
+    buildMemoryModelFormula(z3_solver_slice);
+    buildPartialOrderFormula(z3_solver_slice);
+    buildReadWriteFormula(z3_solver_slice);
+    buildSynchronizeFormula(z3_solver_slice);
+    for (auto &order : keptOrders) {
+      z3_solver_slice.add(getOrderExpr(order.first) < getOrderExpr(order.second));
+    }
+    // statics
+    formulaNum += keptOrders.size();
+    for (auto &branch : pathFormula) {
+      set<string> vars;
+      FilterSymbolicExpr::resolveSymbolicExpr(branch.first, vars);
+      if (!vars.empty() && cone.count(*vars.begin())) {
+        z3_solver_slice.add(branch.second);
+      }
+    }
+    for (unsigned j = 0; j < ifFormula.size(); j++) {
+      if (!ifRelatedVars[j].empty() && cone.count(*ifRelatedVars[j].begin())) {
+        z3_solver_slice.add(implies(isBeforeFlippedBranch(ifFormula[j].first), ifFormula[j].second));
+        // statics
+        formulaNum++;
+      }
+    }
+    if (options.concretizeReadValues) {
+      concretizeReadValue(z3_solver_slice);
+    }
+
+    for (auto i : component.second) {
+      expr_vector assumptions(z3_ctx);
+      assumptions.push_back(selectFlippedBranch(i, z3_solver_slice));
+      struct timeval start, finish;
+      gettimeofday(&start, NULL);
+      check_result result;
+      try {
+        result = z3_solver_slice.check(assumptions);
+      } catch (z3::exception &ex) {
+        kleem_exploration("Flip branch %s, unexpected solving error: %s", getFlipName(i).c_str(), ex.msg());
+        continue;
+      }
+      gettimeofday(&finish, NULL);
+      double cost =
+          (double)(finish.tv_sec * 1000000UL + finish.tv_usec - start.tv_sec * 1000000UL - start.tv_usec) / 1000000UL;
       if (result == z3::sat) {
-        kleem_exploration("Flip branch %s, spent %lf(s), Successful.", prefixName.c_str(), cost);
-      } else if (result == z3::unsat) {
-        kleem_exploration("Flip branch %s, spent %lf(s), Failed.", prefixName.c_str(), cost);
+        model m = z3_solver_slice.get_model();
+        recordFlip(i, result, cost, &m);
       } else {
-        kleem_exploration("Flip branch %s, spent %lf(s), Unknown.", prefixName.c_str(), cost);
+        recordFlip(i, result, cost, NULL);
+      }
+    }
+    // computePrefix orders the events outside the slice by the slice, reset after the last flip
+    coneOfInfluence = NULL;
+    sliceEvents = NULL;
+  }
+}
+
+void Encode::buildSlice(const set<string> &cone, vector<bool> &slice, vector<pair<Event *, Event *>> &keptOrders) {
+  slice.assign(trace->nextEventId, false);
+  // per thread, the Event::threadEventId of the accesses to the component
+  map<unsigned, vector<unsigned>> coneAccesses;
+  auto addAccesses = [&](map<string, vector<Event *>> &accesses) {
+    for (auto &var : accesses) {
+      if (!cone.count(var.first)) {
+        continue;
+      }
+      for (auto event : var.second) {
+        slice[event->eventId] = true;
+        coneAccesses[event->threadId].push_back(event->threadEventId);
+      }
+    }
+  };
+  addAccesses(trace->readSetRelatedToBranch);
+  addAccesses(trace->writeSetRelatedToBranch);
+  for (auto &thread : coneAccesses) {
+    std::sort(thread.second.begin(), thread.second.end());
+  }
+  for (unsigned j = 0; j < ifFormula.size(); j++) {
+    if (!ifRelatedVars[j].empty() && cone.count(*ifRelatedVars[j].begin())) {
+      slice[ifFormula[j].first->eventId] = true;
+    }
+  }
+  for (unsigned j = 0; j < rwFormula.size(); j++) {
+    if (cone.count(filter.getName(trace->rwSymbolicExpr[j]->getKid(1)))) {
+      slice[rwFormula[j].first->eventId] = true;
+    }
+  }
+  for (auto &create : trace->createThreadPoint) {
+    slice[create.first->eventId] = true;
+  }
+  for (auto &join : trace->joinThreadPoint) {
+    slice[join.first->eventId] = true;
+  }
+
+  // a mutex matters if one of its critical sections encloses an access to the component
+  for (auto &mutex : trace->all_lock_unlock) {
+    bool related = false;
+    for (auto lockPair : mutex.second) {
+      auto ti = coneAccesses.find(lockPair->threadId);
+      if (ti == coneAccesses.end()) {
+        continue;
+      }
+      auto ai = lower_bound(ti->second.begin(), ti->second.end(), lockPair->lockEvent->threadEventId);
+      if (ai != ti->second.end() && (!lockPair->unlockEvent || *ai < lockPair->unlockEvent->threadEventId)) {
+        related = true;
+        break;
+      }
+    }
+    if (!related) {
+      continue;
+    }
+    for (auto lockPair : mutex.second) {
+      slice[lockPair->lockEvent->eventId] = true;
+      if (lockPair->unlockEvent) {
+        slice[lockPair->unlockEvent->eventId] = true;
       }
+    }
+  }
+  // every wait needs a signal, their formulas are kept whole
+  for (auto &cond : trace->all_wait) {
+    for (auto wait : cond.second) {
+      slice[wait->wait->eventId] = true;
+      slice[wait->lock_by_wait->eventId] = true;
+    }
+  }
+  for (auto &cond : trace->all_signal) {
+    for (auto signal : cond.second) {
+      slice[signal->eventId] = true;
+    }
+  }
+  for (auto &barrier : trace->all_barrier) {
+    for (auto event : barrier.second) {
+      slice[event->eventId] = true;
+    }
+  }
+
+  // A read of another component which reads from the same write as in the trace reads the same value, so the
+  // branches of that component keep their directions. The writes of each variable keep their order, and every read
+  // stays between the write it read from and the next one.
+  unordered_map<Event *, unsigned> positions;
+  positions.reserve(trace->path.size());
+  for (unsigned i = 0; i < trace->path.size(); i++) {
+    positions[trace->path[i]] = i;
+  }
+  for (auto &var : trace->writeSetRelatedToBranch) {
+    if (cone.count(var.first)) {
+      continue;
+    }
+    // (position, is write, event)
+    vector<std::tuple<unsigned, bool, Event *>> accesses;
+    for (auto event : var.second) {
+      auto pi = positions.find(event);
+      if (pi != positions.end()) {
+        accesses.push_back(std::make_tuple(pi->second, true, event));
+      }
+    }
+    auto ri = trace->readSetRelatedToBranch.find(var.first);
+    if (ri != trace->readSetRelatedToBranch.end()) {
+      for (auto event : ri->second) {
+        auto pi = positions.find(event);
+        if (pi != positions.end()) {
+          accesses.push_back(std::make_tuple(pi->second, false, event));
+        }
+      }
+    }
+    std::sort(accesses.begin(), accesses.end());
+    Event *lastWrite = NULL;
+    vector<Event *> reads;
+    for (auto &access : accesses) {
+      Event *event = std::get<2>(access);
+      slice[event->eventId] = true;
+      // program order already orders the accesses of one thread
+      if (lastWrite && lastWrite->threadId != event->threadId) {
+        keptOrders.push_back(make_pair(lastWrite, event));
+      }
+      if (!std::get<1>(access)) {
+        reads.push_back(event);
+        continue;
+      }
+      for (auto read : reads) {
+        if (read->threadId != event->threadId) {
+          keptOrders.push_back(make_pair(read, event));
+        }
+      }
+      reads.clear();
+      lastWrite = event;
+    }
+  }
+}
+
+void Encode::flipIfBranchesInParallel(const vector<unsigned> &flips) {
+  // A z3 context must not be used by two threads at once. Every thread gets its own context with a translated copy of
+  // the solver, the copies are made up front since translating reads the source context.
+  for (auto i : flips) {
+    selectFlippedBranch(i, z3_solver);
+  }
+  formulaNum += flips.size();
+  unsigned threadNum = std::min<size_t>(FlipThreads, flips.size());
+  vector<std::unique_ptr<context>> contexts;
+  vector<std::unique_ptr<solver>> solvers;
+  for (unsigned t = 0; t < threadNum; t++) {
+    contexts.emplace_back(new context());
+    solvers.emplace_back(new solver(*contexts.back(), z3_solver, solver::translate()));
+  }
+
+  struct FlipResult {
+    check_result result;
+    double cost;
+    std::unique_ptr<model> solution;
+    std::string error;
+    FlipResult() : result(z3::unknown), cost(0) {}
+  };
+  vector<FlipResult> results(flips.size());
+  // the flips are dealt out round-robin, so every thread solves the same flips in the same order on every run
+  vector<std::thread> threads;
+  for (unsigned t = 0; t < threadNum; t++) {
+    threads.emplace_back([&, t]() {
+      context &ctx = *contexts[t];
+      solver &s = *solvers[t];
+      for (unsigned k = t; k < flips.size(); k += threadNum) {
+        stringstream ss;
+        ss << "FLIP_" << flips[k];
+        expr_vector assumptions(ctx);
+        assumptions.push_back(ctx.bool_const(ss.str().c_str()));
+        struct timeval start, finish;
+        gettimeofday(&start, NULL);
+        try {
+          results[k].result = s.check(assumptions);
+          if (results[k].result == z3::sat) {
+            results[k].solution.reset(new model(s.get_model()));
+          }
+        } catch (z3::exception &ex) {
+          results[k].error = ex.msg();
+        }
+        gettimeofday(&finish, NULL);
+        results[k].cost =
+            (double)(finish.tv_sec * 1000000UL + finish.tv_usec - start.tv_sec * 1000000UL - start.tv_usec) /
+            1000000UL;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // merge in the order of the branches, as the sequential mode does
+  for (unsigned k = 0; k < flips.size(); k++) {
+    FlipResult &result = results[k];
+    if (!result.error.empty()) {
+      kleem_exploration("Flip branch %s, unexpected solving error: %s", getFlipName(flips[k]).c_str(),
+                        result.error.c_str());
+      continue;
+    }
+    if (result.solution) {
+      model m(*result.solution, z3_ctx, model::translate());
+      recordFlip(flips[k], result.result, result.cost, &m);
     } else {
-      runtimeData->unSatBranchByPreSolve++;
+      recordFlip(flips[k], result.result, result.cost, NULL);
     }
-    // backstracking
-    z3_solver.pop();
   }
+  // the models refer to the contexts, release them first
+  results.clear();
+  solvers.clear();
 }
 
-void Encode::concretizeReadValue(Event *curr) {
+std::string Encode::getFlipName(unsigned index) {
+  stringstream ss;
+  ss << "Trace" << trace->Id << "-L" << ifFormula[index].first->inst->info->line << "-"
+     << ifFormula[index].first->eventName << "-" << ifFormula[index].first->brCondition << "-"
+     << !(ifFormula[index].first->brCondition);
+  return ss.str();
+}
+
+void Encode::recordFlip(unsigned index, check_result result, double cost, model *m) {
+  std::string prefixName = getFlipName(index);
+  solvingTimes++;
+  if (result == z3::sat) {
+    vector<Event *> vecEvent;
+    computePrefix(vecEvent, ifFormula[index].first, *m);
+    Prefix *prefix = new Prefix(vecEvent, trace->createThreadPoint, prefixName);
+    runtimeData->satBranch++;
+    runtimeData->satCost += cost;
+#if PRINT_SOLVING_RESULT
+    printPrefixInfo(prefix, ifFormula[index].first, *m);
+    printSolvingSolution(prefix, ifFormula[index].second, *m);
+#endif
+    runtimeData->addToScheduleSet(prefix);
+  } else {
+    runtimeData->unSatBranchBySolve++;
+    runtimeData->unSatCost += cost;
+  }
+
+  if (result == z3::sat) {
+    kleem_exploration("Flip branch %s, spent %lf(s), Successful.", prefixName.c_str(), cost);
+  } else if (result == z3::unsat) {
+    kleem_exploration("Flip branch %s, spent %lf(s), Failed.", prefixName.c_str(), cost);
+  } else {
+    kleem_exploration("Flip branch %s, spent %lf(s), Unknown.", prefixName.c_str(), cost);
+  }
+}
+
+void Encode::concretizeReadValue(solver z3_solver_cr) {
   //添加读写的解
   std::set<std::string> &RelatedSymbolicExpr = trace->RelatedSymbolicExpr;
   std::vector<ref<klee::Expr>> &rwSymbolicExpr = trace->rwSymbolicExpr;
@@ -287,18 +719,8 @@ void Encode::concretizeReadValue(Event *curr) {
   unsigned int totalRwExpr = rwFormula.size();
   for (unsigned int j = 0; j < totalRwExpr; j++) {
     varName = filter.getName(rwSymbolicExpr[j]->getKid(1));
-    if (RelatedSymbolicExpr.find(varName) == RelatedSymbolicExpr.end()) {
-      Event *temp = rwFormula[j].first;
-      expr currIf = z3_ctx.int_const(curr->eventName.c_str());
-      expr tempIf = z3_ctx.int_const(temp->eventName.c_str());
-      expr constraint = z3_ctx.bool_val(1);
-      if (curr->threadId == temp->threadId) {
-        if (curr->eventId > temp->eventId)
-          constraint = rwFormula[j].second;
-      } else {
-        constraint = implies(tempIf < currIf, rwFormula[j].second);
-      }
-      z3_solver.add(constraint);
+    if (RelatedSymbolicExpr.find(varName) == RelatedSymbolicExpr.end() && isInCone(varName)) {
+      z3_solver_cr.add(implies(isBeforeFlippedBranch(rwFormula[j].first), rwFormula[j].second));
     }
   }
 }
@@ -350,8 +772,8 @@ void Encode::symbolicTaintAnalysis() {
     Event *curr = trace->getEvent((*it));
     for (unsigned j = 0; j < ifFormula.size(); j++) {
       Event *temp = ifFormula[j].first;
-      expr currIf = z3_ctx.int_const(curr->eventName.c_str());
-      expr tempIf = z3_ctx.int_const(temp->eventName.c_str());
+      expr currIf = getOrderExpr(curr);
+      expr tempIf = getOrderExpr(temp);
       expr constraint = z3_ctx.bool_val(1);
       if (curr->threadId == temp->threadId) {
         if (curr->eventId > temp->eventId) {
@@ -419,28 +841,39 @@ void Encode::symbolicTaintAnalysis() {
   runtimeData->TaintAndPTSMap.push_back(trace->taintMap.size());
 }
 
-void Encode::computePrefix(vector<Event *> &vecEvent, Event *ifEvent) {
+void Encode::computePrefix(vector<Event *> &vecEvent, Event *ifEvent, model &m) {
   vector<pair<int, Event *>> eventOrderPair;
-  // get the order of event
-  map<string, expr>::iterator it = eventNameInZ3.find(ifEvent->eventName);
-  assert(it != eventNameInZ3.end());
-  model m = z3_solver.get_model();
-  stringstream ss;
-  ss << m.eval(it->second);
-  long ifEventOrder = atoi(ss.str().c_str());
+  // get the order of event, clustered events share their order
+  vector<long> orders(orderExprs.size(), 0);
+  vector<bool> evaluated(orderExprs.size(), false);
+  auto getOrder = [&](Event *event) {
+    if (!evaluated[event->orderId]) {
+      orders[event->orderId] = m.eval(getOrderExpr(event), true).get_numeral_int64();
+      evaluated[event->orderId] = true;
+    }
+    return orders[event->orderId];
+  };
+  long ifEventOrder = getOrder(ifEvent);
+  vector<long> threadOrders;
   for (unsigned tid = 0; tid < trace->eventList.size(); tid++) {
     std::vector<Event *> &thread = trace->eventList[tid];
     if (thread.empty())
       continue;
+    // an event outside the slice has no order constraint, it runs right before the next event of its thread which
+    // has one, or after all of them
+    threadOrders.assign(thread.size(), LONG_MAX);
+    long next = LONG_MAX;
+    for (unsigned index = thread.size(); index-- > 0;) {
+      if (isInSlice(thread[index])) {
+        next = getOrder(thread[index]);
+      }
+      threadOrders[index] = next;
+    }
     for (unsigned index = 0, size = thread.size(); index < size; index++) {
       if (thread.at(index)->eventType == Event::VIRTUAL)
         continue;
 
-      it = eventNameInZ3.find(thread.at(index)->eventName);
-      assert(it != eventNameInZ3.end());
-      stringstream ss;
-      ss << m.eval(it->second);
-      long order = atoi(ss.str().c_str());
+      long order = threadOrders[index];
       // cut off segment behind the negated branch
       if (order > ifEventOrder)
         continue;
@@ -497,10 +930,9 @@ void Encode::printAssertionInfo() {
   out_file->flush();
 }
 
-void Encode::printPrefixInfo(Prefix *prefix, Event *ifEvent) {
+void Encode::printPrefixInfo(Prefix *prefix, Event *ifEvent, model &m) {
   vector<Event *> *orderedEventList = prefix->getEventList();
   unsigned size = orderedEventList->size();
-  model m = z3_solver.get_model();
   // print counterexample at bitcode level
   auto os = interpreterHandler->openKleemOutputFile(prefix->getName() + ".bitcode");
   assert(os && "Failed to create file.");
@@ -518,11 +950,11 @@ void Encode::printPrefixInfo(Prefix *prefix, Event *ifEvent) {
         continue;
       }
       stringstream ss;
-#if INT_ARITHMETIC
-      ss << m.eval(z3_ctx.int_const(str.c_str()));
-#else
-      ss << m.eval(z3_ctx.bv_const(str.c_str(), BIT_WIDTH)); // just for
-#endif
+      if (options.intArithmetic) {
+        ss << m.eval(z3_ctx.int_const(str.c_str()));
+      } else {
+        ss << m.eval(z3_ctx.bv_const(str.c_str(), BIT_WIDTH)); // just for
+      }
       *os << ss.str();
     }
     *os << "\n";
@@ -530,7 +962,7 @@ void Encode::printPrefixInfo(Prefix *prefix, Event *ifEvent) {
   os->flush();
 }
 
-void Encode::printSolvingSolution(Prefix *prefix, expr ifExpr) {
+void Encode::printSolvingSolution(Prefix *prefix, expr ifExpr, model &m) {
   stringstream fileName;
   fileName << prefix->getName() << ".z3expr";
   auto out_file = interpreterHandler->openKleemOutputFile(fileName.str());
@@ -539,7 +971,6 @@ void Encode::printSolvingSolution(Prefix *prefix, expr ifExpr) {
   ss << !ifExpr;
   *out_file << "!ifFormula[i].second : " << ss.str() << "\n";
   *out_file << "\n" << z3_solver << "\n";
-  model m = z3_solver.get_model();
   *out_file << "\nz3_solver.get_model()\n";
   *out_file << "\n" << m << "\n";
   out_file->flush();
@@ -693,6 +1124,9 @@ void Encode::buildInitValueFormula(solver z3_solver_init) {
   std::map<std::string, llvm::Constant *>::iterator gvi = trace->global_variable_initializer_RelatedToBranch.begin();
 
   for (; gvi != trace->global_variable_initializer_RelatedToBranch.end(); gvi++) {
+    if (!isInCone(gvi->first)) {
+      continue;
+    }
     // bitwidth may introduce bug!!!
     const Type *type = gvi->second->getType();
     const z3::sort varType(llvmTy_to_z3Ty(type));
@@ -741,15 +1175,15 @@ void Encode::buildOutputFormula() {
       vector<expr> allReads;
       for (unsigned i = 0; i < maybeRead.size(); i++) {
         // build the equation
-        expr write = z3_ctx.constant(maybeRead[i]->globalName.c_str(), varType); // used write event
+        expr write = getValueExpr(maybeRead[i], varType); // used write event
         expr eq = (lhs == write);
         // build the constrait of equation
-        expr writeOrder = z3_ctx.int_const(maybeRead[i]->eventName.c_str());
+        expr writeOrder = getOrderExpr(maybeRead[i]);
         vector<expr> beforeRelation;
         for (unsigned j = 0; j < maybeRead.size(); j++) {
           if (j == i)
             continue;
-          expr otherWriteOrder = z3_ctx.int_const(maybeRead[j]->eventName.c_str());
+          expr otherWriteOrder = getOrderExpr(maybeRead[j]);
           expr temp = (otherWriteOrder < writeOrder);
           beforeRelation.push_back(temp);
         }
@@ -803,10 +1237,12 @@ void Encode::buildPathCondition(solver z3_solver_pc) {
   std::cerr << "\nPath Condition:\n";
 #endif
 
-  KQuery2Z3 *kq = new KQuery2Z3(z3_ctx);
   unsigned int totalExpr = trace->pathConditionRelatedToBranch.size();
   for (unsigned int i = 0; i < totalExpr; i++) {
-    z3::expr temp = kq->getZ3Expr(trace->pathConditionRelatedToBranch[i]);
+    if (!isInCone(filter.getName(trace->pathConditionRelatedToBranch[i]->getKid(1)))) {
+      continue;
+    }
+    z3::expr temp = kqueryToZ3.getZ3Expr(trace->pathConditionRelatedToBranch[i]);
     z3_solver_pc.add(temp);
 #if PRINT_FORMULA
     std::cerr << temp << "\n";
@@ -816,9 +1252,9 @@ void Encode::buildPathCondition(solver z3_solver_pc) {
 
 void Encode::constraintEncoding() {
   Trace *trace = runtimeData->getCurrentTrace();
-#if O1
-  filter.filterUnusedExprs(trace);
-#endif
+  if (options.filterUnusedExprs) {
+    filter.filterUnusedExprs(trace);
+  }
 
   unsigned brGlobal = 0;
   for (auto &itr : trace->readSet) {
@@ -832,20 +1268,21 @@ void Encode::constraintEncoding() {
   }
   runtimeData->brGlobal += brGlobal;
 
-  KQuery2Z3 *kq = new KQuery2Z3(z3_ctx);
   for (unsigned int i = 0; i < trace->brEvent.size(); i++) {
     Event *event = trace->brEvent[i];
-    z3::expr res = kq->getZ3Expr(trace->brSymbolicExpr[i]);
+    z3::expr res = kqueryToZ3.getZ3Expr(trace->brSymbolicExpr[i]);
     if (event->isConditionInst == true) {
       ifFormula.push_back(make_pair(event, res));
+      ifSymbolicExpr.push_back(trace->brSymbolicExpr[i]);
     } else if (event->isConditionInst == false) {
       z3_solver.add(res);
+      pathFormula.push_back(make_pair(trace->brSymbolicExpr[i], res));
     }
   }
 
   for (unsigned int i = 0; i < trace->rwSymbolicExpr.size(); i++) {
     Event *event = trace->rwEvent[i];
-    z3::expr res = kq->getZ3Expr(trace->rwSymbolicExpr[i]);
+    z3::expr res = kqueryToZ3.getZ3Expr(trace->rwSymbolicExpr[i]);
     rwFormula.push_back(make_pair(event, res));
   }
   encodeTraceToFormulas();
@@ -862,12 +1299,10 @@ expr Encode::buildExprForConstantValue(Value *V, bool isLeft, string currInstPre
     unsigned num_bit = ((IntegerType *)V->getType())->getBitWidth();
     if (num_bit == 1)
       ret = z3_ctx.bool_val(val);
-    else
-#if INT_ARITHMETIC
+    else if (options.intArithmetic)
       ret = z3_ctx.int_val(val);
-#else
+    else
       ret = z3_ctx.bv_val(val, BIT_WIDTH);
-#endif
   } else if (ConstantFP *cf = dyn_cast<ConstantFP>(V)) {
     double val;
     APFloat apf = cf->getValueAPF();
@@ -885,11 +1320,11 @@ expr Encode::buildExprForConstantValue(Value *V, bool isLeft, string currInstPre
     ret = z3_ctx.real_val(s);
   } else if (dyn_cast<ConstantPointerNull>(V)) {
     //%cmp = icmp eq %struct.bounded_buf_tag* %tmp, null
-#if INT_ARITHMETIC
-    ret = z3_ctx.int_val(0);
-#else
-    ret = z3_ctx.bv_val(0, BIT_WIDTH);
-#endif
+    if (options.intArithmetic) {
+      ret = z3_ctx.int_val(0);
+    } else {
+      ret = z3_ctx.bv_val(0, BIT_WIDTH);
+    }
   } else if (llvm::ConstantExpr *constantExpr = dyn_cast<llvm::ConstantExpr>(V)) {
     Instruction *inst = constantExpr->getAsInstruction();
     if (IntToPtrInst::classof(inst)) {
@@ -898,11 +1333,11 @@ expr Encode::buildExprForConstantValue(Value *V, bool isLeft, string currInstPre
       ConstantInt *ci = dyn_cast<ConstantInt>(ptrtoint->getOperand(0));
       assert(ci && "Impossible!");
       int val = ci->getValue().getLimitedValue();
-#if INT_ARITHMETIC
-      ret = z3_ctx.int_val(val);
-#else
-      ret = z3_ctx.bv_val(val, BIT_WIDTH); // to pointer, the default is 32bit.
-#endif
+      if (options.intArithmetic) {
+        ret = z3_ctx.int_val(val);
+      } else {
+        ret = z3_ctx.bv_val(val, BIT_WIDTH); // to pointer, the default is 32bit.
+      }
     } else {
       assert(0 && "unknown type of Value:1");
     }
@@ -946,11 +1381,7 @@ z3::sort Encode::llvmTy_to_z3Ty(const Type *typ) {
         return z3_ctx.bool_sort();
         ;
       } else {
-#if INT_ARITHMETIC
-        return z3_ctx.int_sort();
-#else
-        return z3_ctx.bv_sort(BIT_WIDTH);
-#endif
+        return options.intArithmetic ? z3_ctx.int_sort() : z3_ctx.bv_sort(BIT_WIDTH);
       }
       break;
     }
@@ -958,21 +1389,13 @@ z3::sort Encode::llvmTy_to_z3Ty(const Type *typ) {
       assert(0 && "couldn't handle Function type!");
       break;
     case Type::StructTyID:
-#if INT_ARITHMETIC
-      return z3_ctx.int_sort();
-#else
-      return z3_ctx.bv_sort(BIT_WIDTH);
-#endif
+      return options.intArithmetic ? z3_ctx.int_sort() : z3_ctx.bv_sort(BIT_WIDTH);
       break;
     case Type::ArrayTyID:
       assert(0 && "couldn't handle Array type!"); // must
       break;
     case Type::PointerTyID:
-#if INT_ARITHMETIC
-      return z3_ctx.int_sort();
-#else
-      return z3_ctx.bv_sort(BIT_WIDTH);
-#endif
+      return options.intArithmetic ? z3_ctx.int_sort() : z3_ctx.bv_sort(BIT_WIDTH);
     case Type::VectorTyID:
       assert(0 && "couldn't handle Vector type!");
       break;
@@ -980,11 +1403,7 @@ z3::sort Encode::llvmTy_to_z3Ty(const Type *typ) {
       assert(0 && "No such type!");
       break;
   }
-#if INT_ARITHMETIC
-  return z3_ctx.int_sort();
-#else
-  return z3_ctx.bv_sort(BIT_WIDTH);
-#endif
+  return options.intArithmetic ? z3_ctx.int_sort() : z3_ctx.bv_sort(BIT_WIDTH);
 } //
 
 void Encode::buildMemoryModelFormula(solver z3_solver_mm) {
@@ -997,12 +1416,12 @@ void Encode::buildMemoryModelFormula(solver z3_solver_mm) {
   // initial and final
   for (unsigned tid = 0; tid < trace->eventList.size(); tid++) {
     std::vector<Event *> &thread = trace->eventList[tid];
-    if (thread.empty())
+    Event *firstEvent = getFirstInSlice(thread);
+    if (!firstEvent)
       continue;
     // initial
-    Event *firstEvent = thread.at(0);
     expr init = z3_ctx.int_const("E_INIT");
-    expr firstEventExpr = z3_ctx.int_const(firstEvent->eventName.c_str());
+    expr firstEventExpr = getOrderExpr(firstEvent);
     expr temp1 = (init < firstEventExpr);
 #if PRINT_FORMULA
     std::cerr << temp1 << "\n";
@@ -1010,9 +1429,9 @@ void Encode::buildMemoryModelFormula(solver z3_solver_mm) {
     z3_solver_mm.add(temp1);
 
     // final
-    Event *finalEvent = thread.back();
+    Event *finalEvent = getLastInSlice(thread);
     expr final = z3_ctx.int_const("E_FINAL");
-    expr finalEventExpr = z3_ctx.int_const(finalEvent->eventName.c_str());
+    expr finalEventExpr = getOrderExpr(finalEvent);
     expr temp2 = (finalEventExpr < final);
 #if PRINT_FORMULA
     std::cerr << temp2 << "\n";
@@ -1022,21 +1441,22 @@ void Encode::buildMemoryModelFormula(solver z3_solver_mm) {
     formulaNum += 2;
   }
 
-  // normal events
+  // normal events, the events outside a slice are skipped and their neighbours ordered directly
   int uniqueEvent = 1;
   for (unsigned tid = 0; tid < trace->eventList.size(); tid++) {
     std::vector<Event *> &thread = trace->eventList[tid];
-    if (thread.empty())
-      continue;
-    for (unsigned index = 0, size = thread.size(); index < size - 1; index++) {
-      Event *pre = thread.at(index);
-      Event *post = thread.at(index + 1);
+    Event *pre = NULL;
+    for (auto post : thread) {
+      if (!isInSlice(post))
+        continue;
       // by clustering
-      if (pre->eventName == post->eventName)
+      if (!pre || pre->orderId == post->orderId) {
+        pre = post;
         continue;
+      }
       uniqueEvent++;
-      expr preExpr = z3_ctx.int_const(pre->eventName.c_str());
-      expr postExpr = z3_ctx.int_const(post->eventName.c_str());
+      expr preExpr = getOrderExpr(pre);
+      expr postExpr = getOrderExpr(post);
       expr temp = (preExpr < postExpr);
 #if PRINT_FORMULA
       std::cerr << temp << "\n";
@@ -1044,10 +1464,7 @@ void Encode::buildMemoryModelFormula(solver z3_solver_mm) {
       z3_solver_mm.add(temp);
       // statics
       formulaNum++;
-
-      // eventNameInZ3 will be used at flipIfBranches
-      eventNameInZ3.insert(map<string, expr>::value_type(pre->eventName, preExpr));
-      eventNameInZ3.insert(map<string, expr>::value_type(post->eventName, postExpr));
+      pre = post;
     }
   }
   z3_solver_mm.add(z3_ctx.int_const("E_FINAL") == z3_ctx.int_val(uniqueEvent) + 100);
@@ -1055,6 +1472,51 @@ void Encode::buildMemoryModelFormula(solver z3_solver_mm) {
   formulaNum++;
 }
 
+Event *Encode::getFirstInSlice(vector<Event *> &thread) {
+  for (auto event : thread) {
+    if (isInSlice(event)) {
+      return event;
+    }
+  }
+  return NULL;
+}
+
+Event *Encode::getLastInSlice(vector<Event *> &thread) {
+  for (auto ei = thread.rbegin(); ei != thread.rend(); ei++) {
+    if (isInSlice(*ei)) {
+      return *ei;
+    }
+  }
+  return NULL;
+}
+
+void Encode::buildEventTerms() {
+  // placeholders, getOrderExpr and getValueExpr only hand out the terms assigned below or on demand
+  orderExprs.assign(trace->nextEventId, z3_ctx.int_val(0));
+  hasOrderExpr.assign(trace->nextEventId, false);
+  valueExprs.assign(trace->nextEventId, z3_ctx.int_val(0));
+  hasValueExpr.assign(trace->nextEventId, false);
+  for (auto &thread : trace->eventList) {
+    for (auto event : thread) {
+      // one order variable per cluster, named after the first event of the cluster
+      if (event->orderId == event->eventId) {
+        orderExprs[event->orderId] = z3_ctx.int_const(event->eventName.c_str());
+        hasOrderExpr[event->orderId] = true;
+      }
+    }
+  }
+}
+
+expr &Encode::getValueExpr(Event *event, const z3::sort &varType) {
+  assert(event->eventId < valueExprs.size() && "the event was created after the terms were built");
+  expr &value = valueExprs[event->eventId];
+  if (!hasValueExpr[event->eventId] || !z3::eq(value.get_sort(), varType)) {
+    value = z3_ctx.constant(event->globalName.c_str(), varType);
+    hasValueExpr[event->eventId] = true;
+  }
+  return value;
+}
+
 // level: 0--bitcode; 1--source code; 2--block
 void Encode::controlGranularity(int level) {
   //	map<string, InstType> record;
@@ -1069,6 +1531,7 @@ void Encode::controlGranularity(int level) {
       int preLineNum = pre->inst->info->line;
       InstType preInstType = getInstOpType(thread.at(0));
       string preEventName = thread.at(0)->eventName;
+      unsigned preOrderId = thread.at(0)->orderId;
 
       for (unsigned index = 1, size = thread.size(); index < size; index++) {
         Event *curr = thread.at(index);
@@ -1090,19 +1553,23 @@ void Encode::controlGranularity(int level) {
         if (currLineNum == preLineNum) {
           if (preInstType == NormalOp) {
             curr->eventName = preEventName;
+            curr->orderId = preOrderId;
             preInstType = currInstType;
           } else {
             if (currInstType == NormalOp) {
               curr->eventName = preEventName;
+              curr->orderId = preOrderId;
             } else {
               preInstType = currInstType;
               preEventName = curr->eventName;
+              preOrderId = curr->orderId;
             }
           }
         } else {
           preLineNum = currLineNum;
           preInstType = currInstType;
           preEventName = curr->eventName;
+          preOrderId = curr->orderId;
         }
       }
     }
@@ -1114,6 +1581,7 @@ void Encode::controlGranularity(int level) {
       Event *pre = thread.at(0);
       InstType preInstType = getInstOpType(pre);
       string preEventName = pre->eventName;
+      unsigned preOrderId = pre->orderId;
 
       for (unsigned index = 1, size = thread.size(); index < size; index++) {
         Event *curr = thread.at(index);
@@ -1130,8 +1598,10 @@ void Encode::controlGranularity(int level) {
 
         if (preInstType == NormalOp) {
           curr->eventName = preEventName;
+          curr->orderId = preOrderId;
         } else {
           preEventName = curr->eventName;
+          preOrderId = curr->orderId;
         }
         preInstType = currInstType;
       }
@@ -1178,12 +1648,11 @@ void Encode::buildPartialOrderFormula(solver z3_solver_po) {
   std::map<Event *, uint64_t>::iterator itc = trace->createThreadPoint.begin();
   for (; itc != trace->createThreadPoint.end(); itc++) {
     // the event is at the point of creating thread
-    string creatPoint = itc->first->eventName;
+    Event *creatPoint = itc->first;
     // the event is the first step of created thread
-    if (trace->eventList[itc->second].size() != 0) {
-      string firstStep = trace->eventList[itc->second].at(0)->eventName;
-      expr prev = z3_ctx.int_const(creatPoint.c_str());
-      expr back = z3_ctx.int_const(firstStep.c_str());
+    if (Event *firstStep = getFirstInSlice(trace->eventList[itc->second])) {
+      expr prev = getOrderExpr(creatPoint);
+      expr back = getOrderExpr(firstStep);
       expr twoEventOrder = (prev < back);
 #if PRINT_FORMULA
       std::cerr << twoEventOrder << "\n";
@@ -1200,15 +1669,17 @@ void Encode::buildPartialOrderFormula(solver z3_solver_po) {
   std::map<Event *, uint64_t>::iterator itj = trace->joinThreadPoint.begin();
   for (; itj != trace->joinThreadPoint.end(); itj++) {
     // the event is at the point of joining thread
-    string joinPoint = itj->first->eventName;
+    Event *joinPoint = itj->first;
     // the event is the last step of joined thread
-    string lastStep = trace->eventList[itj->second].back()->eventName;
-    expr prev = z3_ctx.int_const(lastStep.c_str());
-    expr back = z3_ctx.int_const(joinPoint.c_str());
+    Event *lastStep = getLastInSlice(trace->eventList[itj->second]);
+    if (!lastStep)
+      continue;
+    expr prev = getOrderExpr(lastStep);
+    expr back = getOrderExpr(joinPoint);
     expr twoEventOrder = (prev < back);
 #if PRINT_FORMULA
-    std::cerr << "Jion Point: " << joinPoint << ", ";
-    std::cerr << "Last Step: " << lastStep << " => ";
+    std::cerr << "Jion Point: " << joinPoint->eventName << ", ";
+    std::cerr << "Last Step: " << lastStep->eventName << " => ";
     std::cerr << twoEventOrder << "\n";
 #endif
     z3_solver_po.add(twoEventOrder);
@@ -1217,12 +1688,111 @@ void Encode::buildPartialOrderFormula(solver z3_solver_po) {
   formulaNum += trace->joinThreadPoint.size();
 }
 
+void Encode::buildHappensBefore() {
+  // Only program order and thread create/join are used: they order the events in every interleaving the formula
+  // allows, unlike the lock and wait/signal order of this particular trace.
+  vector<vector<unsigned>> threadClocks(trace->eventList.size(), vector<unsigned>(trace->eventList.size(), 0));
+  eventClocks.assign(trace->nextEventId, vector<unsigned>());
+  // the lock events are compared by buildSynchronizeFormula, some of them are virtual and missing in the path
+  vector<bool> lockEvents(trace->nextEventId, false);
+  for (auto &mutex : trace->all_lock_unlock) {
+    for (auto lockPair : mutex.second) {
+      lockEvents[lockPair->lockEvent->eventId] = true;
+      if (lockPair->unlockEvent) {
+        lockEvents[lockPair->unlockEvent->eventId] = true;
+      }
+    }
+  }
+  // the own component of a clock is the Event::threadEventId, which counts the virtual events as well
+  vector<unsigned> visited(trace->eventList.size(), 0);
+  for (auto event : trace->path) {
+    vector<unsigned> &clock = threadClocks[event->threadId];
+    vector<Event *> &thread = trace->eventList[event->threadId];
+    unsigned &next = visited[event->threadId];
+    for (; next < thread.size() && thread[next] != event; next++) {
+      if (lockEvents[thread[next]->eventId]) {
+        clock[event->threadId] = thread[next]->threadEventId;
+        eventClocks[thread[next]->eventId] = clock;
+      }
+    }
+    next++;
+    map<Event *, uint64_t>::iterator ji = trace->joinThreadPoint.find(event);
+    if (ji != trace->joinThreadPoint.end() && ji->second < threadClocks.size()) {
+      vector<unsigned> &joined = threadClocks[ji->second];
+      for (unsigned i = 0; i < clock.size(); i++) {
+        clock[i] = std::max(clock[i], joined[i]);
+      }
+      // the join follows the last event of the joined thread, virtual or not
+      clock[ji->second] = std::max<unsigned>(clock[ji->second], trace->eventList[ji->second].size());
+    }
+    clock[event->threadId] = event->threadEventId;
+    if (event->isGlobal || lockEvents[event->eventId]) {
+      eventClocks[event->eventId] = clock;
+    }
+    map<Event *, uint64_t>::iterator ci = trace->createThreadPoint.find(event);
+    if (ci != trace->createThreadPoint.end() && ci->second < threadClocks.size()) {
+      threadClocks[ci->second] = clock;
+    }
+  }
+}
+
+bool Encode::happensBefore(Event *first, Event *second) {
+  vector<unsigned> &firstClock = eventClocks[first->eventId];
+  vector<unsigned> &secondClock = eventClocks[second->eventId];
+  if (first == second || firstClock.empty() || secondClock.empty()) {
+    return false;
+  }
+  return firstClock[first->threadId] <= secondClock[first->threadId];
+}
+
+bool Encode::pruneReadFrom(Event *read, vector<Event *> &writes) {
+  // the last write of every thread which happens before the read
+  map<unsigned, Event *> lastWrites;
+  for (auto write : writes) {
+    if (happensBefore(write, read)) {
+      Event *&last = lastWrites[write->threadId];
+      if (!last || happensBefore(last, write)) {
+        last = write;
+      }
+    }
+  }
+  vector<Event *> feasibleWrites;
+  for (auto write : writes) {
+    if (happensBefore(read, write)) {
+      prunedReadFrom++;
+      continue;
+    }
+    if (happensBefore(write, read)) {
+      bool overwritten = false;
+      for (auto &last : lastWrites) {
+        if (happensBefore(write, last.second)) {
+          overwritten = true;
+          break;
+        }
+      }
+      if (overwritten) {
+        prunedReadFrom++;
+        continue;
+      }
+    }
+    feasibleWrites.push_back(write);
+  }
+  writes.swap(feasibleWrites);
+  if (!lastWrites.empty() && !read->latestWriteEventInSameThread) {
+    prunedReadFrom++;
+  }
+  return lastWrites.empty();
+}
+
 void Encode::buildReadWriteFormula(solver z3_solver_rw) {
 #if PRINT_FORMULA
   std::cerr << "\nRead-Write Formula:\n";
 #endif
   // prepare
   markLatestWriteForGlobalVar();
+  if (eventClocks.empty()) {
+    buildHappensBefore();
+  }
   //	std::cerr << "size : " << trace->readSet.size()<<"\n";
   //	std::cerr << "size : " << trace->writeSet.size()<<"\n";
   map<string, vector<Event *>>::iterator read;
@@ -1232,6 +1802,9 @@ void Encode::buildReadWriteFormula(solver z3_solver_rw) {
   Event *currentRead;
   Event *currentWrite;
   for (; ir != trace->readSetRelatedToBranch.end(); ir++) {
+    if (!isInCone(ir->first)) {
+      continue;
+    }
     map<string, vector<Event *>>::iterator iw = trace->writeSetRelatedToBranch.find(ir->first);
     // maybe use the initial value from Initialization.@2014.4.16
     // if(iw == writeSet.end())
@@ -1239,7 +1812,7 @@ void Encode::buildReadWriteFormula(solver z3_solver_rw) {
     for (unsigned k = 0; k < ir->second.size(); k++) {
       vector<expr> oneVarAllRead;
       currentRead = ir->second[k];
-      expr r = z3_ctx.int_const(currentRead->eventName.c_str());
+      expr r = getOrderExpr(currentRead);
 
       // compute the write set that may be used by currentRead;
       vector<Event *> mayBeRead;
@@ -1256,7 +1829,11 @@ void Encode::buildReadWriteFormula(solver z3_solver_rw) {
         //					llvm::errs() << "currentRead->latestWriteEventInSameThread : " <<
         // currentRead->latestWriteEventInSameThread->globalName << "\n";
         mayBeRead.push_back(currentRead->latestWriteEventInSameThread);
-      } else {
+      }
+      // drop the writes which can not be read by happens-before alone, the initial value can only be read if no
+      // write happens before the read, which also covers a write in the same thread
+      bool mayReadInit = pruneReadFrom(currentRead, mayBeRead);
+      if (mayReadInit) {
         // if this read don't have the corresponding write, it may use from Initialization operation.
         // so, build the formula constrainting this read uses from Initialization operation
 
@@ -1269,7 +1846,7 @@ void Encode::buildReadWriteFormula(solver z3_solver_rw) {
           oneVarOneRead.push_back(equal);
           for (unsigned j = 0; j < mayBeRead.size(); j++) {
             currentWrite = mayBeRead[j];
-            expr w = z3_ctx.int_const(currentWrite->eventName.c_str());
+            expr w = getOrderExpr(currentWrite);
             expr order = r < w;
             oneVarOneRead.push_back(order);
           }
@@ -1289,7 +1866,7 @@ void Encode::buildReadWriteFormula(solver z3_solver_rw) {
         expr equal = readFromWriteFormula(currentRead, currentWrite, ir->first);
         oneVarOneRead.push_back(equal);
 
-        expr w = z3_ctx.int_const(currentWrite->eventName.c_str());
+        expr w = getOrderExpr(currentWrite);
         expr rw = (w < r);
         // statics
         formulaNum += 2;
@@ -1297,7 +1874,7 @@ void Encode::buildReadWriteFormula(solver z3_solver_rw) {
         // the next write in the same thread must be behind this read.
         if (i + 1 <= mayBeRead.size() - 1 && // short-circuit
             mayBeRead[i + 1]->threadId == currentWriteThreadId) {
-          expr nextw = z3_ctx.int_const(mayBeRead[i + 1]->eventName.c_str());
+          expr nextw = getOrderExpr(mayBeRead[i + 1]);
           // statics
           formulaNum++;
           rw = (rw && (r < nextw));
@@ -1339,11 +1916,8 @@ expr Encode::readFromWriteFormula(Event *read, Event *write, string var) {
   }
   // assert(I->getType()->getTypeID() == Type::PointerTyID && "Wrong Type!");
   const z3::sort varType(llvmTy_to_z3Ty(type));
-  expr r = z3_ctx.constant(read->globalName.c_str(), varType);
-  string writeVarName = "";
-  writeVarName = write->globalName;
-
-  expr w = z3_ctx.constant(writeVarName.c_str(), varType);
+  expr r = getValueExpr(read, varType);
+  expr w = getValueExpr(write, varType);
   return r == w;
 }
 /**
@@ -1356,7 +1930,7 @@ bool Encode::readFromInitFormula(Event *read, expr &ret) {
     type = type->getPointerElementType();
   }
   const z3::sort varType(llvmTy_to_z3Ty(type));
-  expr r = z3_ctx.constant(read->globalName.c_str(), varType);
+  expr r = getValueExpr(read, varType);
   string globalVar = read->name;
   std::map<std::string, llvm::Constant *>::iterator tempIt =
       trace->global_variable_initializer_RelatedToBranch.find(globalVar);
@@ -1394,13 +1968,93 @@ bool Encode::taintReadFromInitFormula(Event *read, expr &ret) {
 }
 
 expr Encode::enumerateOrder(Event *read, Event *write, Event *anotherWrite) {
-  expr prev = z3_ctx.int_const(write->eventName.c_str());
-  expr back = z3_ctx.int_const(read->eventName.c_str());
-  expr another = z3_ctx.int_const(anotherWrite->eventName.c_str());
+  expr prev = getOrderExpr(write);
+  expr back = getOrderExpr(read);
+  expr another = getOrderExpr(anotherWrite);
   expr o = another < prev || another > back;
   return o;
 }
 
+void Encode::buildPairwiseLockFormula(solver z3_solver_sync, vector<LockPair *> &lockPairs) {
+  unsigned size = lockPairs.size();
+  for (unsigned i = 0; i + 1 < size; i++) {
+    if (lockPairs[i]->unlockEvent == NULL) { // imcomplete lock pair
+      continue;
+    }
+    expr oneLock = getOrderExpr(lockPairs[i]->lockEvent);
+    expr oneUnlock = getOrderExpr(lockPairs[i]->unlockEvent);
+    for (unsigned j = i + 1; j < size; j++) {
+      if (lockPairs[i]->threadId == lockPairs[j]->threadId)
+        continue;
+      // the partial order formula already separates the two critical sections
+      if (happensBefore(lockPairs[i]->unlockEvent, lockPairs[j]->lockEvent) ||
+          (lockPairs[j]->unlockEvent && happensBefore(lockPairs[j]->unlockEvent, lockPairs[i]->lockEvent))) {
+        continue;
+      }
+
+      expr twoLock = getOrderExpr(lockPairs[j]->lockEvent);
+      expr twinLockPairOrder = z3_ctx.bool_val(1);
+      if (lockPairs[j]->unlockEvent == NULL) { // imcomplete lock pair
+        twinLockPairOrder = oneUnlock < twoLock;
+        // statics
+        formulaNum++;
+      } else {
+        expr twoUnlock = getOrderExpr(lockPairs[j]->unlockEvent);
+        twinLockPairOrder = (oneUnlock < twoLock) || (twoUnlock < oneLock);
+        // statics
+        formulaNum += 2;
+      }
+      z3_solver_sync.add(twinLockPairOrder);
+#if PRINT_FORMULA
+      std::cerr << twinLockPairOrder << "\n";
+#endif
+    }
+  }
+}
+
+void Encode::buildLinearLockFormula(solver z3_solver_sync, unsigned mutexIndex, vector<LockPair *> &lockPairs) {
+  // The critical sections take the distinct ranks 0..n-1 in the order they hold the mutex, lockAt/unlockAt/threadAt
+  // map a rank to its section. Only sections of adjacent ranks are ordered, the chain orders the others. An
+  // imcomplete lock pair holds the mutex until the end, so it takes the last rank.
+  unsigned size = lockPairs.size();
+  if (size < 2) {
+    return;
+  }
+  std::string name = "M" + std::to_string(mutexIndex) + "_";
+  z3::sort intSort = z3_ctx.int_sort();
+  func_decl lockAt = z3_ctx.function((name + "lockAt").c_str(), intSort, intSort);
+  func_decl unlockAt = z3_ctx.function((name + "unlockAt").c_str(), intSort, intSort);
+  func_decl threadAt = z3_ctx.function((name + "threadAt").c_str(), intSort, intSort);
+  expr_vector ranks(z3_ctx);
+  for (unsigned i = 0; i < size; i++) {
+    LockPair *lockPair = lockPairs[i];
+    expr rank = z3_ctx.int_const((name + "rank" + std::to_string(i)).c_str());
+    ranks.push_back(rank);
+    z3_solver_sync.add(rank >= 0 && rank < (int)size);
+    z3_solver_sync.add(lockAt(rank) == getOrderExpr(lockPair->lockEvent));
+    z3_solver_sync.add(threadAt(rank) == (int)lockPair->threadId);
+    if (lockPair->unlockEvent) {
+      z3_solver_sync.add(unlockAt(rank) == getOrderExpr(lockPair->unlockEvent));
+    } else {
+      z3_solver_sync.add(rank == (int)size - 1);
+    }
+  }
+  z3_solver_sync.add(distinct(ranks));
+  for (unsigned k = 0; k + 1 < size; k++) {
+    expr prev = z3_ctx.int_val(k);
+    expr next = z3_ctx.int_val(k + 1);
+    // sections of one thread may share a cluster at their boundary, program order already keeps them apart
+    expr adjacentOrder = unlockAt(prev) < lockAt(next) ||
+                         (threadAt(prev) == threadAt(next) && unlockAt(prev) <= lockAt(next));
+    z3_solver_sync.add(adjacentOrder);
+#if PRINT_FORMULA
+    std::cerr << adjacentOrder << "\n";
+#endif
+  }
+  // statics
+  formulaNum += 4 * size;
+}
+
 void Encode::buildSynchronizeFormula(solver z3_solver_sync) {
 #if PRINT_FORMULA
   std::cerr << "\nSynchronization Formula:\n";
@@ -1408,48 +2062,26 @@ void Encode::buildSynchronizeFormula(solver z3_solver_sync) {
 #endif
 
   // lock/unlock
-  map<string, vector<LockPair *>>::iterator it = trace->all_lock_unlock.begin();
-  for (; it != trace->all_lock_unlock.end(); it++) {
-    vector<LockPair *> tempVec = it->second;
-    int size = tempVec.size();
-    /////////////////////debug/////////////////////////////
-    // print out all the read and write insts of global vars.
-    if (false) {
-      std::cerr << it->first << "\n";
-      for (int k = 0; k < size; k++) {
-        std::cerr << "#lock#: " << tempVec[k]->lockEvent->eventName;
-        std::cerr << "  #unlock#: " << tempVec[k]->unlockEvent->eventName << "\n";
-      }
+  if (eventClocks.empty()) {
+    buildHappensBefore();
+  }
+  unsigned mutexIndex = 0;
+  for (auto &mutex : trace->all_lock_unlock) {
+    // buildSlice keeps all critical sections of a mutex or none
+    if (mutex.second.empty() || !isInSlice(mutex.second.front()->lockEvent)) {
+      mutexIndex++;
+      continue;
     }
-    /////////////////////debug/////////////////////////////
-    for (int i = 0; i < size - 1; i++) {
-      expr oneLock = z3_ctx.int_const(tempVec[i]->lockEvent->eventName.c_str());
-      if (tempVec[i]->unlockEvent == NULL) { // imcomplete lock pair
-        continue;
-      }
-      expr oneUnlock = z3_ctx.int_const(tempVec[i]->unlockEvent->eventName.c_str());
-      for (int j = i + 1; j < size; j++) {
-        if (tempVec[i]->threadId == tempVec[j]->threadId)
-          continue;
-
-        expr twoLock = z3_ctx.int_const(tempVec[j]->lockEvent->eventName.c_str());
-        expr twinLockPairOrder = z3_ctx.bool_val(1);
-        if (tempVec[j]->unlockEvent == NULL) { // imcomplete lock pair
-          twinLockPairOrder = oneUnlock < twoLock;
-          // statics
-          formulaNum++;
-        } else {
-          expr twoUnlock = z3_ctx.int_const(tempVec[j]->unlockEvent->eventName.c_str());
-          twinLockPairOrder = (oneUnlock < twoLock) || (twoUnlock < oneLock);
-          // statics
-          formulaNum += 2;
-        }
-        z3_solver_sync.add(twinLockPairOrder);
-#if PRINT_FORMULA
-        std::cerr << twinLockPairOrder << "\n";
-#endif
-      }
+    unsigned incomplete = 0;
+    for (auto lockPair : mutex.second) {
+      incomplete += lockPair->unlockEvent == NULL;
+    }
+    if (LockEncoding == LinearLockEncoding && incomplete <= 1) {
+      buildLinearLockFormula(z3_solver_sync, mutexIndex, mutex.second);
+    } else {
+      buildPairwiseLockFormula(z3_solver_sync, mutex.second);
     }
+    mutexIndex++;
   }
 
 // new method
@@ -1470,13 +2102,13 @@ void Encode::buildSynchronizeFormula(solver z3_solver_sync) {
     for (unsigned i = 0; i < waitSet.size(); i++) {
       vector<expr> possibleMap;
       vector<expr> possibleValue;
-      expr wait = z3_ctx.int_const(waitSet[i]->wait->eventName.c_str());
-      expr lock_wait = z3_ctx.int_const(waitSet[i]->lock_by_wait->eventName.c_str());
+      expr wait = getOrderExpr(waitSet[i]->wait);
+      expr lock_wait = getOrderExpr(waitSet[i]->lock_by_wait);
       vector<Event *> signalSet = it_signal->second;
       for (unsigned j = 0; j < signalSet.size(); j++) {
         if (waitSet[i]->wait->threadId == signalSet[j]->threadId)
           continue;
-        expr signal = z3_ctx.int_const(signalSet[j]->eventName.c_str());
+        expr signal = getOrderExpr(signalSet[j]);
         // Event_wait < Event_signal < lock_wait
         expr exprs_0 = wait < signal && signal < lock_wait;
 
@@ -1584,8 +2216,8 @@ void Encode::buildSynchronizeFormula(solver z3_solver_sync) {
     for (unsigned i = 0; i < temp.size() - 1; i++) {
       if (temp[i]->threadId == temp[i + 1]->threadId)
         assert(0 && "Two barrier event can't be in a same thread!");
-      expr exp1 = z3_ctx.int_const(temp[i]->eventName.c_str());
-      expr exp2 = z3_ctx.int_const(temp[i + 1]->eventName.c_str());
+      expr exp1 = getOrderExpr(temp[i]);
+      expr exp2 = getOrderExpr(temp[i + 1]);
       expr relation = (exp1 == exp2);
 
 #if PRINT_FORMULA
@@ -1690,7 +2322,7 @@ void Encode::buildTaintMatchFormula(solver z3_solver_tm) {
       for (unsigned k = 0; k < ir->second.size(); k++) {
         vector<expr> oneVarAllRead;
         currentRead = ir->second[k];
-        expr r = z3_ctx.int_const(currentRead->eventName.c_str());
+        expr r = getOrderExpr(currentRead);
         // compute the write set that may be used by currentRead;
         vector<Event *> mayBeRead;
         unsigned currentWriteThreadId;
@@ -1717,7 +2349,7 @@ void Encode::buildTaintMatchFormula(solver z3_solver_tm) {
             oneVarOneRead.push_back(equal);
             for (unsigned j = 0; j < mayBeRead.size(); j++) {
               currentWrite = mayBeRead[j];
-              expr w = z3_ctx.int_const(currentWrite->eventName.c_str());
+              expr w = getOrderExpr(currentWrite);
               expr order = r < w;
               oneVarOneRead.push_back(order);
             }
@@ -1737,7 +2369,7 @@ void Encode::buildTaintMatchFormula(solver z3_solver_tm) {
           expr equal = taintReadFromWriteFormula(currentRead, currentWrite, ir->first);
           oneVarOneRead.push_back(equal);
 
-          expr w = z3_ctx.int_const(currentWrite->eventName.c_str());
+          expr w = getOrderExpr(currentWrite);
           expr rw = (w < r);
           // statics
           formulaNum += 2;
@@ -1745,7 +2377,7 @@ void Encode::buildTaintMatchFormula(solver z3_solver_tm) {
           // the next write in the same thread must be behind this read.
           if (i + 1 <= mayBeRead.size() - 1 && // short-circuit
               mayBeRead[i + 1]->threadId == currentWriteThreadId) {
-            expr nextw = z3_ctx.int_const(mayBeRead[i + 1]->eventName.c_str());
+            expr nextw = getOrderExpr(mayBeRead[i + 1]);
             // statics
             formulaNum++;
             rw = (rw && (r < nextw));
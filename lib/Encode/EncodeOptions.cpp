@@ -0,0 +1,74 @@
+//===-- EncodeOptions.cpp ---------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Encode/EncodeOptions.h"
+#include "klee/Support/OptionCategories.h"
+
+#include <llvm/Support/CommandLine.h>
+
+#include <sstream>
+
+using namespace llvm;
+
+namespace {
+cl::opt<bool> FilterUnusedExprs("encode-filter-unused", cl::init(true),
+                                cl::desc("Drop the stores, reads and writes no branch or assertion depends on before "
+                                         "encoding a trace (default=true)"),
+                                cl::cat(klee::VerificationCat));
+
+cl::opt<bool> PresolveSharedVars("encode-presolve-shared", cl::init(false),
+                                 cl::desc("Only flip the branches depending on a variable shared by several threads "
+                                          "(default=false)"),
+                                 cl::cat(klee::VerificationCat));
+
+cl::opt<bool> ConcretizeReadValues("encode-concretize-reads", cl::init(false),
+                                   cl::desc("Fix the values read before a flipped branch which the branch does not "
+                                            "depend on (default=false)"),
+                                   cl::cat(klee::VerificationCat));
+
+cl::opt<bool> DoDSTAM("dstam", cl::init(false),
+                      cl::desc("Carry out the taint analysis (DSTAM) on each trace (default=false)"),
+                      cl::cat(klee::VerificationCat));
+
+cl::opt<bool> VerifyAssertions("verify-assertions", cl::init(true),
+                               cl::desc("Verify the assertions on each trace (default=true)"),
+                               cl::cat(klee::VerificationCat));
+
+cl::opt<bool> IntArithmetic("encode-int-arithmetic", cl::init(false),
+                            cl::desc("Encode the integers as unbounded integers instead of 64 bit vectors "
+                                     "(default=false)"),
+                            cl::cat(klee::VerificationCat));
+} // namespace
+
+namespace klee {
+
+EncodeOptions::EncodeOptions()
+    : filterUnusedExprs(true), presolveSharedVars(false), concretizeReadValues(false), doDSTAM(false),
+      verifyAssertions(true), intArithmetic(false) {}
+
+EncodeOptions EncodeOptions::fromCommandLine() {
+  EncodeOptions options;
+  options.filterUnusedExprs = FilterUnusedExprs;
+  options.presolveSharedVars = PresolveSharedVars;
+  options.concretizeReadValues = ConcretizeReadValues;
+  options.doDSTAM = DoDSTAM;
+  options.verifyAssertions = VerifyAssertions;
+  options.intArithmetic = IntArithmetic;
+  return options;
+}
+
+std::string EncodeOptions::toString() const {
+  std::stringstream ss;
+  ss << "filter-unused=" << filterUnusedExprs << " presolve-shared=" << presolveSharedVars
+     << " concretize-reads=" << concretizeReadValues << " dstam=" << doDSTAM
+     << " verify-assertions=" << verifyAssertions << " int-arithmetic=" << intArithmetic;
+  return ss.str();
+}
+
+} // namespace klee
@@ -24,9 +24,10 @@ namespace klee {
 
 Event::Event(unsigned threadId, unsigned eventId, string eventName, KInstruction *inst, string varName,
              string globalName, EventType eventType)
-    : threadId(threadId), eventId(eventId), eventName(eventName), inst(inst), name(varName), globalName(globalName),
-      eventType(eventType), latestWriteEventInSameThread(NULL), isGlobal(false), isEventRelatedToBranch(false),
-      isConditionInst(false), brCondition(false), isFunctionWithSourceCode(true), calledFunction(NULL) {
+    : threadId(threadId), eventId(eventId), orderId(eventId), eventName(eventName), inst(inst), name(varName),
+      globalName(globalName), eventType(eventType), latestWriteEventInSameThread(NULL), isGlobal(false),
+      isEventRelatedToBranch(false), isConditionInst(false), brCondition(false), isFunctionWithSourceCode(true),
+      calledFunction(NULL) {
   threadEventId = 0;
 }
 
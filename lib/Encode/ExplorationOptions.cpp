@@ -0,0 +1,79 @@
+//===-- ExplorationOptions.cpp ----------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Encode/ExplorationOptions.h"
+#include "klee/Config/Version.h"
+#include "klee/Support/OptionCategories.h"
+
+#include <llvm/Support/CommandLine.h>
+
+#include <sstream>
+
+using namespace llvm;
+
+namespace {
+cl::opt<bool> DoDPOR("dpor", cl::init(false),
+                     cl::desc("Explore the thread interleavings by dynamic partial-order reduction with sleep sets "
+                              "instead of flipping the branches of each trace with the solver (default=false)"),
+                     cl::cat(klee::VerificationCat));
+
+cl::opt<int> ScheduleBound("schedule-bound", cl::init(-1),
+                           cl::desc("Explore the schedules with at most this many preemptions or delays, see "
+                                    "-schedule-bound-type, by increasing bound instead of flipping the branches of "
+                                    "each trace with the solver, -1 to disable (default=-1)"),
+                           cl::cat(klee::VerificationCat));
+
+enum ScheduleBoundType { PreemptionBound, DelayBound };
+
+cl::opt<ScheduleBoundType> ScheduleBoundKind(
+    "schedule-bound-type", cl::desc("What -schedule-bound counts (default=preemption)"),
+    cl::values(clEnumValN(PreemptionBound, "preemption", "switches away from a thread which could go on"),
+               clEnumValN(DelayBound, "delay", "enabled threads skipped in the order of the thread ids")
+                   KLEE_LLVM_CL_VAL_END),
+    cl::init(PreemptionBound), cl::cat(klee::VerificationCat));
+
+cl::opt<unsigned> PCTRuns("pct-runs", cl::init(0),
+                          cl::desc("Run the program this many times with the randomized PCT scheduler after the "
+                                   "initial run instead of exploring the schedules, 0 to disable (default=0)"),
+                          cl::cat(klee::VerificationCat));
+
+cl::opt<unsigned> PCTDepth("pct-depth", cl::init(3),
+                           cl::desc("Bug depth of -pct-runs, the runs change the thread priorities at depth-1 "
+                                    "random points (default=3)"),
+                           cl::cat(klee::VerificationCat));
+
+cl::opt<unsigned> PCTSeed("pct-seed", cl::init(1),
+                          cl::desc("Seed of the first run of -pct-runs, the next runs count up from it (default=1)"),
+                          cl::cat(klee::VerificationCat));
+} // namespace
+
+namespace klee {
+
+ExplorationOptions::ExplorationOptions()
+    : dpor(false), scheduleBound(-1), delayBounding(false), pctRuns(0), pctDepth(3), pctSeed(1) {}
+
+ExplorationOptions ExplorationOptions::fromCommandLine() {
+  ExplorationOptions options;
+  options.dpor = DoDPOR;
+  options.scheduleBound = ScheduleBound;
+  options.delayBounding = ScheduleBoundKind == DelayBound;
+  options.pctRuns = PCTRuns;
+  options.pctDepth = PCTDepth;
+  options.pctSeed = PCTSeed;
+  return options;
+}
+
+std::string ExplorationOptions::toString() const {
+  std::stringstream ss;
+  ss << "dpor=" << dpor << " schedule-bound=" << scheduleBound << (delayBounding ? " delay" : " preemption")
+     << " pct-runs=" << pctRuns << " pct-depth=" << pctDepth << " pct-seed=" << pctSeed;
+  return ss.str();
+}
+
+} // namespace klee
@@ -15,6 +15,7 @@
 #include <iterator>
 #include <map>
 #include <sstream>
+#include <unordered_set>
 #include <utility>
 
 #include <llvm/IR/Constant.h>
@@ -23,6 +24,7 @@
 
 #include "klee/Encode/Event.h"
 #include "klee/Encode/FilterSymbolicExpr.h"
+#include "klee/Expr/ExprHashMap.h"
 #include "klee/Module/KInstruction.h"
 #include "klee/Config/DebugMacro.h"
 
@@ -37,14 +39,8 @@ std::string FilterSymbolicExpr::getName(ref<klee::Expr> value) {
 }
 
 std::string FilterSymbolicExpr::getName(std::string globalName) {
-  std::stringstream name;
-  name.str("");
-  unsigned int i = 0;
-  while ((globalName.at(i) != 'S') && (globalName.at(i) != 'L')) {
-    name << globalName.at(i);
-    i++;
-  }
-  return name.str();
+  // the variable name is the part of the global name before the read / write sequence
+  return globalName.substr(0, globalName.find_first_of("SL"));
 }
 
 std::string FilterSymbolicExpr::getGlobalName(ref<klee::Expr> value) {
@@ -62,51 +58,56 @@ std::string FilterSymbolicExpr::getGlobalName(ref<klee::Expr> value) {
 }
 
 void FilterSymbolicExpr::resolveSymbolicExpr(ref<klee::Expr> symbolicExpr, std::set<std::string> &relatedSymbolicExpr) {
-  if (symbolicExpr->getKind() == Expr::Read) {
-    std::string name = getName(symbolicExpr);
-    if (relatedSymbolicExpr.find(name) == relatedSymbolicExpr.end()) {
-      relatedSymbolicExpr.insert(name);
+  // the expressions are DAGs, every shared subexpression and every array is only looked at once
+  std::unordered_set<const Expr *> visited;
+  std::unordered_set<const Array *> visitedArrays;
+  std::vector<const Expr *> worklist;
+  worklist.push_back(symbolicExpr.get());
+  while (!worklist.empty()) {
+    const Expr *e = worklist.back();
+    worklist.pop_back();
+    if (!visited.insert(e).second) {
+      continue;
     }
-    return;
-  } else {
-    unsigned kidsNum = symbolicExpr->getNumKids();
-    if (kidsNum == 2 && symbolicExpr->getKid(0) == symbolicExpr->getKid(1)) {
-      resolveSymbolicExpr(symbolicExpr->getKid(0), relatedSymbolicExpr);
-    } else {
-      for (unsigned int i = 0; i < kidsNum; i++) {
-        resolveSymbolicExpr(symbolicExpr->getKid(i), relatedSymbolicExpr);
+    if (const ReadExpr *re = dyn_cast<ReadExpr>(e)) {
+      if (visitedArrays.insert(re->updates.root).second) {
+        relatedSymbolicExpr.insert(getName(re->updates.root->name));
       }
+      continue;
+    }
+    for (unsigned i = 0; i < e->getNumKids(); i++) {
+      worklist.push_back(e->getKid(i).get());
     }
   }
 }
 
 void FilterSymbolicExpr::resolveTaintExpr(ref<klee::Expr> taintExpr, std::vector<ref<klee::Expr>> &relatedTaintExpr,
                                           bool &isTaint) {
-  if (taintExpr->getKind() == Expr::Concat || taintExpr->getKind() == Expr::Read) {
-    unsigned i;
-    for (i = 0; i < relatedTaintExpr.size(); i++) {
-      if (relatedTaintExpr[i] == taintExpr) {
-        break;
-      }
+  ExprHashSet related(relatedTaintExpr.begin(), relatedTaintExpr.end());
+  std::unordered_set<const Expr *> visited;
+  std::vector<ref<klee::Expr>> worklist;
+  worklist.push_back(taintExpr);
+  while (!worklist.empty()) {
+    ref<klee::Expr> e = worklist.back();
+    worklist.pop_back();
+    if (!visited.insert(e.get()).second) {
+      continue;
     }
-    if (i == relatedTaintExpr.size()) {
-      relatedTaintExpr.push_back(taintExpr);
-      if (taintExpr->isTaint) {
+    if (e->getKind() == Expr::Concat || e->getKind() == Expr::Read) {
+      if (related.insert(e).second) {
+        relatedTaintExpr.push_back(e);
+        if (e->isTaint) {
+          isTaint = true;
+        }
+      }
+    } else if (e->getKind() == Expr::Constant) {
+      if (e->isTaint) {
         isTaint = true;
       }
-    }
-    return;
-  } else if (taintExpr->getKind() == Expr::Constant) {
-    if (taintExpr->isTaint) {
-      isTaint = true;
-    }
-  } else {
-    unsigned kidsNum = taintExpr->getNumKids();
-    if (kidsNum == 2 && taintExpr->getKid(0) == taintExpr->getKid(1)) {
-      resolveTaintExpr(taintExpr->getKid(0), relatedTaintExpr, isTaint);
     } else {
-      for (unsigned int i = 0; i < kidsNum; i++) {
-        resolveTaintExpr(taintExpr->getKid(i), relatedTaintExpr, isTaint);
+      // reversed, so the kids are resolved from left to right as before
+      for (unsigned i = e->getNumKids(); i > 0; i--) {
+        worklist.push_back(e->getKid(i - 1));
       }
     }
   }
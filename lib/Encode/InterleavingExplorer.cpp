@@ -0,0 +1,234 @@
+//===-- InterleavingExplorer.cpp --------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Encode/InterleavingExplorer.h"
+#include "klee/Encode/Event.h"
+
+#include <llvm/IR/Instruction.h>
+
+#include <algorithm>
+
+using namespace std;
+
+namespace klee {
+
+InterleavingExplorer::InterleavingExplorer(RuntimeDataManager *data) : runtimeData(data), trace(NULL) {}
+
+unsigned InterleavingExplorer::getObject(const string &name) {
+  auto oi = objectIds.insert(make_pair(name, objects.size()));
+  if (oi.second) {
+    objects.push_back(name);
+  }
+  return oi.first->second;
+}
+
+void InterleavingExplorer::addAccess(Event *event, unsigned position, const string &name, bool isWrite, bool isLock,
+                                     bool isWait) {
+  Access access;
+  access.position = position;
+  access.threadId = event->threadId;
+  access.object = getObject(name);
+  access.isWrite = isWrite;
+  access.isLock = isLock;
+  access.isWait = isWait;
+  accesses.push_back(access);
+  stops[position] = true;
+}
+
+void InterleavingExplorer::indexTrace() {
+  trace = runtimeData->getCurrentTrace();
+  objects.clear();
+  objectIds.clear();
+  accesses.clear();
+  threadEvents.clear();
+  createdAt.clear();
+  creates.clear();
+  joins.clear();
+  releases.clear();
+  lockSpans.clear();
+  stops.assign(trace->path.size(), false);
+
+  unordered_map<Event *, unsigned> positions;
+  positions.reserve(trace->path.size());
+  for (unsigned i = 0; i < trace->path.size(); i++) {
+    Event *event = trace->path[i];
+    positions[event] = i;
+    threadEvents[event->threadId].push_back(i);
+    if (event->isGlobal && !event->name.empty()) {
+      unsigned opcode = event->inst->inst->getOpcode();
+      if (opcode == llvm::Instruction::Load || opcode == llvm::Instruction::Store) {
+        addAccess(event, i, event->name, opcode == llvm::Instruction::Store, false, false);
+      }
+    }
+  }
+  // the virtual lock of a pthread_cond_wait is not on the path, the wait is its unlock
+  for (auto &mutex : trace->all_lock_unlock) {
+    for (auto lockPair : mutex.second) {
+      auto li = positions.find(lockPair->lockEvent);
+      if (li == positions.end()) {
+        continue;
+      }
+      addAccess(lockPair->lockEvent, li->second, "lock:" + mutex.first, true, true, false);
+      unsigned unlock = UINT_MAX;
+      auto ui = lockPair->unlockEvent ? positions.find(lockPair->unlockEvent) : positions.end();
+      if (ui != positions.end()) {
+        unlock = ui->second;
+        releases.insert(make_pair(unlock, accesses.back().object));
+      }
+      lockSpans.push_back(make_pair(accesses.back().object, make_pair(li->second, unlock)));
+    }
+  }
+  for (auto &cond : trace->all_wait) {
+    for (auto waitLock : cond.second) {
+      auto wi = positions.find(waitLock->wait);
+      if (wi != positions.end()) {
+        addAccess(waitLock->wait, wi->second, "cond:" + cond.first, true, false, true);
+      }
+    }
+  }
+  for (auto &cond : trace->all_signal) {
+    for (auto signal : cond.second) {
+      auto si = positions.find(signal);
+      if (si != positions.end()) {
+        addAccess(signal, si->second, "cond:" + cond.first, true, false, false);
+      }
+    }
+  }
+  for (auto &barrier : trace->all_barrier) {
+    for (auto wait : barrier.second) {
+      auto wi = positions.find(wait);
+      if (wi != positions.end()) {
+        addAccess(wait, wi->second, "barrier:" + barrier.first, true, false, false);
+      }
+    }
+  }
+  stable_sort(accesses.begin(), accesses.end(),
+              [](const Access &a, const Access &b) { return a.position < b.position; });
+
+  for (auto &create : trace->createThreadPoint) {
+    auto ci = positions.find(create.first);
+    if (ci != positions.end()) {
+      createdAt[create.second] = ci->second;
+      creates.insert(make_pair(ci->second, create.second));
+    }
+  }
+  for (auto &join : trace->joinThreadPoint) {
+    auto ji = positions.find(join.first);
+    if (ji != positions.end()) {
+      joins[ji->second] = join.second;
+      stops[ji->second] = true;
+    }
+  }
+}
+
+unsigned InterleavingExplorer::getAccessAt(unsigned position) {
+  auto ai = lower_bound(accesses.begin(), accesses.end(), position,
+                        [](const Access &access, unsigned position) { return access.position < position; });
+  if (ai == accesses.end() || ai->position != position) {
+    return UINT_MAX;
+  }
+  return ai - accesses.begin();
+}
+
+bool InterleavingExplorer::getPendingEvents(unsigned threadId, unsigned position, vector<unsigned> &pending) {
+  auto ti = threadEvents.find(threadId);
+  if (ti == threadEvents.end()) {
+    return false;
+  }
+  vector<unsigned> &events = ti->second;
+  for (auto ei = upper_bound(events.begin(), events.end(), position); ei != events.end(); ei++) {
+    pending.push_back(*ei);
+    if (stops[*ei]) {
+      return true;
+    }
+  }
+  // the thread ends without another access, nothing it does can race
+  return false;
+}
+
+bool InterleavingExplorer::isHeld(unsigned object, unsigned position, unsigned threadId) {
+  for (auto &span : lockSpans) {
+    if (span.first == object && span.second.first < position && span.second.second >= position &&
+        trace->path[span.second.first]->threadId != threadId) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool InterleavingExplorer::isBlocked(unsigned threadId, unsigned position) {
+  auto ti = threadEvents.find(threadId);
+  if (ti == threadEvents.end()) {
+    return false;
+  }
+  vector<unsigned> &events = ti->second;
+  auto ei = lower_bound(events.begin(), events.end(), position);
+  if (ei == events.begin()) {
+    return false;
+  }
+  unsigned last = *(ei - 1);
+  auto ji = joins.find(last);
+  if (ji != joins.end()) {
+    auto ui = threadEvents.find(ji->second);
+    return ui != threadEvents.end() && ui->second.back() >= position;
+  }
+  unsigned access = getAccessAt(last);
+  if (access == UINT_MAX) {
+    return false;
+  }
+  if (accesses[access].isLock) {
+    // the lock events are recorded when lock is called, the mutex is acquired once the holder which called before
+    // unlocks it
+    for (auto &span : lockSpans) {
+      if (span.first == accesses[access].object && span.second.first < last && span.second.second >= position &&
+          trace->path[span.second.first]->threadId != threadId) {
+        return true;
+      }
+    }
+  } else if (accesses[access].isWait) {
+    for (unsigned a = access + 1; a < accesses.size() && accesses[a].position < position; a++) {
+      if (accesses[a].object == accesses[access].object && !accesses[a].isWait) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+bool InterleavingExplorer::isEnabled(unsigned threadId, unsigned position) {
+  auto ci = createdAt.find(threadId);
+  if (ci != createdAt.end() && ci->second >= position) {
+    return false;
+  }
+  vector<unsigned> pending;
+  if (!getPendingEvents(threadId, position, pending) || isBlocked(threadId, position)) {
+    return false;
+  }
+  unsigned last = pending.back();
+  auto ji = joins.find(last);
+  if (ji != joins.end()) {
+    auto ti = threadEvents.find(ji->second);
+    return ti == threadEvents.end() || ti->second.back() < position;
+  }
+  unsigned access = getAccessAt(last);
+  return access == UINT_MAX || !accesses[access].isLock || !isHeld(accesses[access].object, position, threadId);
+}
+
+Prefix *InterleavingExplorer::createPrefix(unsigned position, unsigned threadId, const string &name) {
+  vector<unsigned> pending;
+  getPendingEvents(threadId, position, pending);
+  vector<Event *> events(trace->path.begin(), trace->path.begin() + position);
+  for (auto p : pending) {
+    events.push_back(trace->path[p]);
+  }
+  return new Prefix(events, trace->createThreadPoint, name);
+}
+
+} // namespace klee
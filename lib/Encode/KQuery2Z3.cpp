@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <math.h>
+#include <utility>
 
 #include "klee/Encode/KQuery2Z3.h"
 #include "klee/Expr/Expr.h"
@@ -21,10 +22,11 @@ using namespace z3;
 #define BIT_WIDTH 64
 
 // constructor
-KQuery2Z3::KQuery2Z3(std::vector<ref<Expr>> &_kqueryExpr, z3::context &_z3_ctx)
-    : kqueryExpr(_kqueryExpr), z3_ctx(_z3_ctx) {}
+KQuery2Z3::KQuery2Z3(std::vector<ref<Expr>> &_kqueryExpr, z3::context &_z3_ctx, bool _intArithmetic)
+    : kqueryExpr(_kqueryExpr), z3_ctx(_z3_ctx), intArithmetic(_intArithmetic), floatMarks(0) {}
 
-KQuery2Z3::KQuery2Z3(z3::context &_z3_ctx) : z3_ctx(_z3_ctx) {}
+KQuery2Z3::KQuery2Z3(z3::context &_z3_ctx, bool _intArithmetic)
+    : z3_ctx(_z3_ctx), intArithmetic(_intArithmetic), floatMarks(0) {}
 
 KQuery2Z3::~KQuery2Z3() {}
 
@@ -82,7 +84,54 @@ void KQuery2Z3::getZ3Expr() {
   }
 }
 
+void KQuery2Z3::markFloat(ref<Expr> &e) {
+  if (!e->isFloat) {
+    e->isFloat = true;
+    // the signatures of e and of the expressions containing it are stale, the translations are kept under theirs
+    exprSignatures.clear();
+    floatMarks++;
+  }
+}
+
+unsigned KQuery2Z3::getFloatSignature(const ref<Expr> &e) {
+  auto it = exprSignatures.find(e.get());
+  if (it != exprSignatures.end()) {
+    return it->second.second;
+  }
+  std::vector<unsigned> flags;
+  flags.reserve(e->getNumKids() + 1);
+  flags.push_back(e->isFloat);
+  for (unsigned i = 0; i < e->getNumKids(); i++) {
+    flags.push_back(getFloatSignature(e->getKid(i)));
+  }
+  unsigned signature = floatSignatures.insert(std::make_pair(flags, floatSignatures.size())).first->second;
+  exprSignatures.insert(std::make_pair(e.get(), std::make_pair(e, signature)));
+  return signature;
+}
+
 z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
+  if (isa<ConstantExpr>(ele)) {
+    return translateExpr(ele);
+  }
+  unsigned signature = getFloatSignature(ele);
+  auto it = z3Exprs.find(ele);
+  if (it != z3Exprs.end()) {
+    for (auto &translation : it->second) {
+      if (translation.first == signature) {
+        return translation.second;
+      }
+    }
+  }
+  unsigned marks = floatMarks;
+  z3::expr res = translateExpr(ele);
+  // a flag set while translating ele may leave res inconsistent with the signature, do not keep it
+  if (marks == floatMarks) {
+    z3Exprs[ele].push_back(std::make_pair(signature, res));
+  }
+  return res;
+}
+
+z3::expr KQuery2Z3::translateExpr(ref<Expr> &ele) {
   z3::expr res = z3_ctx.bool_val(true);
 
   switch (ele->getKind()) {
@@ -119,11 +168,11 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
           }
         } else if (width != Expr::Fl80) {
           int temp = ce->getZExtValue();
-#if INT_ARITHMETIC
-          res = z3_ctx.int_val(temp);
-#else
-          res = z3_ctx.bv_val(temp, BIT_WIDTH);
-#endif
+          if (intArithmetic) {
+            res = z3_ctx.int_val(temp);
+          } else {
+            res = z3_ctx.bv_val(temp, BIT_WIDTH);
+          }
 
         } else {
           assert(0 && "The Fl80 out, value bit number extends 64");
@@ -145,11 +194,11 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
       if (re->getWidth() == Expr::Bool) {
         res = z3_ctx.bool_const(varName.c_str());
       } else {
-#if INT_ARITHMETIC
-        res = z3_ctx.constant(varName.c_str(), z3_ctx.int_sort());
-#else
-        res = z3_ctx.constant(varName.c_str(), z3_ctx.bv_sort(BIT_WIDTH));
-#endif
+        if (intArithmetic) {
+          res = z3_ctx.constant(varName.c_str(), z3_ctx.int_sort());
+        } else {
+          res = z3_ctx.constant(varName.c_str(), z3_ctx.bv_sort(BIT_WIDTH));
+        }
       }
       return res;
     }
@@ -181,12 +230,10 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
       } else {
         if (ele.get()->isFloat)
           res = z3_ctx.constant(varName.c_str(), z3_ctx.real_sort());
-        else
-#if INT_ARITHMETIC
+        else if (intArithmetic)
           res = z3_ctx.constant(varName.c_str(), z3_ctx.int_sort());
-#else
+        else
           res = z3_ctx.constant(varName.c_str(), z3_ctx.bv_sort(BIT_WIDTH));
-#endif
       }
       return res;
     }
@@ -199,26 +246,18 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
       if (ee->expr.get()->isFloat && !ee->isFloat) {
         // handle fptosi and fptoui
         try {
-#if INT_ARITHMETIC
           z3::expr temp = z3::to_expr(z3_ctx, Z3_mk_real2int(z3_ctx, src));
-#else
-          z3::expr temp = z3::to_expr(z3_ctx, Z3_mk_real2int(z3_ctx, src));
-          z3::expr vecTemp = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, temp));
-#endif
+          z3::expr vecTemp = intArithmetic ? temp : z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, temp));
           if (ee->width == Expr::Bool) {
             // handle double->bool the special
-#if INT_ARITHMETIC
-            res = z3::ite(temp, z3_ctx.bool_val(1), z3_ctx.bool_val(0));
-#else
-            res = z3::ite(z3::to_expr(z3_ctx, Z3_mk_extract(z3_ctx, 0, 0, vecTemp)), z3_ctx.bv_val(1, BIT_WIDTH),
-                          z3_ctx.bv_val(0, BIT_WIDTH));
-#endif
+            if (intArithmetic) {
+              res = z3::ite(temp, z3_ctx.bool_val(1), z3_ctx.bool_val(0));
+            } else {
+              res = z3::ite(z3::to_expr(z3_ctx, Z3_mk_extract(z3_ctx, 0, 0, vecTemp)), z3_ctx.bv_val(1, BIT_WIDTH),
+                            z3_ctx.bv_val(0, BIT_WIDTH));
+            }
           } else {
-#if INT_ARITHMETIC
-            res = temp;
-#else
             res = vecTemp;
-#endif
           }
         } catch (z3::exception &ex) {
           std::cerr << "exception = " << ex << std::endl;
@@ -228,12 +267,12 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
         // have same type before or after convert.
         if (ee->width == Expr::Bool) {
           // handle int->bool the special
-#if INT_ARITHMETIC
-          res = z3::ite(src, z3_ctx.int_val(1), z3_ctx.int_val(0));
-#else
-          res = z3::ite(z3::to_expr(z3_ctx, Z3_mk_extract(z3_ctx, 0, 0, src)), z3_ctx.bv_val(1, BIT_WIDTH),
-                        z3_ctx.bv_val(0, BIT_WIDTH));
-#endif
+          if (intArithmetic) {
+            res = z3::ite(src, z3_ctx.int_val(1), z3_ctx.int_val(0));
+          } else {
+            res = z3::ite(z3::to_expr(z3_ctx, Z3_mk_extract(z3_ctx, 0, 0, src)), z3_ctx.bv_val(1, BIT_WIDTH),
+                          z3_ctx.bv_val(0, BIT_WIDTH));
+          }
 
         } else {
           res = src;
@@ -251,13 +290,13 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
       z3::expr src = eachExprToZ3(ce->src);
 
       if (ce->src.get()->getWidth() == Expr::Bool) {
-#if INT_ARITHMETIC
-        res = z3::ite(src, z3_ctx.int_val(1), z3_ctx.int_val(0));
-#else
-        res = z3::ite(src, z3_ctx.bv_val(1, BIT_WIDTH), z3_ctx.bv_val(0, BIT_WIDTH));
-        // res = z3::ite(z3::to_expr(z3_ctx, Z3_mk_extract(z3_ctx, 0, 0, src)), z3_ctx.bool_val(true),
-        //               z3_ctx.bool_val(false));
-#endif
+        if (intArithmetic) {
+          res = z3::ite(src, z3_ctx.int_val(1), z3_ctx.int_val(0));
+        } else {
+          res = z3::ite(src, z3_ctx.bv_val(1, BIT_WIDTH), z3_ctx.bv_val(0, BIT_WIDTH));
+          // res = z3::ite(z3::to_expr(z3_ctx, Z3_mk_extract(z3_ctx, 0, 0, src)), z3_ctx.bool_val(true),
+          //               z3_ctx.bool_val(false));
+        }
         // if (Z3_TRUE == Z3_algebraic_is_zero(z3_ctx, src)) {
         //   res = z3_ctx.bool_val(false);
         // } else {
@@ -279,24 +318,19 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
         z3::expr src = eachExprToZ3(ce->src);
         if (ce->isFloat && !ce->src.get()->isFloat) {
           try {
-#if INT_ARITHMETIC
-          z3::expr realTemp = to_expr(z3_ctx, Z3_mk_int2real(z3_ctx, src));
-
-#else
-          z3::expr temp = to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, src, true));
+          z3::expr temp = intArithmetic ? src : to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, src, true));
           z3::expr realTemp = to_expr(z3_ctx, Z3_mk_int2real(z3_ctx, temp));
-#endif
           res = realTemp;
         } catch (z3::exception &ex) {
           std::cerr << "exception = " << ex << std::endl;
         }
       } else if (!ce->isFloat && !ce->src.get()->isFloat) {
         if (ce->src.get()->getWidth() == Expr::Bool && ce->width != Expr::Bool) {
-#if INT_ARITHMETIC
-          res = z3::ite(src, z3_ctx.int_val(1), z3_ctx.int_val(0));
-#else
-          res = z3::ite(src, z3_ctx.bv_val(1, BIT_WIDTH), z3_ctx.bv_val(0, BIT_WIDTH));
-#endif
+          if (intArithmetic) {
+            res = z3::ite(src, z3_ctx.int_val(1), z3_ctx.int_val(0));
+          } else {
+            res = z3::ite(src, z3_ctx.bv_val(1, BIT_WIDTH), z3_ctx.bv_val(0, BIT_WIDTH));
+          }
         //   res = z3::ite(src, z3_ctx.bool_val(true), z3_ctx.bool_val(false));
         //   res = z3::ite(z3::to_expr(z3_ctx, Z3_mk_extract(z3_ctx, 0, 0, src)), z3_ctx.bool_val(true),
         //                 z3_ctx.bool_val(false));
@@ -321,8 +355,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
       // if one of the operand is a float point number
       // then the left and right are all float point number.
       if (ae->left.get()->isFloat || ae->right.get()->isFloat) {
-        ae->left.get()->isFloat = true;
-        ae->right.get()->isFloat = true;
+        markFloat(ae->left);
+        markFloat(ae->right);
       }
       z3::expr left = eachExprToZ3(ae->left);
       z3::expr right = eachExprToZ3(ae->right);
@@ -336,8 +370,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::Sub: {
       SubExpr *se = cast<SubExpr>(ele);
       if (se->left.get()->isFloat || se->right.get()->isFloat) {
-        se->left.get()->isFloat = true;
-        se->right.get()->isFloat = true;
+        markFloat(se->left);
+        markFloat(se->right);
       }
       z3::expr left = eachExprToZ3(se->left);
       z3::expr right = eachExprToZ3(se->right);
@@ -351,8 +385,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::Mul: {
       MulExpr *me = cast<MulExpr>(ele);
       if (me->left.get()->isFloat || me->right.get()->isFloat) {
-        me->left.get()->isFloat = true;
-        me->right.get()->isFloat = true;
+        markFloat(me->left);
+        markFloat(me->right);
       }
       z3::expr left = eachExprToZ3(me->left);
       z3::expr right = eachExprToZ3(me->right);
@@ -368,8 +402,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
       // could handled with SDiv, but for test just do in here.
       UDivExpr *ue = cast<UDivExpr>(ele);
       if (ue->left.get()->isFloat || ue->right.get()->isFloat) {
-        ue->left.get()->isFloat = true;
-        ue->right.get()->isFloat = true;
+        markFloat(ue->left);
+        markFloat(ue->right);
       }
       z3::expr left = eachExprToZ3(ue->left);
       z3::expr right = eachExprToZ3(ue->right);
@@ -388,8 +422,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::SDiv: {
       SDivExpr *se = cast<SDivExpr>(ele);
       if (se->left.get()->isFloat || se->right.get()->isFloat) {
-        se->left.get()->isFloat = true;
-        se->right.get()->isFloat = true;
+        markFloat(se->left);
+        markFloat(se->right);
       }
       z3::expr left = eachExprToZ3(se->left);
       z3::expr right = eachExprToZ3(se->right);
@@ -409,8 +443,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::URem: {
       URemExpr *ur = cast<URemExpr>(ele);
       if (ur->left.get()->isFloat || ur->right.get()->isFloat) {
-        ur->left.get()->isFloat = true;
-        ur->right.get()->isFloat = true;
+        markFloat(ur->left);
+        markFloat(ur->right);
       }
       z3::expr left = eachExprToZ3(ur->left);
       z3::expr right = eachExprToZ3(ur->right);
@@ -431,8 +465,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::SRem: {
       SRemExpr *sr = cast<SRemExpr>(ele);
       if (sr->left.get()->isFloat || sr->right.get()->isFloat) {
-        sr->left.get()->isFloat = true;
-        sr->right.get()->isFloat = true;
+        markFloat(sr->left);
+        markFloat(sr->right);
       }
       z3::expr left = eachExprToZ3(sr->left);
       z3::expr right = eachExprToZ3(sr->right);
@@ -468,8 +502,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::And: {
       AndExpr *ae = cast<AndExpr>(ele);
       if (ae->left.get()->isFloat || ae->right.get()->isFloat) {
-        ae->left.get()->isFloat = true;
-        ae->right.get()->isFloat = true;
+        markFloat(ae->left);
+        markFloat(ae->right);
       }
       z3::expr left = eachExprToZ3(ae->left);
       z3::expr right = eachExprToZ3(ae->right);
@@ -478,27 +512,27 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
       } else {
 // std::cerr << "left = " << left << ", left sort = " << left.get_sort() << std::endl;
 // std::cerr << "right = " << right << ", right sort = " << right.get_sort() << std::endl;
-#if INT_ARITHMETIC
-        try {
-          if (left.is_int()) {
-            z3::expr tempLeft = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, left));
-            //						std::cerr << "tempLeft = " << tempLeft << std::endl;
-            z3::expr tempRight = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, right));
-            //						std::cerr << "tempRight = " << tempRight << std::endl;
-
-            z3::expr tempRes = z3::to_expr(z3_ctx, Z3_mk_bvand(z3_ctx, tempLeft, tempRight));
-            //						std::cerr << "tempRes = " << tempRes << std::endl;
-            res = z3::to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, tempRes, true));
-            //						std::cerr << "res = " << res << std::endl;
-          } else {
-            res = left && right;
+        if (intArithmetic) {
+          try {
+            if (left.is_int()) {
+              z3::expr tempLeft = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, left));
+              //						std::cerr << "tempLeft = " << tempLeft << std::endl;
+              z3::expr tempRight = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, right));
+              //						std::cerr << "tempRight = " << tempRight << std::endl;
+
+              z3::expr tempRes = z3::to_expr(z3_ctx, Z3_mk_bvand(z3_ctx, tempLeft, tempRight));
+              //						std::cerr << "tempRes = " << tempRes << std::endl;
+              res = z3::to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, tempRes, true));
+              //						std::cerr << "res = " << res << std::endl;
+            } else {
+              res = left && right;
+            }
+          } catch (z3::exception &ex) {
+            std::cerr << "And exception = " << ex << std::endl;
           }
-        } catch (z3::exception &ex) {
-          std::cerr << "And exception = " << ex << std::endl;
+        } else {
+          res = left && right;
         }
-#else
-        res = left && right;
-#endif
       }
       return res;
     }
@@ -506,30 +540,30 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::Or: {
       OrExpr *oe = cast<OrExpr>(ele);
       if (oe->left.get()->isFloat || oe->right.get()->isFloat) {
-        oe->left.get()->isFloat = true;
-        oe->right.get()->isFloat = true;
+        markFloat(oe->left);
+        markFloat(oe->right);
       }
       z3::expr left = eachExprToZ3(oe->left);
       z3::expr right = eachExprToZ3(oe->right);
       if (left.is_bv()) {
         res = z3::to_expr(z3_ctx, Z3_mk_bvor(z3_ctx, left, right));
       } else {
-#if INT_ARITHMETIC
-        try {
-          if (left.is_int()) {
-            z3::expr tempLeft = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, left));
-            z3::expr tempRight = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, right));
-            z3::expr tempRes = z3::to_expr(z3_ctx, Z3_mk_bvor(z3_ctx, tempLeft, tempRight));
-            res = z3::to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, tempRes, true));
-          } else {
-            res = left || right;
+        if (intArithmetic) {
+          try {
+            if (left.is_int()) {
+              z3::expr tempLeft = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, left));
+              z3::expr tempRight = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, right));
+              z3::expr tempRes = z3::to_expr(z3_ctx, Z3_mk_bvor(z3_ctx, tempLeft, tempRight));
+              res = z3::to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, tempRes, true));
+            } else {
+              res = left || right;
+            }
+          } catch (z3::exception &ex) {
+            std::cerr << "Or exception : " << ex << std::endl;
           }
-        } catch (z3::exception &ex) {
-          std::cerr << "Or exception : " << ex << std::endl;
+        } else {
+          res = left || right;
         }
-#else
-        res = left || right;
-#endif
       }
       return res;
     }
@@ -537,8 +571,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::Xor: {
       XorExpr *xe = cast<XorExpr>(ele);
       if (xe->left.get()->isFloat || xe->right.get()->isFloat) {
-        xe->left.get()->isFloat = true;
-        xe->right.get()->isFloat = true;
+        markFloat(xe->left);
+        markFloat(xe->right);
       }
       z3::expr left = eachExprToZ3(xe->left);
       z3::expr right = eachExprToZ3(xe->right);
@@ -559,19 +593,19 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
       ShlExpr *se = cast<ShlExpr>(ele);
       z3::expr left = eachExprToZ3(se->left);
       z3::expr right = eachExprToZ3(se->right);
-#if INT_ARITHMETIC
-      try {
-        z3::expr tempLeft = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, left));
-        z3::expr tempRight = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, right));
+      if (intArithmetic) {
+        try {
+          z3::expr tempLeft = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, left));
+          z3::expr tempRight = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, right));
 
-        z3::expr tempRes = z3::to_expr(z3_ctx, Z3_mk_bvshl(z3_ctx, tempLeft, tempRight));
-        res = z3::to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, tempRes, true));
-      } catch (z3::exception &ex) {
-        std::cerr << "Shl exception : " << ex << std::endl;
+          z3::expr tempRes = z3::to_expr(z3_ctx, Z3_mk_bvshl(z3_ctx, tempLeft, tempRight));
+          res = z3::to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, tempRes, true));
+        } catch (z3::exception &ex) {
+          std::cerr << "Shl exception : " << ex << std::endl;
+        }
+      } else {
+        res = z3::to_expr(z3_ctx, Z3_mk_bvshl(z3_ctx, left, right));
       }
-#else
-      res = z3::to_expr(z3_ctx, Z3_mk_bvshl(z3_ctx, left, right));
-#endif
 
       return res;
     }
@@ -580,18 +614,18 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
       LShrExpr *lse = cast<LShrExpr>(ele);
       z3::expr left = eachExprToZ3(lse->left);
       z3::expr right = eachExprToZ3(lse->right);
-#if INT_ARITHMETIC
-      try {
-        z3::expr tempLeft = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, left));
-        z3::expr tempRight = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, right));
-        z3::expr tempRes = z3::to_expr(z3_ctx, Z3_mk_bvlshr(z3_ctx, tempLeft, tempRight));
-        res = z3::to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, tempRes, true));
-      } catch (z3::exception &ex) {
-        std::cerr << "LShr exception : " << ex << std::endl;
+      if (intArithmetic) {
+        try {
+          z3::expr tempLeft = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, left));
+          z3::expr tempRight = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, right));
+          z3::expr tempRes = z3::to_expr(z3_ctx, Z3_mk_bvlshr(z3_ctx, tempLeft, tempRight));
+          res = z3::to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, tempRes, true));
+        } catch (z3::exception &ex) {
+          std::cerr << "LShr exception : " << ex << std::endl;
+        }
+      } else {
+        res = z3::to_expr(z3_ctx, Z3_mk_bvlshr(z3_ctx, left, right));
       }
-#else
-      res = z3::to_expr(z3_ctx, Z3_mk_bvlshr(z3_ctx, left, right));
-#endif
 
       return res;
     }
@@ -600,18 +634,18 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
       AShrExpr *ase = cast<AShrExpr>(ele);
       z3::expr left = eachExprToZ3(ase->left);
       z3::expr right = eachExprToZ3(ase->right);
-#if INT_ARITHMETIC
-      try {
-        z3::expr tempLeft = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, left));
-        z3::expr tempRight = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, right));
-        z3::expr tempRes = z3::to_expr(z3_ctx, Z3_mk_bvashr(z3_ctx, tempLeft, tempRight));
-        res = z3::to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, tempRes, true));
-      } catch (z3::exception &ex) {
-        std::cerr << "AShr exception : " << ex << std::endl;
+      if (intArithmetic) {
+        try {
+          z3::expr tempLeft = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, left));
+          z3::expr tempRight = z3::to_expr(z3_ctx, Z3_mk_int2bv(z3_ctx, BIT_WIDTH, right));
+          z3::expr tempRes = z3::to_expr(z3_ctx, Z3_mk_bvashr(z3_ctx, tempLeft, tempRight));
+          res = z3::to_expr(z3_ctx, Z3_mk_bv2int(z3_ctx, tempRes, true));
+        } catch (z3::exception &ex) {
+          std::cerr << "AShr exception : " << ex << std::endl;
+        }
+      } else {
+        res = z3::to_expr(z3_ctx, Z3_mk_bvashr(z3_ctx, left, right));
       }
-#else
-      res = z3::to_expr(z3_ctx, Z3_mk_bvashr(z3_ctx, left, right));
-#endif
 
       return res;
     }
@@ -619,8 +653,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::Eq: {
       EqExpr *ee = cast<EqExpr>(ele);
       if (ee->left.get()->isFloat || ee->right.get()->isFloat) {
-        ee->left.get()->isFloat = true;
-        ee->right.get()->isFloat = true;
+        markFloat(ee->left);
+        markFloat(ee->right);
       }
       // std::cerr << "ele = " << ele << std::endl;
       z3::expr left = eachExprToZ3(ee->left);
@@ -634,8 +668,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
       // probably can float point value's comparison.
       UltExpr *ue = cast<UltExpr>(ele);
       if (ue->left.get()->isFloat || ue->right.get()->isFloat) {
-        ue->left.get()->isFloat = true;
-        ue->right.get()->isFloat = true;
+        markFloat(ue->left);
+        markFloat(ue->right);
       }
       z3::expr left = eachExprToZ3(ue->left);
       z3::expr right = eachExprToZ3(ue->right);
@@ -654,8 +688,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::Ule: {
       UleExpr *ue = cast<UleExpr>(ele);
       if (ue->left.get()->isFloat || ue->right.get()->isFloat) {
-        ue->left.get()->isFloat = true;
-        ue->right.get()->isFloat = true;
+        markFloat(ue->left);
+        markFloat(ue->right);
       }
       z3::expr left = eachExprToZ3(ue->left);
       z3::expr right = eachExprToZ3(ue->right);
@@ -673,8 +707,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::Slt: {
       SltExpr *se = cast<SltExpr>(ele);
       if (se->left.get()->isFloat || se->right.get()->isFloat) {
-        se->left.get()->isFloat = true;
-        se->right.get()->isFloat = true;
+        markFloat(se->left);
+        markFloat(se->right);
       }
       z3::expr left = eachExprToZ3(se->left);
       z3::expr right = eachExprToZ3(se->right);
@@ -692,8 +726,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::Sle: {
       SleExpr *se = cast<SleExpr>(ele);
       if (se->left.get()->isFloat || se->right.get()->isFloat) {
-        se->left.get()->isFloat = true;
-        se->right.get()->isFloat = true;
+        markFloat(se->left);
+        markFloat(se->right);
       }
       z3::expr left = eachExprToZ3(se->left);
       z3::expr right = eachExprToZ3(se->right);
@@ -712,8 +746,8 @@ z3::expr KQuery2Z3::eachExprToZ3(ref<Expr> &ele) {
     case Expr::Ne: {
       NeExpr *ne = cast<NeExpr>(ele);
       if (ne->left.get()->isFloat || ne->right.get()->isFloat) {
-        ne->left.get()->isFloat = true;
-        ne->right.get()->isFloat = true;
+        markFloat(ne->left);
+        markFloat(ne->right);
       }
       z3::expr left = eachExprToZ3(ne->left);
       z3::expr right = eachExprToZ3(ne->right);
@@ -23,11 +23,15 @@
 
 #include "../Core/Executor.h"
 #include "../Core/ExternalDispatcher.h"
+#include "klee/Encode/BoundedExplorer.h"
+#include "klee/Encode/DPOR.h"
 #include "klee/Encode/DTAM.h"
 #include "klee/Encode/Encode.h"
 #include "klee/Encode/ListenerService.h"
+#include "klee/Encode/ListenerTrace.h"
 #include "klee/Encode/PSOListener.h"
 #include "klee/Encode/Prefix.h"
+#include "klee/Encode/PrefixSearcher.h"
 #include "klee/Encode/SymbolicListener.h"
 #include "klee/Encode/TaintListener.h"
 #include "klee/Thread/StackType.h"
@@ -43,7 +47,17 @@ ListenerService::ListenerService(Executor *executor) {
   interpreterHandler = executor->getHandlerPtr();
   encoder = NULL;
   dtam = NULL;
+  explorer = NULL;
   cost = 0;
+  encodeOptions = EncodeOptions::fromCommandLine();
+  rdManager->encodeOptions = encodeOptions.toString();
+  explorationOptions = ExplorationOptions::fromCommandLine();
+  rdManager->explorationOptions = explorationOptions.toString();
+  if (explorationOptions.scheduleBound >= 0 && !explorationOptions.dpor && !explorationOptions.pctRuns) {
+    BoundedExplorer::BoundType type =
+        explorationOptions.delayBounding ? BoundedExplorer::Delay : BoundedExplorer::Preemption;
+    rdManager->setPrefixSearcher(new BoundedPrefixSearcher(BoundedExplorer::getTypeName(type)));
+  }
 }
 
 ListenerService::~ListenerService() {
@@ -58,6 +72,7 @@ ListenerService::~ListenerService() {
   delete encoder;
   delete rdManager;
   delete dtam;
+  delete explorer;
 }
 
 void ListenerService::pushListener(BitcodeListener *bitcodeListener) {
@@ -90,6 +105,14 @@ RuntimeDataManager *ListenerService::getRuntimeDataManager() {
   return rdManager;
 }
 
+const EncodeOptions &ListenerService::getEncodeOptions() {
+  return encodeOptions;
+}
+
+const ExplorationOptions &ListenerService::getExplorationOptions() {
+  return explorationOptions;
+}
+
 void ListenerService::beforeRunMethodAsMain(Executor *executor, ExecutionState &state, llvm::Function *f,
                                             MemoryObject *argvMO, std::vector<ref<Expr>> arguments, int argc,
                                             char **argv, char **envp) {
@@ -100,67 +123,74 @@ void ListenerService::beforeRunMethodAsMain(Executor *executor, ExecutionState &
   for (envc = 0; envp[envc]; ++envc)
     ;
 
+  BitcodeListener *initialized = NULL;
   for (auto bit : bitcodeListeners) {
     state.currentStack = bit->stack[state.currentThread->threadId];
     state.currentStack->pushFrame(0, executor->kmodule->functionMap[f]);
 
     for (unsigned i = 0, e = f->arg_size(); i != e; ++i)
       executor->bindArgument(executor->kmodule->functionMap[f], i, state, arguments[i]);
-    if (argvMO) {
-      const ObjectState *argvOSCurrent = state.currentThread->addressSpace->findObject(argvMO);
-      ObjectState *argvOS = executor->bindObjectInState(state, argvMO, false);
-      for (int i = 0; i < argc + 1 + envc + 1 + 1; i++) {
-        if (i == argc || i >= argc + 1 + envc) {
-          // Write NULL pointer
-          argvOS->write(i * NumPtrBytes, Expr::createPointer(0));
-        } else {
-          char *s = i < argc ? argv[i] : envp[i - (argc + 1)];
-          int j, len = strlen(s);
-          ref<Expr> argAddr = argvOSCurrent->read(i * NumPtrBytes, Context::get().getPointerWidth());
-          ObjectPair op;
-          bool success = executor->getMemoryObject(op, state, state.currentThread->addressSpace, argAddr);
-          if (success) {
-            const MemoryObject *arg = op.first;
-            ObjectState *os = executor->bindObjectInState(state, arg, false);
-            for (j = 0; j < len + 1; j++) {
-              os->write8(j, s[j]);
+    if (initialized) {
+      // the listeners start from the same memory, it is only copied when a listener writes to it
+      bit->addressSpace.shareObjects(initialized->addressSpace);
+    } else {
+      if (argvMO) {
+        const ObjectState *argvOSCurrent = state.currentThread->addressSpace->findObject(argvMO);
+        ObjectState *argvOS = executor->bindObjectInState(state, argvMO, false);
+        for (int i = 0; i < argc + 1 + envc + 1 + 1; i++) {
+          if (i == argc || i >= argc + 1 + envc) {
+            // Write NULL pointer
+            argvOS->write(i * NumPtrBytes, Expr::createPointer(0));
+          } else {
+            char *s = i < argc ? argv[i] : envp[i - (argc + 1)];
+            int j, len = strlen(s);
+            ref<Expr> argAddr = argvOSCurrent->read(i * NumPtrBytes, Context::get().getPointerWidth());
+            ObjectPair op;
+            bool success = executor->getMemoryObject(op, state, state.currentThread->addressSpace, argAddr);
+            if (success) {
+              const MemoryObject *arg = op.first;
+              ObjectState *os = executor->bindObjectInState(state, arg, false);
+              for (j = 0; j < len + 1; j++) {
+                os->write8(j, s[j]);
+              }
+              argvOS->write(i * NumPtrBytes, arg->getBaseExpr());
             }
-            argvOS->write(i * NumPtrBytes, arg->getBaseExpr());
           }
         }
       }
-    }
 
-    for (llvm::Module::const_global_iterator gitr = m->global_begin(), e = m->global_end(); gitr != e; ++gitr) {
-      if (gitr->isDeclaration()) {
-        Type *ty = gitr->getType()->getElementType();
-        uint64_t size = executor->kmodule->targetData->getTypeStoreSize(ty);
-        MemoryObject *mo = executor->globalObjects.find(&*gitr)->second;
-        ObjectState *os = executor->bindObjectInState(state, mo, false);
-        if (size) {
-          void *addr;
-          if (gitr->getName() == "__dso_handle") {
-            addr = &__dso_handle; // wtf ?
-          } else {
-            addr = executor->externalDispatcher->resolveSymbol(gitr->getName());
+      for (llvm::Module::const_global_iterator gitr = m->global_begin(), e = m->global_end(); gitr != e; ++gitr) {
+        if (gitr->isDeclaration()) {
+          Type *ty = gitr->getType()->getElementType();
+          uint64_t size = executor->kmodule->targetData->getTypeStoreSize(ty);
+          MemoryObject *mo = executor->globalObjects.find(&*gitr)->second;
+          ObjectState *os = executor->bindObjectInState(state, mo, false);
+          if (size) {
+            void *addr;
+            if (gitr->getName() == "__dso_handle") {
+              addr = &__dso_handle; // wtf ?
+            } else {
+              addr = executor->externalDispatcher->resolveSymbol(gitr->getName());
+            }
+            for (unsigned offset = 0; offset < mo->size; offset++)
+              os->write8(offset, ((unsigned char *)addr)[offset]);
           }
-          for (unsigned offset = 0; offset < mo->size; offset++)
-            os->write8(offset, ((unsigned char *)addr)[offset]);
+        } else {
+          MemoryObject *mo = executor->globalObjects.find(&*gitr)->second;
+          ObjectState *os = executor->bindObjectInState(state, mo, false);
+          if (!gitr->hasInitializer())
+            os->initializeToRandom();
         }
-      } else {
-        MemoryObject *mo = executor->globalObjects.find(&*gitr)->second;
-        ObjectState *os = executor->bindObjectInState(state, mo, false);
-        if (!gitr->hasInitializer())
-          os->initializeToRandom();
       }
-    }
-    for (llvm::Module::const_global_iterator it = m->global_begin(), e = m->global_end(); it != e; ++it) {
-      if (it->hasInitializer()) {
-        MemoryObject *mo = executor->globalObjects.find(&*it)->second;
-        const ObjectState *os = state.currentStack->addressSpace->findObject(mo);
-        ObjectState *wos = state.currentStack->addressSpace->getWriteable(mo, os);
-        executor->initializeGlobalObject(state, wos, it->getInitializer(), 0);
+      for (llvm::Module::const_global_iterator it = m->global_begin(), e = m->global_end(); it != e; ++it) {
+        if (it->hasInitializer()) {
+          MemoryObject *mo = executor->globalObjects.find(&*it)->second;
+          const ObjectState *os = state.currentStack->addressSpace->findObject(mo);
+          ObjectState *wos = state.currentStack->addressSpace->getWriteable(mo, os);
+          executor->initializeGlobalObject(state, wos, it->getInitializer(), 0);
+        }
       }
+      initialized = bit;
     }
 
     bit->beforeRunMethodAsMain(state);
@@ -170,13 +200,13 @@ void ListenerService::beforeRunMethodAsMain(Executor *executor, ExecutionState &
 }
 
 void ListenerService::beforeExecuteInstruction(Executor *executor, ExecutionState &state, KInstruction *ki) {
-#if DEBUG_RUNTIME_LISTENER
-  std::string instStr;
-  raw_string_ostream str(instStr);
-  ki->inst->print(str);
-  kleem_debug("Thread %d, %s", state.currentThread->threadId, instStr.c_str());
-#endif
+  if (ListenerTrace::isEnabled(ListenerTrace::Instructions)) {
+    ListenerTrace::traceInstruction(state.currentThread->threadId, ki);
+  }
   for (auto bit : bitcodeListeners) {
+    if (!isDispatched(bit, ki)) {
+      continue;
+    }
     state.currentStack = bit->stack[state.currentThread->threadId];
     bit->beforeExecuteInstruction(state, ki);
     state.currentStack = state.currentThread->stack;
@@ -368,9 +398,12 @@ void ListenerService::afterExecuteInstruction(Executor *executor, ExecutionState
                     stack->pushFrame(0, kthreadEntrance);
                     state.currentStack = stack;
                     executor->bindArgument(kthreadEntrance, 0, state, bit->arguments[3]);
-#if DEBUG_RUNTIME_LISTENER
-                    llvm::errs() << "bit->arguments[3] : " << bit->arguments[3] << "\n";
-#endif
+                    if (ListenerTrace::isTracingDetails(state.currentThread->threadId, ki)) {
+                      std::string message;
+                      llvm::raw_string_ostream os(message);
+                      os << "bit->arguments[3] : " << bit->arguments[3];
+                      ListenerTrace::traceDetails(state.currentThread->threadId, ki, os.str());
+                    }
                     state.currentStack = bit->stack[state.currentThread->threadId];
                   }
 
@@ -386,9 +419,12 @@ void ListenerService::afterExecuteInstruction(Executor *executor, ExecutionState
                     bool success = executor->getMemoryObject(op, state, state.currentThread->addressSpace, addr);
                     if (success) {
                       const MemoryObject *mo = op.first;
-#if DEBUG_RUNTIME_LISTENER
-                      llvm::errs() << "mo address : " << mo->address << " mo size : " << mo->size << "\n";
-#endif
+                      if (ListenerTrace::isTracingDetails(state.currentThread->threadId, ki)) {
+                        std::string message;
+                        llvm::raw_string_ostream os(message);
+                        os << "mo address : " << mo->address << " mo size : " << mo->size;
+                        ListenerTrace::traceDetails(state.currentThread->threadId, ki, os.str());
+                      }
                       ObjectState *os = executor->bindObjectInState(state, mo, isLocal);
                       os->initializeToRandom();
                       executor->bindLocal(ki, state, mo->getBaseExpr());
@@ -552,6 +588,9 @@ void ListenerService::afterExecuteInstruction(Executor *executor, ExecutionState
   }
 
   for (auto bit : bitcodeListeners) {
+    if (!isDispatched(bit, ki)) {
+      continue;
+    }
     state.currentStack = bit->stack[state.currentThread->threadId];
     bit->afterExecuteInstruction(state, ki);
     state.currentStack = state.currentThread->stack;
@@ -575,24 +614,47 @@ void ListenerService::startControl(Executor *executor) {
   pushListener(PSOlistener);
   BitcodeListener *Symboliclistener = new SymbolicListener(executor, rdManager);
   pushListener(Symboliclistener);
-#if DO_DSTAM
-  BitcodeListener *Taintlistener = new TaintListener(executor, rdManager);
-  pushListener(Taintlistener);
-#endif
+  if (encodeOptions.doDSTAM) {
+    BitcodeListener *Taintlistener = new TaintListener(executor, rdManager);
+    pushListener(Taintlistener);
+  }
 
   unsigned traceNum = executor->executionNum;
   if (traceNum == 1) {
     kleem_execution("%dth execution, initial run, id: Trace%d.", traceNum, traceNum);
-  } else {
+  } else if (executor->prefix) {
     kleem_execution("%dth execution, prefix-guided execution, prefix is %s.", traceNum,
                     executor->prefix->getName().c_str());
+  } else {
+    kleem_execution("%dth execution, unguided run, id: Trace%d.", traceNum, traceNum);
   }
   gettimeofday(&start, NULL);
 }
 
+void ListenerService::snapshot(std::vector<BitcodeListener *> &listeners, Trace *&trace) {
+  std::map<Event *, Event *> eventMap;
+  trace = rdManager->getCurrentTrace()->snapshot(eventMap);
+  for (auto bit : bitcodeListeners) {
+    listeners.push_back(bit->snapshot(eventMap));
+  }
+}
+
+void ListenerService::restore(Executor *executor, const std::vector<BitcodeListener *> &listeners, Trace *trace) {
+  deleteListeners();
+  std::map<Event *, Event *> eventMap;
+  Trace *resumed = trace->snapshot(eventMap);
+  resumed->Id = executor->executionNum;
+  rdManager->addResumedTrace(resumed);
+  for (auto bit : listeners) {
+    pushListener(bit->snapshot(eventMap));
+  }
+}
+
 void ListenerService::taintAnalysis() {
   gettimeofday(&start, NULL);
-  dtam = new DTAM(rdManager);
+  if (!dtam) {
+    dtam = new DTAM(rdManager);
+  }
   dtam->work();
   gettimeofday(&finish, NULL);
   cost = (double)(finish.tv_sec * 1000000UL + finish.tv_usec - start.tv_sec * 1000000UL - start.tv_usec) / 1000000UL;
@@ -646,8 +708,11 @@ void ListenerService::endControl(Executor *executor) {
   if (executor->execStatus != Executor::SUCCESS) {
     kleem_execution("Failed to execute, abandon this execution.");
     // executor->isFinished = true;
+    deleteListeners();
+    rdManager->releaseCurrentTrace();
     return;
   }
+  rdManager->addExploredTrace(rdManager->getCurrentTrace(), executor->prefix ? executor->prefix->getBound() : -1);
   if (!rdManager->isCurrentTraceUntested()) {
     rdManager->getCurrentTrace()->traceType = Trace::REDUNDANT;
     kleem_execution("Found a old path.");
@@ -673,32 +738,75 @@ void ListenerService::endControl(Executor *executor) {
     rdManager->runningCost += cost;
     rdManager->allDTAMSerialCost.push_back(cost);
 
+    if (explorationOptions.pctRuns && !encodeOptions.verifyAssertions && !encodeOptions.doDSTAM) {
+      // the PCT runs are independent, nothing needs the formulas of the trace
+      deleteListeners();
+      rdManager->releaseCurrentTrace();
+      return;
+    }
+
     gettimeofday(&start, NULL);
-    encoder = new Encode(rdManager, executor->getHandlerPtr());
+    encoder = new Encode(rdManager, executor->getHandlerPtr(), encodeOptions);
     encoder->constraintEncoding();
 #if PRINT_DETAILED_TRACE
     printCurrentTrace(false);
 #endif
-    encoder->flipIfBranches();
+    struct timeval encoded;
+    gettimeofday(&encoded, NULL);
+    if (explorationOptions.pctRuns) {
+      // the PCT runs are independent, no other schedule is derived from a trace
+    } else if (explorationOptions.dpor || explorationOptions.scheduleBound >= 0) {
+      if (!explorer) {
+        if (explorationOptions.dpor) {
+          explorer = new DPOR(rdManager);
+        } else {
+          explorer = new BoundedExplorer(rdManager,
+                                         explorationOptions.delayBounding ? BoundedExplorer::Delay
+                                                                          : BoundedExplorer::Preemption,
+                                         explorationOptions.scheduleBound);
+        }
+      }
+      explorer->work(executor->prefix);
+    } else {
+      encoder->flipIfBranches();
+    }
     gettimeofday(&finish, NULL);
     cost = (double)(finish.tv_sec * 1000000UL + finish.tv_usec - start.tv_sec * 1000000UL - start.tv_usec) / 1000000UL;
     rdManager->solvingCost += cost;
+    rdManager->encodeCost +=
+        (double)(encoded.tv_sec * 1000000UL + encoded.tv_usec - start.tv_sec * 1000000UL - start.tv_usec) / 1000000UL;
+    rdManager->flipCost +=
+        (double)(finish.tv_sec * 1000000UL + finish.tv_usec - encoded.tv_sec * 1000000UL - encoded.tv_usec) / 1000000UL;
+
+    if (encodeOptions.verifyAssertions) {
+      kleem_verifyassert("Verify the assertions on current trace.");
+      gettimeofday(&start, NULL);
+      encoder->verifyAssertion();
+      gettimeofday(&finish, NULL);
+      rdManager->verifyCost +=
+          (double)(finish.tv_sec * 1000000UL + finish.tv_usec - start.tv_sec * 1000000UL - start.tv_usec) / 1000000UL;
+      kleem_verifyassert("Assertion verification is over.");
+    }
 
-#if DO_ASSERT_VERIFICATION
-    kleem_verifyassert("Verify the assertions on current trace.");
-    encoder->verifyAssertion();
-    kleem_verifyassert("Assertion verification is over.");
-#endif
-
-#if DO_DSTAM
-    kleem_dstam("Carry on taint analysis on current trace.");
-    taintAnalysis();
-    kleem_dstam("Taint analysis is over.");
-#endif
+    if (encodeOptions.doDSTAM) {
+      kleem_dstam("Carry on taint analysis on current trace.");
+      taintAnalysis();
+      kleem_dstam("Taint analysis is over.");
+    }
+    // the destructor adds the formula counters of this trace to rdManager
+    delete encoder;
+    encoder = NULL;
   }
 
-  while(!bitcodeListeners.empty()) {
-    bitcodeListeners.pop_back();
+  deleteListeners();
+  // the trace lives on while the prefixes built from it are scheduled
+  rdManager->releaseCurrentTrace();
+}
+
+void ListenerService::deleteListeners() {
+  while (!bitcodeListeners.empty()) {
+    delete bitcodeListeners.back();
+    popListener();
   }
 }
 
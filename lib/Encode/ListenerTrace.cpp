@@ -0,0 +1,88 @@
+//===-- ListenerTrace.cpp ---------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Encode/ListenerTrace.h"
+#include "klee/Config/Version.h"
+#include "klee/Module/KInstruction.h"
+#include "klee/Support/ErrorHandling.h"
+#include "klee/Support/OptionCategories.h"
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instruction.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <string>
+
+using namespace llvm;
+
+namespace klee {
+ListenerTrace::Level ListenerTrace::level = ListenerTrace::Off;
+} // namespace klee
+
+namespace {
+cl::opt<klee::ListenerTrace::Level, true> TraceLevel(
+    "listener-trace", cl::desc("Debug tracing of the listeners (default=off)"),
+    cl::values(clEnumValN(klee::ListenerTrace::Off, "off", "no tracing"),
+               clEnumValN(klee::ListenerTrace::Instructions, "instructions", "every executed instruction"),
+               clEnumValN(klee::ListenerTrace::Details, "details",
+                          "the instructions and the values computed by the listeners")
+                   KLEE_LLVM_CL_VAL_END),
+    cl::location(klee::ListenerTrace::level), cl::cat(klee::VerificationCat));
+
+cl::list<unsigned> TraceThreads("listener-trace-thread", cl::CommaSeparated,
+                                cl::desc("Only trace the instructions of these threads"),
+                                cl::cat(klee::VerificationCat));
+
+cl::list<std::string> TraceFunctions("listener-trace-function", cl::CommaSeparated,
+                                     cl::desc("Only trace the instructions of these functions"),
+                                     cl::cat(klee::VerificationCat));
+
+cl::list<std::string> TraceOpcodes("listener-trace-opcode", cl::CommaSeparated,
+                                   cl::desc("Only trace the instructions with these opcodes, e.g. load,store,call"),
+                                   cl::cat(klee::VerificationCat));
+} // namespace
+
+namespace klee {
+
+bool ListenerTrace::matches(unsigned threadId, KInstruction *ki) {
+  if (!TraceThreads.empty() && std::find(TraceThreads.begin(), TraceThreads.end(), threadId) == TraceThreads.end()) {
+    return false;
+  }
+  if (!TraceFunctions.empty() &&
+      std::find(TraceFunctions.begin(), TraceFunctions.end(), ki->inst->getFunction()->getName().str()) ==
+          TraceFunctions.end()) {
+    return false;
+  }
+  if (!TraceOpcodes.empty() &&
+      std::find(TraceOpcodes.begin(), TraceOpcodes.end(), ki->inst->getOpcodeName()) == TraceOpcodes.end()) {
+    return false;
+  }
+  return true;
+}
+
+void ListenerTrace::traceInstruction(unsigned threadId, KInstruction *ki) {
+  if (!matches(threadId, ki)) {
+    return;
+  }
+  std::string instStr;
+  raw_string_ostream str(instStr);
+  ki->inst->print(str);
+  kleem_debug("Thread %d, %s", threadId, str.str().c_str());
+}
+
+void ListenerTrace::traceDetails(unsigned threadId, KInstruction *ki, const std::string &message) {
+  if (!isTracingDetails(threadId, ki)) {
+    return;
+  }
+  kleem_debug("Thread %d, %s", threadId, message.c_str());
+}
+
+} // namespace klee
@@ -10,6 +10,7 @@
 #include "klee/Encode/PSOListener.h"
 #include "../../lib/Core/Executor.h"
 #include "../../lib/Core/ExternalDispatcher.h"
+#include "klee/Encode/ListenerTrace.h"
 #include "klee/Encode/Trace.h"
 #include "klee/Encode/Transfer.h"
 #include "klee/Expr/Expr.h"
@@ -42,6 +43,15 @@ PSOListener::PSOListener(Executor *executor, RuntimeDataManager *rdManager)
   kind = PSOListenerKind;
 }
 
+PSOListener::PSOListener(const PSOListener &other, map<Event *, Event *> &eventMap)
+    : BitcodeListener(other), executor(other.executor), currentEvent(Trace::findCopy(other.currentEvent, eventMap)),
+      loadRecord(other.loadRecord), storeRecord(other.storeRecord),
+      usedGlobalVariableRecord(other.usedGlobalVariableRecord) {
+  for (auto bri : other.barrierRecord) {
+    barrierRecord[bri.first] = bri.second ? new BarrierInfo(*bri.second) : NULL;
+  }
+}
+
 PSOListener::~PSOListener() {
   for (auto bri : barrierRecord) {
     if (bri.second) {
@@ -350,12 +360,15 @@ void PSOListener::beforeExecuteInstruction(ExecutionState &state, KInstruction *
       } else {
         ref<Expr> address = executor->eval(ki, 0, state).value;
         ObjectPair op;
-#if DEBUG_RUNTIME_LISTENER
-        ref<Expr> addressCurrent = executor->evalCurrent(ki, 0, state).value;
-        llvm::errs() << "address : " << address << " address Current : " << addressCurrent << "\n";
-        bool successCurrent = executor->getMemoryObject(op, state, state.currentThread->addressSpace, addressCurrent);
-        llvm::errs() << "successCurrent : " << successCurrent << "\n";
-#endif
+        if (ListenerTrace::isTracingDetails(thread->threadId, ki)) {
+          ref<Expr> addressCurrent = executor->evalCurrent(ki, 0, state).value;
+          bool successCurrent = executor->getMemoryObject(op, state, state.currentThread->addressSpace, addressCurrent);
+          std::string message;
+          llvm::raw_string_ostream os(message);
+          os << "address : " << address << " address Current : " << addressCurrent
+             << " successCurrent : " << successCurrent;
+          ListenerTrace::traceDetails(thread->threadId, ki, os.str());
+        }
         ConstantExpr *realAddress = dyn_cast<ConstantExpr>(address);
         if (!realAddress) {
           assert(0 && " address is not const");
@@ -462,6 +475,9 @@ void PSOListener::beforeExecuteInstruction(ExecutionState &state, KInstruction *
     trace->insertEvent(*ei, thread->threadId);
   }
   trace->insertPath(item);
+  if (item->isGlobal && ListenerTrace::isTracingDetails(thread->threadId, ki)) {
+    ListenerTrace::traceDetails(thread->threadId, ki, "Create global variable full name: " + item->globalName);
+  }
   currentEvent = item;
 }
 
@@ -511,6 +527,10 @@ void PSOListener::afterRunMethodAsMain(ExecutionState &state) {}
 //消息相应函数，在前缀执行出错之后程序推出之前调用
 void PSOListener::executionFailed(ExecutionState &state, KInstruction *ki) {}
 
+BitcodeListener *PSOListener::snapshot(map<Event *, Event *> &eventMap) {
+  return new PSOListener(*this, eventMap);
+}
+
 //处理全局函数初始值
 void PSOListener::handleInitializer(Constant *initializer, MemoryObject *mo, uint64_t &startAddress) {
   Trace *trace = rdManager->getCurrentTrace();
@@ -702,6 +722,9 @@ void PSOListener::handleExternalFunction(ExecutionState &state, KInstruction *ki
         unsigned storeTime = getStoreTime(destaddress + i);
 
         name = createGlobalVarFullName(name, storeTime, true);
+        if (ListenerTrace::isTracingDetails(state.currentThread->threadId, ki)) {
+          ListenerTrace::traceDetails(state.currentThread->threadId, ki, "Create global variable full name: " + name);
+        }
 
         currentEvent->isGlobal = true;
       }
@@ -889,9 +912,6 @@ Function *PSOListener::getPointeredFunction(ExecutionState &state, KInstruction
     }
     ss << signal;
     ss << time;
-#if DEBUG_RUNTIME_LISTENER
-    kleem_debug("Create global variable full name: %s",  ss.str().c_str());
-#endif
     return ss.str();
   }
 
@@ -0,0 +1,314 @@
+//===-- ParallelExplorer.cpp ------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Encode/ParallelExplorer.h"
+#include "klee/Encode/PrefixTrie.h"
+#include "klee/Module/InstructionInfoTable.h"
+#include "klee/Module/KModule.h"
+#include "klee/Support/ErrorHandling.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <sstream>
+#include <sys/select.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace klee {
+
+WorkerChannel::WorkerChannel(int readFd, int writeFd, pid_t pid)
+    : readFd(readFd), writeFd(writeFd), pid(pid), busy(false), traceId(0), bound(-1) {}
+
+WorkerChannel::~WorkerChannel() {
+  close(readFd);
+  close(writeFd);
+}
+
+bool WorkerChannel::writeLine(const string &line) {
+  string data = line + "\n";
+  const char *p = data.c_str();
+  size_t left = data.size();
+  while (left > 0) {
+    ssize_t n = write(writeFd, p, left);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    p += n;
+    left -= n;
+  }
+  return true;
+}
+
+bool WorkerChannel::fillBuffer() {
+  char chunk[4096];
+  ssize_t n;
+  do {
+    n = read(readFd, chunk, sizeof(chunk));
+  } while (n < 0 && errno == EINTR);
+  if (n <= 0) {
+    return false;
+  }
+  buffer.append(chunk, n);
+  return true;
+}
+
+bool WorkerChannel::nextBufferedLine(string &line) {
+  size_t pos = buffer.find('\n');
+  if (pos == string::npos) {
+    return false;
+  }
+  line = buffer.substr(0, pos);
+  buffer.erase(0, pos + 1);
+  return true;
+}
+
+bool WorkerChannel::readLine(string &line) {
+  while (!nextBufferedLine(line)) {
+    if (!fillBuffer()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool WorkerChannel::isTraceUntested(Trace *trace) {
+  if (trace->abstract.empty()) {
+    trace->createAbstract();
+  }
+  stringstream ss;
+  ss << "TRACE " << trace->Id << " " << trace->abstract.size();
+  for (auto &abstract : trace->abstract) {
+    ss << " " << abstract;
+  }
+  // the path lets the coordinator index the trace in its prefix trie and searcher
+  ss << " " << trace->path.size();
+  for (auto event : trace->path) {
+    ss << " " << PrefixTrie::getStep(event, false);
+  }
+  string reply;
+  if (!writeLine(ss.str()) || !readLine(reply)) {
+    kleem_note("Lost the connection to the coordinator, treat Trace%d as a new path.", trace->Id);
+    return true;
+  }
+  return reply == "NEW";
+}
+
+ParallelExplorer::ParallelExplorer(RuntimeDataManager *rdManager, KModule *kmodule)
+    : rdManager(rdManager), nextTraceId(1) {
+  Prefix::indexInstructions(kmodule, instructions);
+}
+
+ParallelExplorer::~ParallelExplorer() {
+  for (auto worker : workers) {
+    delete worker;
+  }
+}
+
+WorkerChannel *ParallelExplorer::spawnWorkers(unsigned workerNum) {
+  // flush before forking, otherwise buffered output is written once per process
+  fflush(NULL);
+  for (unsigned i = 0; i < workerNum; i++) {
+    int toWorker[2], toCoordinator[2];
+    if (pipe(toWorker) || pipe(toCoordinator)) {
+      klee_error("Failed to create pipes for verification worker %u.", i);
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+      klee_error("Failed to fork verification worker %u.", i);
+    }
+    if (pid == 0) {
+      close(toWorker[1]);
+      close(toCoordinator[0]);
+      for (auto worker : workers) {
+        delete worker;
+      }
+      workers.clear();
+      return new WorkerChannel(toWorker[0], toCoordinator[1], getppid());
+    }
+    close(toWorker[0]);
+    close(toCoordinator[1]);
+    workers.push_back(new WorkerChannel(toCoordinator[0], toWorker[1], pid));
+  }
+  kleem_note("Spawned %u verification workers.", workerNum);
+  return NULL;
+}
+
+bool ParallelExplorer::dispatch(WorkerChannel *worker, Prefix *prefix) {
+  stringstream ss;
+  ss << "RUN " << nextTraceId;
+  if (prefix) {
+    ss << " ";
+    prefix->serialize(ss);
+  }
+  if (!worker->writeLine(ss.str())) {
+    return false;
+  }
+  worker->busy = true;
+  worker->traceId = nextTraceId++;
+  worker->bound = prefix ? prefix->getBound() : -1;
+  return true;
+}
+
+void ParallelExplorer::handleMessage(WorkerChannel *worker, const string &line) {
+  istringstream in(line);
+  string kind;
+  in >> kind;
+  if (kind == "TRACE") {
+    unsigned traceId, size;
+    in >> traceId >> size;
+    Trace *trace = rdManager->createNewTrace(traceId);
+    for (unsigned i = 0; i < size; i++) {
+      string abstract;
+      in >> abstract;
+      trace->abstract.push_back(abstract);
+    }
+    bool untested = rdManager->isCurrentTraceUntested();
+    trace->traceType = untested ? Trace::UNIQUE : Trace::REDUNDANT;
+    worker->writeLine(untested ? "NEW" : "OLD");
+    unsigned pathSize = 0;
+    in >> pathSize;
+    bool complete = true;
+    for (unsigned i = 0; i < pathSize && complete; i++) {
+      uint64_t step;
+      Event *event = NULL;
+      if (in >> step) {
+        event = PrefixTrie::createEvent(trace, step, instructions);
+      }
+      if (event) {
+        trace->insertPath(event);
+      } else {
+        complete = false;
+      }
+    }
+    if (complete) {
+      rdManager->addExploredTrace(trace, worker->bound);
+    } else {
+      kleem_note("Worker %d sent a malformed path of Trace%d, it is not indexed.", worker->pid, traceId);
+    }
+    // the coordinator builds no prefix from the trace
+    rdManager->releaseCurrentTrace();
+  } else if (kind == "PREFIX") {
+    Prefix *prefix = Prefix::deserialize(in, instructions);
+    if (prefix) {
+      rdManager->addToScheduleSet(prefix);
+    } else {
+      kleem_note("Worker %d sent a malformed prefix, drop it.", worker->pid);
+    }
+  } else if (kind == "DONE") {
+    worker->busy = false;
+  } else if (kind == "STATS") {
+    rdManager->mergeStatisticsRecord(in);
+  }
+}
+
+void ParallelExplorer::coordinate() {
+  // a worker which died while idle is noticed by the failed write, not by the signal
+  void (*sigpipeHandler)(int) = signal(SIGPIPE, SIG_IGN);
+  bool initialRun = true;
+  while (true) {
+    // hand out prefixes to idle workers, the first run is not guided by any prefix
+    for (auto wi = workers.begin(); wi != workers.end();) {
+      WorkerChannel *worker = *wi;
+      if (worker->busy) {
+        wi++;
+        continue;
+      }
+      Prefix *prefix = NULL;
+      if (!initialRun) {
+        prefix = rdManager->getNextPrefix();
+        if (!prefix)
+          break;
+      }
+      if (!dispatch(worker, prefix)) {
+        kleem_note("Failed to send %s to verification worker %d, the worker is dropped.",
+                   prefix ? prefix->getName().c_str() : "initial run", worker->pid);
+        // another worker runs the prefix
+        if (prefix) {
+          rdManager->returnPrefix(prefix);
+        }
+        waitpid(worker->pid, NULL, 0);
+        delete worker;
+        wi = workers.erase(wi);
+        continue;
+      }
+      initialRun = false;
+      if (prefix) {
+        rdManager->releasePrefix(prefix);
+      }
+      wi++;
+    }
+
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    int maxFd = -1;
+    for (auto worker : workers) {
+      if (worker->busy) {
+        FD_SET(worker->getReadFd(), &readSet);
+        maxFd = std::max(maxFd, worker->getReadFd());
+      }
+    }
+    if (maxFd < 0) {
+      if (workers.empty()) {
+        kleem_note("All verification workers exited, %lu prefixes are left unexplored.", rdManager->getPrefixNumber());
+      }
+      break;
+    }
+    if (select(maxFd + 1, &readSet, NULL, NULL, NULL) < 0) {
+      if (errno == EINTR)
+        continue;
+      klee_error("Failed to wait for verification workers.");
+    }
+
+    for (auto wi = workers.begin(); wi != workers.end();) {
+      WorkerChannel *worker = *wi;
+      if (!FD_ISSET(worker->getReadFd(), &readSet)) {
+        wi++;
+        continue;
+      }
+      if (!worker->fillBuffer()) {
+        kleem_note("Verification worker %d exited while running Trace%d.", worker->pid, worker->traceId);
+        waitpid(worker->pid, NULL, 0);
+        delete worker;
+        wi = workers.erase(wi);
+        continue;
+      }
+      string line;
+      while (worker->nextBufferedLine(line)) {
+        handleMessage(worker, line);
+      }
+      wi++;
+    }
+    if (workers.empty()) {
+      kleem_note("All verification workers exited, %lu prefixes are left unexplored.", rdManager->getPrefixNumber());
+      break;
+    }
+  }
+  shutdownWorkers();
+  signal(SIGPIPE, sigpipeHandler);
+}
+
+void ParallelExplorer::shutdownWorkers() {
+  for (auto worker : workers) {
+    worker->writeLine("QUIT");
+  }
+  for (auto worker : workers) {
+    string line;
+    while (worker->readLine(line)) {
+      handleMessage(worker, line);
+    }
+    waitpid(worker->pid, NULL, 0);
+  }
+}
+
+} // namespace klee
@@ -7,10 +7,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iterator>
 
 #include "klee/Encode/Prefix.h"
 #include "klee/Module/InstructionInfoTable.h"
+#include "klee/Module/KModule.h"
 #include <llvm/IR/Instruction.h>
 
 using namespace ::std;
@@ -19,7 +21,7 @@ using namespace ::llvm;
 namespace klee {
 
 Prefix::Prefix(vector<Event *> &eventList, std::map<Event *, uint64_t> &threadIdMap, std::string name)
-    : eventList(eventList), threadIdMap(threadIdMap), name(name) {
+    : eventList(eventList), threadIdMap(threadIdMap), name(name), bound(-1), trace(NULL) {
   position = this->eventList.begin();
 }
 
@@ -27,7 +29,11 @@ void Prefix::reuse() {
   position = this->eventList.begin();
 }
 
-Prefix::~Prefix() {}
+Prefix::~Prefix() {
+  for (auto event : ownedEvents) {
+    delete event;
+  }
+}
 
 vector<Event *> *Prefix::getEventList() {
   return &eventList;
@@ -39,6 +45,10 @@ void Prefix::increasePosition() {
   }
 }
 
+void Prefix::setPosition(unsigned index) {
+  position = eventList.begin() + std::min<size_t>(index, eventList.size());
+}
+
 bool Prefix::isFinished() {
   return position == eventList.end();
 }
@@ -103,4 +113,109 @@ std::string Prefix::getName() {
   return name;
 }
 
+vector<SleepingThread> &Prefix::getSleepSet() {
+  return sleepSet;
+}
+
+int Prefix::getBound() {
+  return bound;
+}
+
+void Prefix::setBound(int bound) {
+  this->bound = bound;
+}
+
+Trace *Prefix::getTrace() {
+  return trace;
+}
+
+void Prefix::setTrace(Trace *trace) {
+  this->trace = trace;
+}
+
+bool Prefix::ownsEvents() {
+  return !ownedEvents.empty();
+}
+
+void Prefix::serialize(ostream &out) {
+  out << name << " " << eventList.size();
+  for (auto event : eventList) {
+    map<Event *, uint64_t>::iterator ti = threadIdMap.find(event);
+    uint64_t childThreadId = ti != threadIdMap.end() ? ti->second : 0;
+    out << " " << event->threadId << " " << event->eventId << " " << event->eventName << " " << event->inst->info->id
+        << " " << event->isConditionInst << " " << event->brCondition << " " << childThreadId;
+  }
+  out << " " << sleepSet.size();
+  for (auto &sleeping : sleepSet) {
+    // the object is empty if the thread has no access pending, its length keeps the record readable
+    out << " " << sleeping.threadId << " " << sleeping.isWrite << " " << sleeping.joined << " "
+        << sleeping.object.size() << " " << sleeping.object;
+  }
+  out << " " << bound;
+}
+
+Prefix *Prefix::deserialize(istream &in, const vector<KInstruction *> &instructions) {
+  string name;
+  unsigned size = 0;
+  if (!(in >> name >> size)) {
+    return NULL;
+  }
+  vector<Event *> events;
+  map<Event *, uint64_t> threadIdMap;
+  events.reserve(size);
+  for (unsigned i = 0; i < size; i++) {
+    unsigned threadId, eventId, instId;
+    bool isConditionInst, brCondition;
+    uint64_t childThreadId;
+    string eventName;
+    in >> threadId >> eventId >> eventName >> instId >> isConditionInst >> brCondition >> childThreadId;
+    if (!in || instId >= instructions.size() || !instructions[instId]) {
+      for (auto event : events) {
+        delete event;
+      }
+      return NULL;
+    }
+    Event *event = new Event(threadId, eventId, eventName, instructions[instId], "", "", Event::NORMAL);
+    event->isConditionInst = isConditionInst;
+    event->brCondition = brCondition;
+    if (childThreadId) {
+      threadIdMap[event] = childThreadId;
+    }
+    events.push_back(event);
+  }
+  Prefix *prefix = new Prefix(events, threadIdMap, name);
+  prefix->ownedEvents = events;
+  unsigned sleeping = 0;
+  in >> sleeping;
+  prefix->sleepSet.resize(sleeping);
+  for (auto &thread : prefix->sleepSet) {
+    unsigned length = 0;
+    // skip the separator, the object may be empty
+    if (!(in >> thread.threadId >> thread.isWrite >> thread.joined >> length) || in.get() != ' ') {
+      in.setstate(ios::failbit);
+      break;
+    }
+    thread.object.resize(length);
+    in.read(&thread.object[0], length);
+  }
+  in >> prefix->bound;
+  if (!in) {
+    delete prefix;
+    return NULL;
+  }
+  return prefix;
+}
+
+void Prefix::indexInstructions(KModule *kmodule, vector<KInstruction *> &instructions) {
+  for (auto &kf : kmodule->functions) {
+    for (unsigned i = 0; i < kf->numInstructions; i++) {
+      KInstruction *ki = kf->instructions[i];
+      if (instructions.size() <= ki->info->id) {
+        instructions.resize(ki->info->id + 1, NULL);
+      }
+      instructions[ki->info->id] = ki;
+    }
+  }
+}
+
 } /* namespace klee */
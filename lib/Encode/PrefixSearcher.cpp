@@ -0,0 +1,245 @@
+//===-- PrefixSearcher.cpp --------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Encode/PrefixSearcher.h"
+#include "klee/Module/InstructionInfoTable.h"
+#include "klee/Support/ErrorHandling.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+namespace klee {
+
+PrefixSearcher *PrefixSearcher::create(SearchType type, unsigned seed) {
+  switch (type) {
+    case Shortest:
+      return new WeightedPrefixSearcher(WeightedPrefixSearcher::EventNum);
+    case FewestContextSwitches:
+      return new WeightedPrefixSearcher(WeightedPrefixSearcher::ContextSwitchNum);
+    case UncoveredBranch:
+      return new UncoveredBranchPrefixSearcher();
+    case Random:
+      return new RandomPrefixSearcher(seed);
+    case FIFO:
+    default:
+      return new FIFOPrefixSearcher();
+  }
+}
+
+///
+
+Prefix *FIFOPrefixSearcher::selectPrefix() {
+  if (prefixes.empty()) {
+    return NULL;
+  }
+  Prefix *prefix = prefixes.front();
+  prefixes.pop_front();
+  return prefix;
+}
+
+void FIFOPrefixSearcher::addPrefix(Prefix *prefix) {
+  prefixes.push_back(prefix);
+}
+
+void FIFOPrefixSearcher::getPrefixes(vector<Prefix *> &result) {
+  result.insert(result.end(), prefixes.begin(), prefixes.end());
+}
+
+///
+
+WeightedPrefixSearcher::WeightedPrefixSearcher(WeightType type) : type(type), nextSequence(0) {}
+
+uint64_t WeightedPrefixSearcher::getWeight(Prefix *prefix) {
+  vector<Event *> &events = *prefix->getEventList();
+  if (type == EventNum) {
+    return events.size();
+  }
+  uint64_t contextSwitches = 0;
+  for (unsigned i = 1; i < events.size(); i++) {
+    if (events[i]->threadId != events[i - 1]->threadId) {
+      contextSwitches++;
+    }
+  }
+  return contextSwitches;
+}
+
+Prefix *WeightedPrefixSearcher::selectPrefix() {
+  if (heap.empty()) {
+    return NULL;
+  }
+  pop_heap(heap.begin(), heap.end(), greater<HeapEntry>());
+  Prefix *prefix = heap.back().second;
+  heap.pop_back();
+  return prefix;
+}
+
+void WeightedPrefixSearcher::addPrefix(Prefix *prefix) {
+  heap.push_back(make_pair(make_pair(getWeight(prefix), nextSequence++), prefix));
+  push_heap(heap.begin(), heap.end(), greater<HeapEntry>());
+}
+
+void WeightedPrefixSearcher::getPrefixes(vector<Prefix *> &result) {
+  for (auto &entry : heap) {
+    result.push_back(entry.second);
+  }
+}
+
+void WeightedPrefixSearcher::printName(llvm::raw_ostream &os) {
+  os << "WeightedPrefixSearcher::";
+  switch (type) {
+    case EventNum:
+      os << "EventNum\n";
+      return;
+    case ContextSwitchNum:
+      os << "ContextSwitchNum\n";
+      return;
+  }
+}
+
+///
+
+uint64_t UncoveredBranchPrefixSearcher::getFlippedBranch(Prefix *prefix) {
+  if (prefix->getEventList()->empty()) {
+    return ~0ULL;
+  }
+  Event *event = prefix->getEventList()->back();
+  return (uint64_t)event->inst->info->id << 1 | !event->brCondition;
+}
+
+Prefix *UncoveredBranchPrefixSearcher::selectPrefix() {
+  if (prefixes.empty()) {
+    return NULL;
+  }
+  list<Prefix *>::iterator selected = prefixes.begin();
+  for (list<Prefix *>::iterator pi = prefixes.begin(), pe = prefixes.end(); pi != pe; pi++) {
+    if (!coveredBranches.count(getFlippedBranch(*pi))) {
+      selected = pi;
+      break;
+    }
+  }
+  Prefix *prefix = *selected;
+  prefixes.erase(selected);
+  // the other prefixes flipping the same branch are not preferred any more once this one is on its way
+  coveredBranches.insert(getFlippedBranch(prefix));
+  return prefix;
+}
+
+void UncoveredBranchPrefixSearcher::addPrefix(Prefix *prefix) {
+  if (coveredBranches.count(getFlippedBranch(prefix))) {
+    prefixes.push_back(prefix);
+  } else {
+    // keep the uncovered prefixes in front, so they are found without walking the covered ones
+    prefixes.push_front(prefix);
+  }
+}
+
+void UncoveredBranchPrefixSearcher::update(Trace *trace) {
+  for (auto event : trace->path) {
+    if (event->isConditionInst) {
+      coveredBranches.insert((uint64_t)event->inst->info->id << 1 | event->brCondition);
+    }
+  }
+}
+
+void UncoveredBranchPrefixSearcher::getPrefixes(vector<Prefix *> &result) {
+  result.insert(result.end(), prefixes.begin(), prefixes.end());
+}
+
+///
+
+RandomPrefixSearcher::RandomPrefixSearcher(unsigned seed) : theRNG(seed), seed(seed) {}
+
+Prefix *RandomPrefixSearcher::selectPrefix() {
+  if (prefixes.empty()) {
+    return NULL;
+  }
+  unsigned index = theRNG.getInt32() % prefixes.size();
+  Prefix *prefix = prefixes[index];
+  prefixes[index] = prefixes.back();
+  prefixes.pop_back();
+  return prefix;
+}
+
+void RandomPrefixSearcher::addPrefix(Prefix *prefix) {
+  prefixes.push_back(prefix);
+}
+
+void RandomPrefixSearcher::getPrefixes(vector<Prefix *> &result) {
+  result.insert(result.end(), prefixes.begin(), prefixes.end());
+}
+
+void RandomPrefixSearcher::printName(llvm::raw_ostream &os) {
+  os << "RandomPrefixSearcher (seed " << seed << ")\n";
+}
+
+///
+
+BoundedPrefixSearcher::BoundedPrefixSearcher(const string &boundName)
+    : nextSequence(0), boundName(boundName), currentBound(0), executions(1), reported(false) {}
+
+void BoundedPrefixSearcher::reportBound() {
+  kleem_note("Bound %u (%s): %u executions, %lu branch directions covered.", currentBound, boundName.c_str(),
+             executions, (unsigned long)coveredBranches.size());
+  reported = true;
+}
+
+Prefix *BoundedPrefixSearcher::selectPrefix() {
+  if (heap.empty()) {
+    if (!reported) {
+      reportBound();
+    }
+    return NULL;
+  }
+  pop_heap(heap.begin(), heap.end(), greater<HeapEntry>());
+  Prefix *prefix = heap.back().second;
+  heap.pop_back();
+  return prefix;
+}
+
+void BoundedPrefixSearcher::run(Prefix *prefix) {
+  // the prefixes which are not scheduled by the bounded exploration, like the replay of a failed assertion, go first
+  unsigned bound = prefix->getBound() > 0 ? prefix->getBound() : 0;
+  if (bound > currentBound) {
+    if (!reported) {
+      reportBound();
+    }
+    currentBound = bound;
+    executions = 0;
+  }
+  executions++;
+  reported = false;
+}
+
+void BoundedPrefixSearcher::addPrefix(Prefix *prefix) {
+  uint64_t bound = prefix->getBound() > 0 ? prefix->getBound() : 0;
+  heap.push_back(make_pair(make_pair(bound, nextSequence++), prefix));
+  push_heap(heap.begin(), heap.end(), greater<HeapEntry>());
+}
+
+void BoundedPrefixSearcher::update(Trace *trace) {
+  for (auto event : trace->path) {
+    if (event->isConditionInst) {
+      coveredBranches.insert((uint64_t)event->inst->info->id << 1 | event->brCondition);
+    }
+  }
+}
+
+void BoundedPrefixSearcher::getPrefixes(vector<Prefix *> &result) {
+  for (auto &entry : heap) {
+    result.push_back(entry.second);
+  }
+}
+
+void BoundedPrefixSearcher::printName(llvm::raw_ostream &os) {
+  os << "BoundedPrefixSearcher::" << boundName << "\n";
+}
+
+} // namespace klee
@@ -0,0 +1,146 @@
+//===-- PrefixTrie.cpp ------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Encode/PrefixTrie.h"
+#include "klee/Module/InstructionInfoTable.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace klee {
+
+PrefixTrie::Node *PrefixTrie::Node::getChild(uint64_t step) {
+  // almost every node has a single child, a linear search is cheaper than a map
+  for (auto &child : children) {
+    if (child.first == step) {
+      return child.second;
+    }
+  }
+  return NULL;
+}
+
+PrefixTrie::Node *PrefixTrie::Node::getOrCreateChild(uint64_t step) {
+  Node *child = getChild(step);
+  if (!child) {
+    child = new Node();
+    children.push_back(make_pair(step, child));
+  }
+  return child;
+}
+
+PrefixTrie::~PrefixTrie() {
+  // the trie is as deep as the longest trace, delete it without recursion
+  vector<Node *> worklist;
+  for (auto &child : root.children) {
+    worklist.push_back(child.second);
+  }
+  while (!worklist.empty()) {
+    Node *node = worklist.back();
+    worklist.pop_back();
+    for (auto &child : node->children) {
+      worklist.push_back(child.second);
+    }
+    delete node;
+  }
+}
+
+uint64_t PrefixTrie::getStep(Event *event, bool flip) {
+  uint64_t branch = 0;
+  if (event->isConditionInst) {
+    branch = 2 | (event->brCondition != flip);
+  }
+  return (uint64_t)event->threadId << 34 | (uint64_t)event->inst->info->id << 2 | branch;
+}
+
+Event *PrefixTrie::createEvent(Trace *trace, uint64_t step, const vector<KInstruction *> &instructions) {
+  uint64_t instId = step >> 2 & 0xffffffffULL;
+  if (instId >= instructions.size() || !instructions[instId]) {
+    return NULL;
+  }
+  Event *event = trace->createEvent(step >> 34, instructions[instId], Event::NORMAL);
+  event->isConditionInst = step & 2;
+  event->brCondition = step & 1;
+  return event;
+}
+
+unsigned PrefixTrie::getBound(Prefix *prefix) {
+  return prefix->getBound() > 0 ? prefix->getBound() : 0;
+}
+
+PrefixTrie::Node *PrefixTrie::find(Prefix *prefix) {
+  vector<Event *> &events = *prefix->getEventList();
+  Node *node = &root;
+  for (unsigned i = 0; i < events.size() && node; i++) {
+    node = node->getChild(getStep(events[i], i + 1 == events.size()));
+  }
+  return node;
+}
+
+bool PrefixTrie::addPrefix(Prefix *prefix) {
+  vector<Event *> &events = *prefix->getEventList();
+  Node *node = &root;
+  for (unsigned i = 0; i < events.size(); i++) {
+    node = node->getOrCreateChild(getStep(events[i], i + 1 == events.size()));
+  }
+  unsigned bound = getBound(prefix);
+  if (node->scheduledBound <= bound || node->exploredBound <= bound) {
+    if (node->queued && node->scheduledBound <= bound) {
+      // a thread may only sleep where each prefix of the same path lets it sleep
+      vector<SleepingThread> &sleepSet = node->queued->getSleepSet();
+      vector<SleepingThread> &other = prefix->getSleepSet();
+      auto isSleeping = [&other](const SleepingThread &thread) {
+        for (auto &sleeping : other) {
+          if (sleeping.threadId == thread.threadId) {
+            return true;
+          }
+        }
+        return false;
+      };
+      sleepSet.erase(remove_if(sleepSet.begin(), sleepSet.end(),
+                               [&isSleeping](const SleepingThread &thread) { return !isSleeping(thread); }),
+                     sleepSet.end());
+    }
+    return false;
+  }
+  // a duplicate waiting with a higher bound is dropped once it is taken
+  node->scheduledBound = bound;
+  node->queued = prefix;
+  return true;
+}
+
+bool PrefixTrie::takePrefix(Prefix *prefix) {
+  Node *node = find(prefix);
+  if (!node) {
+    return true;
+  }
+  if (node->queued == prefix) {
+    node->queued = NULL;
+  }
+  unsigned bound = getBound(prefix);
+  return node->exploredBound > bound && node->scheduledBound >= bound;
+}
+
+void PrefixTrie::returnPrefix(Prefix *prefix) {
+  Node *node = find(prefix);
+  if (node && !node->queued && node->scheduledBound == getBound(prefix)) {
+    node->queued = prefix;
+  }
+}
+
+void PrefixTrie::addTrace(Trace *trace, int bound) {
+  unsigned traceBound = bound > 0 ? bound : 0;
+  Node *node = &root;
+  for (auto event : trace->path) {
+    node = node->getOrCreateChild(getStep(event, false));
+    node->exploredBound = std::min(node->exploredBound, traceBound);
+  }
+}
+
+} // namespace klee
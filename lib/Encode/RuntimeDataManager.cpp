@@ -8,11 +8,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "klee/Encode/RuntimeDataManager.h"
+#include "klee/Encode/ParallelExplorer.h"
 #include "klee/Support/ErrorHandling.h"
 
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/raw_ostream.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iterator>
 #include <map>
@@ -24,7 +26,8 @@ using namespace llvm;
 
 namespace klee {
 
-RuntimeDataManager::RuntimeDataManager() : currentTrace(NULL) {
+RuntimeDataManager::RuntimeDataManager()
+    : currentTrace(NULL), traceNum(0), testedTraceNum(0), scheduleSet(new FIFOPrefixSearcher()), coordinator(NULL) {
   traceList.reserve(20);
 
   allFormulaNum = 0;
@@ -34,8 +37,17 @@ RuntimeDataManager::RuntimeDataManager() : currentTrace(NULL) {
   satBranch = 0;
   unSatBranchBySolve = 0;
   unSatBranchByPreSolve = 0;
+  constantBranch = 0;
+  redundantPrefix = 0;
+  prunedReadFrom = 0;
+  backtrackPoints = 0;
+  sleepSetPruned = 0;
+  boundPruned = 0;
 
   solvingCost = 0.0;
+  encodeCost = 0.0;
+  flipCost = 0.0;
+  verifyCost = 0.0;
   runningCost = 0.0;
   satCost = 0.0;
   unSatCost = 0.0;
@@ -45,34 +57,41 @@ RuntimeDataManager::RuntimeDataManager() : currentTrace(NULL) {
   DTAMParallelCost = 0;
   DTAMhybridCost = 0;
   PTSCost = 0;
-
 }
 
 RuntimeDataManager::~RuntimeDataManager() {
+  clearAllPrefix();
   for (auto trace : traceList) {
     delete trace;
   }
-  }
+  delete scheduleSet;
+}
 
 std::string RuntimeDataManager::getResultString() {
   stringstream ss;
   ss << "AllFormulaNum:" << allFormulaNum << "\n";
   ss << "SovingTimes:" << solvingTimes << "\n";
-  ss << "TotalNewPath:" << testedTraceList.size() << "\n";
-  ss << "TotalOldPath:" << traceList.size() - testedTraceList.size() << "\n";
-  ss << "TotalPath:" << traceList.size() << "\n";
-  if (testedTraceList.size()) {
-    ss << "allGlobal:" << allGlobal * 1.0 / testedTraceList.size() << "\n";
-    ss << "brGlobal:" << brGlobal * 1.0 / testedTraceList.size() << "\n";
+  ss << "RedundantPrefix:" << redundantPrefix << "\n";
+  ss << "PrunedReadFrom:" << prunedReadFrom << "\n";
+  ss << "BacktrackPoints:" << backtrackPoints << "\n";
+  ss << "SleepSetPruned:" << sleepSetPruned << "\n";
+  ss << "BoundPruned:" << boundPruned << "\n";
+  ss << "ConstantBranch:" << constantBranch << "\n";
+  ss << "TotalNewPath:" << testedTraceNum << "\n";
+  ss << "TotalOldPath:" << traceNum - testedTraceNum << "\n";
+  ss << "TotalPath:" << traceNum << "\n";
+  if (testedTraceNum) {
+    ss << "allGlobal:" << allGlobal * 1.0 / testedTraceNum << "\n";
+    ss << "brGlobal:" << brGlobal * 1.0 / testedTraceNum << "\n";
   } else {
     ss << "allGlobal:0"
        << "\n";
     ss << "brGlobal:0"
        << "\n";
   }
-  if (testedTraceList.size()) {
-    ss << "AllBranch:" << (satBranch + unSatBranchBySolve) * 1.0 / testedTraceList.size() << "\n";
-    ss << "satBranch:" << satBranch * 1.0 / testedTraceList.size() << "\n";
+  if (testedTraceNum) {
+    ss << "AllBranch:" << (satBranch + unSatBranchBySolve) * 1.0 / testedTraceNum << "\n";
+    ss << "satBranch:" << satBranch * 1.0 / testedTraceNum << "\n";
   } else {
     ss << "AllBranch:0"
        << "\n";
@@ -85,8 +104,8 @@ std::string RuntimeDataManager::getResultString() {
     ss << "satCost:0"
        << "\n";
   }
-  if (testedTraceList.size()) {
-    ss << "unSatBranchBySolve:" << unSatBranchBySolve * 1.0 / testedTraceList.size() << "\n";
+  if (testedTraceNum) {
+    ss << "unSatBranchBySolve:" << unSatBranchBySolve * 1.0 / testedTraceNum << "\n";
   } else {
     ss << "unSatBranchBySolve:0"
        << "\n";
@@ -97,14 +116,19 @@ std::string RuntimeDataManager::getResultString() {
     ss << "unSatCost:0"
        << "\n";
   }
-  if (testedTraceList.size()) {
-    ss << "unSatBranchByPreSolve:" << unSatBranchByPreSolve * 1.0 / testedTraceList.size() << "\n";
+  if (testedTraceNum) {
+    ss << "unSatBranchByPreSolve:" << unSatBranchByPreSolve * 1.0 / testedTraceNum << "\n";
   } else {
     ss << "unSatBranchByPreSolve:0"
        << "\n";
   }
 
   ss << "SolvingCost:" << solvingCost << "\n";
+  ss << "EncodeOptions:" << encodeOptions << "\n";
+  ss << "ExplorationOptions:" << explorationOptions << "\n";
+  ss << "EncodeCost:" << encodeCost << "\n";
+  ss << "FlipCost:" << flipCost << "\n";
+  ss << "VerifyCost:" << verifyCost << "\n";
   ss << "RunningCost:" << runningCost << "\n";
 
   ss << "DTAMCost:" << DTAMCost << "\n";
@@ -153,57 +177,179 @@ std::string RuntimeDataManager::getResultString() {
 }
 
 unsigned RuntimeDataManager::getTestedPathsNumber() {
-  return testedTraceList.size();
+  return testedTraceNum;
 }
 
 Trace *RuntimeDataManager::createNewTrace(unsigned traceId) {
   currentTrace = new Trace();
   currentTrace->Id = traceId;
   traceList.push_back(currentTrace);
+  traceNum++;
   return currentTrace;
 }
 
+void RuntimeDataManager::addResumedTrace(Trace *trace) {
+  currentTrace = trace;
+  traceList.push_back(trace);
+  traceNum++;
+}
+
 Trace *RuntimeDataManager::getCurrentTrace() {
   return currentTrace;
 }
 
-void RuntimeDataManager::addToScheduleSet(Prefix *prefix) {
-  scheduleSet.push_back(prefix);
+void RuntimeDataManager::releaseCurrentTrace() {
+  if (!currentTrace) {
+    return;
+  }
+  Trace *trace = currentTrace;
+  currentTrace = NULL;
+  if (!trace->prefixNum) {
+    releaseTrace(trace);
+  }
+}
+
+void RuntimeDataManager::releaseTrace(Trace *trace) {
+  traceList.erase(find(traceList.begin(), traceList.end(), trace));
+  delete trace;
+}
+
+void RuntimeDataManager::releasePrefix(Prefix *prefix) {
+  Trace *trace = prefix->getTrace();
+  delete prefix;
+  if (trace && !--trace->prefixNum && trace != currentTrace) {
+    releaseTrace(trace);
+  }
+}
+
+void RuntimeDataManager::returnPrefix(Prefix *prefix) {
+  // addToScheduleSet would drop it as a duplicate of itself
+  prefixTrie.returnPrefix(prefix);
+  scheduleSet->addPrefix(prefix);
+}
+
+bool RuntimeDataManager::addToScheduleSet(Prefix *prefix) {
+  if (!prefixTrie.addPrefix(prefix)) {
+    kleem_exploration("Drop %s, the same path has been scheduled or explored.", prefix->getName().c_str());
+    redundantPrefix++;
+    delete prefix;
+    return false;
+  }
+  // the prefixes are built from the events of the current trace, unless they are received from a worker
+  if (currentTrace && !prefix->ownsEvents()) {
+    prefix->setTrace(currentTrace);
+    currentTrace->prefixNum++;
+  }
+  scheduleSet->addPrefix(prefix);
+  return true;
+}
+
+void RuntimeDataManager::addExploredTrace(Trace *trace, int bound) {
+  prefixTrie.addTrace(trace, bound);
+  scheduleSet->update(trace);
+}
+
+void RuntimeDataManager::setPrefixSearcher(PrefixSearcher *searcher) {
+  while (Prefix *prefix = scheduleSet->selectPrefix()) {
+    searcher->addPrefix(prefix);
+  }
+  delete scheduleSet;
+  scheduleSet = searcher;
 }
 
 Prefix *RuntimeDataManager::getNextPrefix() {
-  if (scheduleSet.empty()) {
-    return NULL;
-  } else {
-    Prefix *prefix = scheduleSet.front();
-    scheduleSet.pop_front();
-    return prefix;
+  while (Prefix *prefix = scheduleSet->selectPrefix()) {
+    // a trace executed after the prefix was scheduled may have taken its path already
+    if (prefixTrie.takePrefix(prefix)) {
+      scheduleSet->run(prefix);
+      return prefix;
+    }
+    kleem_exploration("Drop %s, the path has been explored.", prefix->getName().c_str());
+    redundantPrefix++;
+    releasePrefix(prefix);
   }
+  return NULL;
 }
 
 void RuntimeDataManager::clearAllPrefix() {
-  scheduleSet.clear();
+  while (Prefix *prefix = scheduleSet->selectPrefix()) {
+    prefixTrie.takePrefix(prefix);
+    releasePrefix(prefix);
+  }
 }
 
 bool RuntimeDataManager::isCurrentTraceUntested() {
   bool result = true;
-  for (set<Trace *>::iterator ti = testedTraceList.begin(), te = testedTraceList.end(); ti != te; ti++) {
-    if (currentTrace->isEqual(*ti)) {
-      result = false;
-      break;
-    }
+  if (coordinator) {
+    result = coordinator->isTraceUntested(currentTrace);
+  } else {
+    result = testedFingerprints.insert(currentTrace->getFingerprint()).second;
   }
   currentTrace->isUntested = result;
   if (result) {
-    testedTraceList.insert(currentTrace);
+    testedTraceNum++;
   }
   return result;
 }
 
+unsigned long RuntimeDataManager::getPrefixNumber() {
+  return scheduleSet->size();
+}
+
+std::string RuntimeDataManager::getStatisticsRecord() {
+  stringstream ss;
+  ss << allFormulaNum << " " << solvingTimes << " " << allGlobal << " " << brGlobal << " " << satBranch << " "
+     << unSatBranchBySolve << " " << unSatBranchByPreSolve << " "
+     << runningCost << " " << solvingCost << " " << satCost << " " << unSatCost << " " << DTAMCost << " "
+     << PTSCost << " "
+     << redundantPrefix << " " << prunedReadFrom << " "
+     << encodeCost << " " << flipCost << " " << verifyCost << " "
+     << backtrackPoints << " " << sleepSetPruned << " " << boundPruned << " "
+     << constantBranch;
+  return ss.str();
+}
+
+void RuntimeDataManager::mergeStatisticsRecord(std::istream &in) {
+  unsigned formulaNum = 0, solving = 0, all = 0, br = 0, sat = 0, unSatBySolve = 0, unSatByPreSolve = 0;
+  unsigned redundant = 0, pruned = 0;
+  unsigned backtrack = 0, asleep = 0, overBound = 0, constant = 0;
+  double running = 0, solvingTime = 0, satTime = 0, unSatTime = 0, DTAMTime = 0, PTSTime = 0;
+  double encodeTime = 0, flipTime = 0, verifyTime = 0;
+  in >> formulaNum >> solving >> all >> br >> sat >> unSatBySolve >> unSatByPreSolve;
+  in >> running >> solvingTime >> satTime >> unSatTime >> DTAMTime >> PTSTime;
+  in >> redundant >> pruned;
+  in >> encodeTime >> flipTime >> verifyTime;
+  in >> backtrack >> asleep >> overBound >> constant;
+  allFormulaNum += formulaNum;
+  solvingTimes += solving;
+  allGlobal += all;
+  brGlobal += br;
+  satBranch += sat;
+  unSatBranchBySolve += unSatBySolve;
+  unSatBranchByPreSolve += unSatByPreSolve;
+  runningCost += running;
+  solvingCost += solvingTime;
+  satCost += satTime;
+  unSatCost += unSatTime;
+  DTAMCost += DTAMTime;
+  PTSCost += PTSTime;
+  encodeCost += encodeTime;
+  flipCost += flipTime;
+  verifyCost += verifyTime;
+  redundantPrefix += redundant;
+  prunedReadFrom += pruned;
+  backtrackPoints += backtrack;
+  sleepSetPruned += asleep;
+  boundPruned += overBound;
+  constantBranch += constant;
+}
+
 void RuntimeDataManager::printAllPrefix(ostream &out) {
-  out << "num of prefix: " << scheduleSet.size() << endl;
+  vector<Prefix *> prefixes;
+  scheduleSet->getPrefixes(prefixes);
+  out << "num of prefix: " << prefixes.size() << endl;
   unsigned num = 1;
-  for (list<Prefix *>::iterator pi = scheduleSet.begin(), pe = scheduleSet.end(); pi != pe; pi++) {
+  for (vector<Prefix *>::iterator pi = prefixes.begin(), pe = prefixes.end(); pi != pe; pi++) {
     out << "Prefix " << num << endl;
     (*pi)->print(out);
     num++;
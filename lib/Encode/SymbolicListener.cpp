@@ -41,6 +41,9 @@ SymbolicListener::SymbolicListener(Executor *executor, RuntimeDataManager *rdMan
     : BitcodeListener(rdManager), executor(executor), currentEvent(NULL) {
   kind = SymbolicListenerKind;
   kleeBr = false;
+  // the other instructions only need to be executed on the shadow stacks
+  opcodes = {Instruction::Load, Instruction::Store, Instruction::Br, Instruction::Switch, Instruction::Call,
+             Instruction::GetElementPtr, Instruction::PtrToInt};
 }
 
 SymbolicListener::~SymbolicListener() {}
@@ -362,6 +365,12 @@ void SymbolicListener::afterRunMethodAsMain(ExecutionState &state) {
 //消息相应函数，在前缀执行出错之后程序推出之前调用
 void SymbolicListener::executionFailed(ExecutionState &state, KInstruction *ki) {}
 
+BitcodeListener *SymbolicListener::snapshot(map<Event *, Event *> &eventMap) {
+  SymbolicListener *listener = new SymbolicListener(*this);
+  listener->currentEvent = Trace::findCopy(currentEvent, eventMap);
+  return listener;
+}
+
 ref<Expr> SymbolicListener::manualMakeSymbolic(ExecutionState &state, std::string name, unsigned size, bool isFloat) {
 
   //添加新的符号变量
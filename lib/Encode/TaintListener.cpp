@@ -30,6 +30,7 @@
 #include "../Core/Memory.h"
 #include "klee/ADT/Ref.h"
 #include "klee/Encode/Event.h"
+#include "klee/Encode/ListenerTrace.h"
 #include "klee/Encode/TaintListener.h"
 #include "klee/Encode/Trace.h"
 #include "klee/Expr/Expr.h"
@@ -44,6 +45,9 @@ namespace klee {
 TaintListener::TaintListener(Executor *executor, RuntimeDataManager *rdManager)
     : BitcodeListener(rdManager), executor(executor), currentEvent(NULL) {
   kind = TaintListenerKind;
+  // the other instructions only need to be executed on the shadow stacks
+  opcodes = {Instruction::Load, Instruction::Store, Instruction::Br, Instruction::Switch, Instruction::Call,
+             Instruction::GetElementPtr, Instruction::PtrToInt};
 }
 
 TaintListener::~TaintListener() {
@@ -187,9 +191,9 @@ void TaintListener::beforeExecuteInstruction(ExecutionState &state, KInstruction
               ref<Expr> svalue = executor->evalCurrent(ki, j, state).value;
               if (value->isTaint) {
                 svalue->isTaint = true;
-#if DEBUG_RUNTIME_LISTENER
-                llvm::errs() << "svalue->isTaint = true;" << "\n";
-#endif
+                if (ListenerTrace::isTracingDetails(state.currentThread->threadId, ki)) {
+                  ListenerTrace::traceDetails(state.currentThread->threadId, ki, "svalue->isTaint = true;");
+                }
               }
               executor->ineval(ki, j, state, svalue);
             }
@@ -253,9 +257,7 @@ void TaintListener::afterExecuteInstruction(ExecutionState &state, KInstruction
           isFloat = 1;
         }
         if (currentEvent->isGlobal) {
-          for (unsigned i = 0; i < thread->vectorClock.size(); i++) {
-            currentEvent->vectorClock.push_back(thread->vectorClock[i]);
-          }
+          currentEvent->vectorClock = thread->vectorClock;
 #if SUPPORT_PTR
           if (isFloat || id == Type::IntegerTyID || id == Type::PointerTyID) {
 #else
@@ -285,17 +287,17 @@ void TaintListener::afterExecuteInstruction(ExecutionState &state, KInstruction
           manualMakeTaint(value, false);
         }
         executor->getDestCell(state, ki).value = value;
-#if DEBUG_RUNTIME_LISTENER
-        llvm::errs() << value << " taint : " << isTaint << "\n";
-#endif
+        if (ListenerTrace::isTracingDetails(thread->threadId, ki)) {
+          std::string message;
+          llvm::raw_string_ostream os(message);
+          os << value << " taint : " << isTaint;
+          ListenerTrace::traceDetails(thread->threadId, ki, os.str());
+        }
         break;
       }
       case Instruction::Store: {
         if (currentEvent->isGlobal) {
-          for (unsigned i = 0; i < thread->vectorClock.size(); i++) {
-            currentEvent->vectorClock.push_back(thread->vectorClock[i]);
-            // llvm::errs() << "vectorClock " << i << " : " << currentEvent->vectorClock[i] << "\n";
-          }
+          currentEvent->vectorClock = thread->vectorClock;
         }
         break;
       }
@@ -312,9 +314,10 @@ void TaintListener::afterExecuteInstruction(ExecutionState &state, KInstruction
             }
           }
           if (isTaint) {
-#if DEBUG_RUNTIME_LISTENER
-            llvm::errs() << "executor->getDestCell(state, ki).value->isTaint = true;" << "\n";
-#endif
+            if (ListenerTrace::isTracingDetails(thread->threadId, ki)) {
+              ListenerTrace::traceDetails(thread->threadId, ki,
+                                          "executor->getDestCell(state, ki).value->isTaint = true;");
+            }
             executor->getDestCell(state, ki).value->isTaint = true;
           }
         }
@@ -331,15 +334,15 @@ void TaintListener::afterExecuteInstruction(ExecutionState &state, KInstruction
           trace->initTaintSymbolicExpr.insert(currentEvent->globalName);
 
         } else if (f->getName() == "pthread_create") {
-          thread->vectorClock[thread->threadId]++;
+          thread->vectorClock.increment(thread->threadId);
         } else if (f->getName().str() == "pthread_join") {
-          thread->vectorClock[thread->threadId]++;
+          thread->vectorClock.increment(thread->threadId);
         } else if (f->getName().str() == "pthread_cond_wait") {
-          thread->vectorClock[thread->threadId]++;
+          thread->vectorClock.increment(thread->threadId);
         } else if (f->getName().str() == "pthread_cond_signal") {
-          thread->vectorClock[thread->threadId]++;
+          thread->vectorClock.increment(thread->threadId);
         } else if (f->getName().str() == "pthread_cond_broadcast") {
-          thread->vectorClock[thread->threadId]++;
+          thread->vectorClock.increment(thread->threadId);
         } else if (f->getName().str() == "pthread_mutex_lock") {
           //				thread->vectorClock[thread->threadId]++;
         } else if (f->getName().str() == "pthread_mutex_unlock") {
@@ -367,6 +370,12 @@ void TaintListener::afterRunMethodAsMain(ExecutionState &state) {}
 //消息相应函数，在前缀执行出错之后程序推出之前调用
 void TaintListener::executionFailed(ExecutionState &state, KInstruction *ki) {}
 
+BitcodeListener *TaintListener::snapshot(map<Event *, Event *> &eventMap) {
+  TaintListener *listener = new TaintListener(*this);
+  listener->currentEvent = Trace::findCopy(currentEvent, eventMap);
+  return listener;
+}
+
 ref<Expr> TaintListener::manualMakeTaintSymbolic(ExecutionState &state, std::string name, unsigned size) {
 
   //添加新的污染符号变量
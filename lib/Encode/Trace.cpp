@@ -29,7 +29,7 @@ using namespace llvm;
 
 namespace klee {
 
-Trace::Trace() : Id(0), nextEventId(0), eventList(20), isUntested(true) {}
+Trace::Trace() : Id(0), nextEventId(0), eventList(20), isUntested(true), prefixNum(0) {}
 
 Trace::~Trace() {
   for (auto li : all_lock_unlock) {
@@ -42,9 +42,6 @@ Trace::~Trace() {
       delete ei;
     }
   }
-  for (auto event : path) {
-    delete event;
-  }
 }
 
 void Trace::printDetailedInfo(raw_ostream &out) {
@@ -200,12 +197,16 @@ Event *Trace::createEvent(unsigned threadId, KInstruction *inst, uint64_t addres
   }
   ss << time;
   string globalVarFullName = ss.str();
-  return new Event(threadId, nextEventId, "E" + Transfer::uint64toString(nextEventId++), inst, globalVarName,
-                   globalVarFullName, eventType);
+  unsigned eventId = nextEventId++;
+  eventPool.emplace_back(threadId, eventId, "E" + Transfer::uint64toString(eventId), inst, globalVarName,
+                         globalVarFullName, eventType);
+  return &eventPool.back();
 }
 
 Event *Trace::createEvent(unsigned threadId, KInstruction *inst, Event::EventType eventType) {
-  return new Event(threadId, nextEventId, "E" + Transfer::uint64toString(nextEventId++), inst, "", "", eventType);
+  unsigned eventId = nextEventId++;
+  eventPool.emplace_back(threadId, eventId, "E" + Transfer::uint64toString(eventId), inst, "", "", eventType);
+  return &eventPool.back();
 }
 
 void Trace::insertThreadCreateOrJoin(pair<Event *, uint64_t> item, bool isThreadCreate) {
@@ -331,6 +332,130 @@ void Trace::insertGlobalVariableLast(std::string name, Constant *finalValue) {
 
 void Trace::insertPath(Event *event) { path.push_back(event); }
 
+Event *Trace::copyEvent(Event *event, map<Event *, Event *> &eventMap) {
+  if (!event) {
+    return NULL;
+  }
+  auto ei = eventMap.find(event);
+  if (ei != eventMap.end()) {
+    return ei->second;
+  }
+  eventPool.push_back(*event);
+  Event *copy = &eventPool.back();
+  eventMap.insert(make_pair(event, copy));
+  copy->latestWriteEventInSameThread = copyEvent(event->latestWriteEventInSameThread, eventMap);
+  return copy;
+}
+
+Event *Trace::findCopy(Event *event, const map<Event *, Event *> &eventMap) {
+  auto ei = eventMap.find(event);
+  return ei == eventMap.end() ? NULL : ei->second;
+}
+
+static vector<Event *> copyEvents(Trace *trace, const vector<Event *> &events, map<Event *, Event *> &eventMap) {
+  vector<Event *> result;
+  result.reserve(events.size());
+  for (auto event : events) {
+    result.push_back(trace->copyEvent(event, eventMap));
+  }
+  return result;
+}
+
+static map<string, vector<Event *>> copyEvents(Trace *trace, const map<string, vector<Event *>> &events,
+                                               map<Event *, Event *> &eventMap) {
+  map<string, vector<Event *>> result;
+  for (auto &item : events) {
+    result.insert(make_pair(item.first, copyEvents(trace, item.second, eventMap)));
+  }
+  return result;
+}
+
+Trace *Trace::snapshot(map<Event *, Event *> &eventMap) {
+  Trace *trace = new Trace();
+  // copy the path first, so the latest writes are always found in eventMap
+  trace->path = copyEvents(trace, path, eventMap);
+  trace->Id = Id;
+  trace->nextEventId = nextEventId;
+  trace->eventList.clear();
+  for (auto &thread : eventList) {
+    trace->eventList.push_back(copyEvents(trace, thread, eventMap));
+  }
+  trace->abstract = abstract;
+  trace->isUntested = isUntested;
+  trace->traceType = traceType;
+
+  trace->storeSymbolicExpr = storeSymbolicExpr;
+  trace->taintExpr = taintExpr;
+  trace->rwSymbolicExpr = rwSymbolicExpr;
+  trace->brSymbolicExpr = brSymbolicExpr;
+  trace->assertSymbolicExpr = assertSymbolicExpr;
+  trace->pathCondition = pathCondition;
+  trace->pathConditionRelatedToBranch = pathConditionRelatedToBranch;
+  trace->brRelatedSymbolicExpr = brRelatedSymbolicExpr;
+  trace->assertRelatedSymbolicExpr = assertRelatedSymbolicExpr;
+  trace->RelatedSymbolicExpr = RelatedSymbolicExpr;
+  trace->allRelatedSymbolicExprs = allRelatedSymbolicExprs;
+  trace->varThread = varThread;
+  trace->rwEvent = copyEvents(trace, rwEvent, eventMap);
+  trace->brEvent = copyEvents(trace, brEvent, eventMap);
+  trace->assertEvent = copyEvents(trace, assertEvent, eventMap);
+
+  trace->Send_Data_Expr = Send_Data_Expr;
+  trace->initTaintSymbolicExpr = initTaintSymbolicExpr;
+  trace->taintSymbolicExpr = taintSymbolicExpr;
+  trace->unTaintSymbolicExpr = unTaintSymbolicExpr;
+  trace->potentialTaint = potentialTaint;
+  trace->DTAMSerial = DTAMSerial;
+  trace->DTAMParallel = DTAMParallel;
+  trace->DTAMhybrid = DTAMhybrid;
+  trace->PTS = PTS;
+  trace->taintPTS = taintPTS;
+  trace->noTaintPTS = noTaintPTS;
+  trace->taintMap = taintMap;
+  trace->DTAMSerialMap = DTAMSerialMap;
+  trace->DTAMParallelMap = DTAMParallelMap;
+  trace->DTAMhybridMap = DTAMhybridMap;
+
+  for (auto &item : createThreadPoint) {
+    trace->createThreadPoint.insert(make_pair(trace->copyEvent(item.first, eventMap), item.second));
+  }
+  for (auto &item : joinThreadPoint) {
+    trace->joinThreadPoint.insert(make_pair(trace->copyEvent(item.first, eventMap), item.second));
+  }
+  trace->allReadSet = copyEvents(trace, allReadSet, eventMap);
+  trace->allWriteSet = copyEvents(trace, allWriteSet, eventMap);
+  trace->readSet = copyEvents(trace, readSet, eventMap);
+  trace->writeSet = copyEvents(trace, writeSet, eventMap);
+  trace->readSetRelatedToBranch = copyEvents(trace, readSetRelatedToBranch, eventMap);
+  trace->writeSetRelatedToBranch = copyEvents(trace, writeSetRelatedToBranch, eventMap);
+  for (auto &item : all_lock_unlock) {
+    vector<LockPair *> &pairs = trace->all_lock_unlock[item.first];
+    for (auto lp : item.second) {
+      LockPair *copy = new LockPair(*lp);
+      copy->lockEvent = trace->copyEvent(lp->lockEvent, eventMap);
+      copy->unlockEvent = trace->copyEvent(lp->unlockEvent, eventMap);
+      pairs.push_back(copy);
+    }
+  }
+  for (auto &item : all_wait) {
+    vector<Wait_Lock *> &waits = trace->all_wait[item.first];
+    for (auto wl : item.second) {
+      Wait_Lock *copy = new Wait_Lock();
+      copy->wait = trace->copyEvent(wl->wait, eventMap);
+      copy->lock_by_wait = trace->copyEvent(wl->lock_by_wait, eventMap);
+      waits.push_back(copy);
+    }
+  }
+  trace->all_signal = copyEvents(trace, all_signal, eventMap);
+  trace->all_barrier = copyEvents(trace, all_barrier, eventMap);
+
+  trace->global_variable_initializer = global_variable_initializer;
+  trace->global_variable_initializer_RelatedToBranch = global_variable_initializer_RelatedToBranch;
+  trace->global_variable_final = global_variable_final;
+  trace->printf_variable_value = printf_variable_value;
+  return trace;
+}
+
 void Trace::createAbstract() {
   //	std::cerr << "createAbstract\n" ;
   for (unsigned tid = 0; tid < this->eventList.size(); tid++) {
@@ -392,6 +517,37 @@ bool Trace::isEqual(Trace *trace) {
   return same;
 }
 
+// 64-bit FNV-1a with the given offset basis, finished with the splitmix64 mixer so that similar abstracts spread
+// over all bits
+static uint64_t hashAbstract(const std::string &abstract, uint64_t basis) {
+  uint64_t hash = basis;
+  for (unsigned char c : abstract) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebULL;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+TraceFingerprint Trace::getFingerprint() {
+  if (this->abstract.empty()) {
+    this->createAbstract();
+  }
+  // the thread abstracts are hashed one by one and summed up, the sum does not depend on the order of the threads and,
+  // unlike xor, does not cancel out two threads with the same abstract
+  TraceFingerprint fingerprint;
+  for (auto &threadAbstract : this->abstract) {
+    fingerprint.low += hashAbstract(threadAbstract, 0xcbf29ce484222325ULL);
+    fingerprint.high += hashAbstract(threadAbstract, 0x84222325cbf29ce4ULL);
+  }
+  fingerprint.high ^= this->abstract.size();
+  return fingerprint;
+}
+
 std::string Trace::getAssemblyLine(std::string name) {
   std::stringstream varName;
   std::stringstream AssemblyLineName;
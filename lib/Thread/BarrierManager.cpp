@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "klee/Thread/BarrierManager.h"
+#include "klee/Encode/Transfer.h"
 
 #include <iostream>
 
@@ -15,37 +16,38 @@ using namespace ::std;
 
 namespace klee {
 
-BarrierManager::BarrierManager() {}
+BarrierManager::BarrierManager() : barrierIds(make_shared<unordered_map<uint64_t, unsigned>>()) {}
 
-BarrierManager::~BarrierManager() {
-  clear();
-}
+BarrierManager::~BarrierManager() {}
 
-bool BarrierManager::addBarrier(string barrierName, string &errorMsg) {
-  map<string, Barrier *>::iterator bi = barrierPool.find(barrierName);
-  if (bi != barrierPool.end()) {
+bool BarrierManager::addBarrier(uint64_t address, string &errorMsg) {
+  string barrierName = Transfer::uint64toString(address);
+  if (getBarrier(address)) {
     errorMsg = "redefinition of barrier " + barrierName;
     return false;
   } else {
-    Barrier *barrier = new Barrier(barrierName, Barrier::DEFAULTCOUNT);
-    barrierPool.insert(make_pair(barrierName, barrier));
+    if (!barrierIds.unique()) {
+      barrierIds = make_shared<unordered_map<uint64_t, unsigned>>(*barrierIds);
+    }
+    barriers.push_back(Barrier(barrierName, Barrier::DEFAULTCOUNT));
+    barrierIds->insert(make_pair(address, barriers.size()));
     return true;
   }
 }
 
-Barrier *BarrierManager::getBarrier(string barrierName) {
-  map<string, Barrier *>::iterator bi = barrierPool.find(barrierName);
-  if (bi != barrierPool.end()) {
-    return bi->second;
+Barrier *BarrierManager::getBarrier(uint64_t address) {
+  unordered_map<uint64_t, unsigned>::iterator bi = barrierIds->find(address);
+  if (bi != barrierIds->end()) {
+    return &barriers[bi->second - 1];
   } else {
     return NULL;
   }
 }
 
-bool BarrierManager::init(string barrierName, unsigned count, string &errorMsg) {
-  Barrier *barrier = getBarrier(barrierName);
+bool BarrierManager::init(uint64_t address, unsigned count, string &errorMsg) {
+  Barrier *barrier = getBarrier(address);
   if (barrier == NULL) {
-    errorMsg = "barrier " + barrierName + " undefined";
+    errorMsg = "barrier " + Transfer::uint64toString(address) + " undefined";
     return false;
   } else {
     barrier->setCount(count);
@@ -53,11 +55,11 @@ bool BarrierManager::init(string barrierName, unsigned count, string &errorMsg)
   }
 }
 
-bool BarrierManager::wait(std::string barrierName, unsigned threadId, bool &isReleased, vector<unsigned> &blockedList,
+bool BarrierManager::wait(uint64_t address, unsigned threadId, bool &isReleased, vector<unsigned> &blockedList,
                           std::string &errorMsg) {
-  Barrier *barrier = getBarrier(barrierName);
+  Barrier *barrier = getBarrier(address);
   if (barrier == NULL) {
-    errorMsg = "barrier " + barrierName + " undefined";
+    errorMsg = "barrier " + Transfer::uint64toString(address) + " undefined";
     return false;
   } else {
     barrier->wait(threadId);
@@ -73,16 +75,14 @@ bool BarrierManager::wait(std::string barrierName, unsigned threadId, bool &isRe
 }
 
 void BarrierManager::clear() {
-  for (map<string, Barrier *>::iterator bi = barrierPool.begin(), be = barrierPool.end(); bi != be; bi++) {
-    delete bi->second;
-  }
-  barrierPool.clear();
+  barriers.clear();
+  barrierIds = make_shared<unordered_map<uint64_t, unsigned>>();
 }
 
 void BarrierManager::print(ostream &out) {
   out << "barrier pool\n";
-  for (map<string, Barrier *>::iterator bi = barrierPool.begin(), be = barrierPool.end(); bi != be; bi++) {
-    out << bi->first << endl;
+  for (auto &barrier : barriers) {
+    out << barrier.name << endl;
   }
 }
 
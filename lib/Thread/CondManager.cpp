@@ -22,38 +22,38 @@ using namespace ::std;
 
 namespace klee {
 
-bool CondManager::wait(string condName, string mutexName, unsigned threadId, string &errorMsg) {
-  Mutex *mutex = mutexManager->getMutex(mutexName);
+bool CondManager::wait(uint64_t condAddress, uint64_t mutexAddress, unsigned threadId, string &errorMsg) {
+  Mutex *mutex = mutexManager->getMutex(mutexAddress);
   if (mutex == NULL) {
-    errorMsg = "mutex " + mutexName + " undefined";
+    errorMsg = "mutex " + Transfer::uint64toString(mutexAddress) + " undefined";
     return false;
   }
-  Condition *cond = getCondition(condName);
+  Condition *cond = getCondition(condAddress);
   if (cond == NULL) {
-    errorMsg = "condition " + condName + " undefined";
+    errorMsg = "condition " + Transfer::uint64toString(condAddress) + " undefined";
     return false;
   }
   if (!mutex->isThreadOwnMutex(threadId)) {
-    errorMsg = Transfer::uint64toString(threadId) + " does not own mutex " + mutexName;
+    errorMsg = Transfer::uint64toString(threadId) + " does not own mutex " + mutex->name;
     return false;
   } else {
-    WaitParam *wp = new WaitParam(mutexName, threadId);
+    WaitParam *wp = new WaitParam(mutexAddress, threadId);
     cond->wait(wp);
-    return mutexManager->unlock(mutexName, errorMsg);
+    return mutexManager->unlock(mutex, errorMsg);
   }
 }
 
-bool CondManager::signal(string condName, unsigned &releasedThreadId, string &errorMsg) {
-  Condition *cond = getCondition(condName);
+bool CondManager::signal(uint64_t condAddress, unsigned &releasedThreadId, string &errorMsg) {
+  Condition *cond = getCondition(condAddress);
   if (cond == NULL) {
-    errorMsg = "condition " + condName + " undefined";
+    errorMsg = "condition " + Transfer::uint64toString(condAddress) + " undefined";
     return false;
   } else {
     WaitParam *wp = cond->signal();
     if (wp != NULL) {
       releasedThreadId = wp->threadId;
       // change state
-      mutexManager->addBlockedThread(wp->threadId, wp->mutexName);
+      mutexManager->addBlockedThread(wp->threadId, wp->mutexAddress);
       delete wp;
     } else {
       releasedThreadId = 0;
@@ -62,10 +62,10 @@ bool CondManager::signal(string condName, unsigned &releasedThreadId, string &er
   }
 }
 
-bool CondManager::broadcast(string condName, vector<unsigned> &threads, string &errorMsg) {
-  Condition *cond = getCondition(condName);
+bool CondManager::broadcast(uint64_t condAddress, vector<unsigned> &threads, string &errorMsg) {
+  Condition *cond = getCondition(condAddress);
   if (cond == NULL) {
-    errorMsg = "condition " + condName + " undefined";
+    errorMsg = "condition " + Transfer::uint64toString(condAddress) + " undefined";
     return false;
   } else {
     vector<WaitParam *> itemList;
@@ -75,77 +75,96 @@ bool CondManager::broadcast(string condName, vector<unsigned> &threads, string &
     for (vector<WaitParam *>::iterator wi = itemList.begin(), we = itemList.end(); wi != we; wi++, ti++) {
       WaitParam *wp = *wi;
       *ti = wp->threadId;
-      mutexManager->addBlockedThread(wp->threadId, wp->mutexName);
+      mutexManager->addBlockedThread(wp->threadId, wp->mutexAddress);
       delete wp;
     }
     return true;
   }
 }
 
-bool CondManager::addCondition(string condName, string &errorMsg) {
-  Condition *cond = getCondition(condName);
-  if (cond) {
+void CondManager::addCondition(Condition *cond, uint64_t address) {
+  if (!conditionIds.unique()) {
+    conditionIds = make_shared<unordered_map<uint64_t, unsigned>>(*conditionIds);
+  }
+  conditions.push_back(cond);
+  conditionIds->insert(make_pair(address, cond->id));
+}
+
+bool CondManager::addCondition(uint64_t address, string &errorMsg) {
+  string condName = Transfer::uint64toString(address);
+  if (getCondition(address)) {
     errorMsg = "redefinition of condition " + condName;
     return false;
   } else {
-    cond = new Condition(nextConditionId++, condName, CondScheduler::FIFS);
-    pair<string, Condition *> item(condName, cond);
-    condPool.insert(item);
+    addCondition(new Condition(getNextConditionId(), condName, CondScheduler::FIFS), address);
     return true;
   }
 }
 
-bool CondManager::addCondition(string condName, string &errorMsg, Prefix *prefix) {
-  Condition *cond = getCondition(condName);
-  if (cond) {
+bool CondManager::addCondition(uint64_t address, string &errorMsg, Prefix *prefix) {
+  string condName = Transfer::uint64toString(address);
+  if (getCondition(address)) {
     errorMsg = "redefinition of condition " + condName;
     return false;
   } else {
-    cond = new Condition(nextConditionId++, condName, CondScheduler::FIFS, prefix);
-    pair<string, Condition *> item(condName, cond);
-    condPool.insert(item);
+    addCondition(new Condition(getNextConditionId(), condName, CondScheduler::FIFS, prefix), address);
     return true;
   }
 }
 
-Condition *CondManager::getCondition(string condName) {
-  map<string, Condition *>::iterator ci = condPool.find(condName);
-  if (ci == condPool.end()) {
+Condition *CondManager::getCondition(uint64_t address) {
+  unordered_map<uint64_t, unsigned>::iterator ci = conditionIds->find(address);
+  if (ci == conditionIds->end()) {
     return NULL;
   } else {
-    return ci->second;
+    return conditions[ci->second - 1];
   }
 }
 
-CondManager::CondManager() : nextConditionId(1) {
+CondManager::CondManager() : conditionIds(make_shared<unordered_map<uint64_t, unsigned>>()) {
   this->mutexManager = NULL;
 }
 
-CondManager::CondManager(MutexManager *_mutexManaget) : nextConditionId(1) {
+CondManager::CondManager(MutexManager *_mutexManaget)
+    : conditionIds(make_shared<unordered_map<uint64_t, unsigned>>()) {
   this->mutexManager = _mutexManaget;
 }
 
+CondManager::CondManager(const CondManager &other)
+    : conditionIds(other.conditionIds), mutexManager(other.mutexManager) {
+  conditions.reserve(other.conditions.size());
+  for (auto cond : other.conditions) {
+    conditions.push_back(new Condition(*cond));
+  }
+}
+
 CondManager::~CondManager() {
   clear();
 }
 
+void CondManager::guide(Prefix *prefix) {
+  for (auto cond : conditions) {
+    cond->guide(prefix);
+  }
+}
+
 void CondManager::clear() {
-  for (map<string, Condition *>::iterator ci = condPool.begin(), ce = condPool.end(); ci != ce; ci++) {
-    delete ci->second;
+  for (auto cond : conditions) {
+    delete cond;
   }
-  condPool.clear();
-  nextConditionId = 1;
+  conditions.clear();
+  conditionIds = make_shared<unordered_map<uint64_t, unsigned>>();
 }
 
 void CondManager::print(ostream &out) {
   out << "condition pool\n";
-  for (map<string, Condition *>::iterator ci = condPool.begin(), ce = condPool.end(); ci != ce; ci++) {
-    out << ci->first << endl;
+  for (auto cond : conditions) {
+    out << cond->name << endl;
   }
 }
 
 unsigned CondManager::getNextConditionId() {
-  return nextConditionId;
+  return conditions.size() + 1;
 }
 
 } // namespace klee
@@ -42,8 +42,18 @@ CondScheduler::CondScheduler() {}
 
 CondScheduler::~CondScheduler() {}
 
+CondScheduler *CondScheduler::guide(Prefix *prefix) {
+  return new GuidedCondScheduler(this, prefix);
+}
+
 FIFSCondScheduler::FIFSCondScheduler() {}
 
+FIFSCondScheduler::FIFSCondScheduler(const FIFSCondScheduler &other) {
+  for (auto param : other.queue) {
+    queue.push_back(new WaitParam(*param));
+  }
+}
+
 FIFSCondScheduler::~FIFSCondScheduler() {}
 
 WaitParam *FIFSCondScheduler::selectNextItem() {
@@ -105,6 +115,12 @@ void FIFSCondScheduler::printAllItem(ostream &os) {
 
 PreemptiveCondScheduler::PreemptiveCondScheduler() {}
 
+PreemptiveCondScheduler::PreemptiveCondScheduler(const PreemptiveCondScheduler &other) {
+  for (auto param : other.queue) {
+    queue.push_back(new WaitParam(*param));
+  }
+}
+
 PreemptiveCondScheduler::~PreemptiveCondScheduler() {}
 
 WaitParam *PreemptiveCondScheduler::selectNextItem() {
@@ -157,6 +173,10 @@ WaitParam *PreemptiveCondScheduler::removeItem(unsigned threadId) {
   return result;
 }
 
+CondScheduler *FIFSCondScheduler::clone() {
+  return new FIFSCondScheduler(*this);
+}
+
 void PreemptiveCondScheduler::printAllItem(ostream &os) {
   for (list<WaitParam *>::iterator ii = queue.begin(), ie = queue.end(); ii != ie; ii++) {
     os << (*ii)->threadId << " ";
@@ -164,6 +184,13 @@ void PreemptiveCondScheduler::printAllItem(ostream &os) {
   os << endl;
 }
 
+CondScheduler *PreemptiveCondScheduler::clone() {
+  return new PreemptiveCondScheduler(*this);
+}
+
+GuidedCondScheduler::GuidedCondScheduler(CondScheduler *baseScheduler, Prefix *prefix)
+    : baseScheduler(baseScheduler), prefix(prefix) {}
+
 GuidedCondScheduler::GuidedCondScheduler(CondSchedulerType secondarySchedulerType, Prefix *prefix) : prefix(prefix) {
   baseScheduler = getCondSchedulerByType(secondarySchedulerType);
 }
@@ -226,4 +253,13 @@ void GuidedCondScheduler::printAllItem(ostream &os) {
   baseScheduler->printAllItem(os);
 }
 
+CondScheduler *GuidedCondScheduler::clone() {
+  return new GuidedCondScheduler(baseScheduler->clone(), prefix);
+}
+
+CondScheduler *GuidedCondScheduler::guide(Prefix *prefix) {
+  this->prefix = prefix;
+  return this;
+}
+
 } /* namespace klee */
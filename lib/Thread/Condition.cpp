@@ -26,6 +26,10 @@ Condition::Condition(unsigned id, string name, CondScheduler::CondSchedulerType
   waitingList = new GuidedCondScheduler(schedulerType, prefix);
 }
 
+Condition::Condition(const Condition &other) : id(other.id), name(other.name) {
+  waitingList = other.waitingList->clone();
+}
+
 void Condition::wait(WaitParam *waitParam) { waitingList->addItem(waitParam); }
 
 WaitParam *Condition::signal() {
@@ -41,6 +45,10 @@ void Condition::broadcast(vector<WaitParam *> &allWait) {
   waitingList->popAllItem(allWait); 
 }
 
+void Condition::guide(Prefix *prefix) {
+  waitingList = waitingList->guide(prefix);
+}
+
 Condition::~Condition() {
   // release unsignaled thread
   if (!waitingList->isQueueEmpty()) {
@@ -10,18 +10,20 @@
 #include "klee/Thread/MutexManager.h"
 #include "klee/Encode/Transfer.h"
 
+#include <cassert>
+
 using namespace ::std;
 
 namespace klee {
 
-MutexManager::MutexManager() : nextMutexId(1) {}
+MutexManager::MutexManager() : mutexIds(make_shared<unordered_map<uint64_t, unsigned>>()) {}
 
 MutexManager::~MutexManager() { clear(); }
 
-bool MutexManager::lock(string mutexName, unsigned threadId, bool &isBlocked, string &errorMsg) {
-  Mutex *mutex = getMutex(mutexName);
+bool MutexManager::lock(uint64_t address, unsigned threadId, bool &isBlocked, string &errorMsg) {
+  Mutex *mutex = getMutex(address);
   if (!mutex) {
-    errorMsg = "mutex " + mutexName + " undefined";
+    errorMsg = "mutex " + Transfer::uint64toString(address) + " undefined";
     return false;
   } else {
     return lock(mutex, threadId, isBlocked, errorMsg);
@@ -31,12 +33,12 @@ bool MutexManager::lock(string mutexName, unsigned threadId, bool &isBlocked, st
 bool MutexManager::lock(Mutex *mutex, unsigned threadId, bool &isBlocked, string &errorMsg) {
   if (mutex->isMutexLocked()) {
     // mutex->addToBlockedList(thread);
-    blockedThreadPool.insert(make_pair(threadId, mutex));
+    blockedThreadPool.insert(make_pair(threadId, mutex->id));
     isBlocked = true;
   } else {
     mutex->lock(threadId);
     isBlocked = false;
-    map<unsigned, Mutex *>::iterator ti = blockedThreadPool.find(threadId);
+    map<unsigned, unsigned>::iterator ti = blockedThreadPool.find(threadId);
     if (ti != blockedThreadPool.end()) {
       blockedThreadPool.erase(ti);
       // mutex->removeFromBlockedList(thread);
@@ -45,10 +47,10 @@ bool MutexManager::lock(Mutex *mutex, unsigned threadId, bool &isBlocked, string
   return true;
 }
 
-bool MutexManager::unlock(string mutexName, string &errorMsg) {
-  Mutex *mutex = getMutex(mutexName);
+bool MutexManager::unlock(uint64_t address, string &errorMsg) {
+  Mutex *mutex = getMutex(address);
   if (!mutex) {
-    errorMsg = "mutex " + mutexName + " undefined";
+    errorMsg = "mutex " + Transfer::uint64toString(address) + " undefined";
     return false;
   } else {
     return unlock(mutex, errorMsg);
@@ -68,58 +70,58 @@ bool MutexManager::unlock(Mutex *mutex, string &errorMsg) {
   }
 }
 
-bool MutexManager::addMutex(string mutexName, string &errorMsg) {
-  Mutex *mutex = getMutex(mutexName);
-  if (mutex) {
+bool MutexManager::addMutex(uint64_t address, string &errorMsg) {
+  string mutexName = Transfer::uint64toString(address);
+  if (getMutex(address)) {
     errorMsg = "redefinition of mutex " + mutexName;
     return false;
   } else {
-    mutex = new Mutex(nextMutexId++, mutexName);
-    mutexPool.insert(make_pair(mutexName, mutex));
+    if (!mutexIds.unique()) {
+      mutexIds = make_shared<unordered_map<uint64_t, unsigned>>(*mutexIds);
+    }
+    mutexes.push_back(Mutex(mutexes.size() + 1, mutexName));
+    mutexIds->insert(make_pair(address, mutexes.size()));
     return true;
   }
 }
 
-Mutex *MutexManager::getMutex(string mutexName) {
-  map<string, Mutex *>::iterator mi = mutexPool.find(mutexName);
-  if (mi == mutexPool.end()) {
+Mutex *MutexManager::getMutex(uint64_t address) {
+  unordered_map<uint64_t, unsigned>::iterator mi = mutexIds->find(address);
+  if (mi == mutexIds->end()) {
     return NULL;
   } else {
-    return mi->second;
+    return &mutexes[mi->second - 1];
   }
 }
 
 void MutexManager::clear() {
-  for (map<string, Mutex *>::iterator mi = mutexPool.begin(), me = mutexPool.end(); mi != me; mi++) {
-    delete mi->second;
-  }
-  mutexPool.clear();
+  mutexes.clear();
+  mutexIds = make_shared<unordered_map<uint64_t, unsigned>>();
   blockedThreadPool.clear();
-  nextMutexId = 1;
 }
 
 void MutexManager::print(ostream &out) {
   out << "mutex pool\n";
-  for (map<string, Mutex *>::iterator mi = mutexPool.begin(), me = mutexPool.end(); mi != me; mi++) {
-    out << mi->first << endl;
+  for (auto &mutex : mutexes) {
+    out << mutex.name << endl;
   }
 }
 
-unsigned MutexManager::getNextMutexId() { return nextMutexId; }
+unsigned MutexManager::getNextMutexId() { return mutexes.size() + 1; }
 
-void MutexManager::addBlockedThread(unsigned threadId, std::string mutexName) {
-  Mutex *mutex = getMutex(mutexName);
+void MutexManager::addBlockedThread(unsigned threadId, uint64_t address) {
+  Mutex *mutex = getMutex(address);
   assert(mutex);
-  blockedThreadPool.insert(make_pair(threadId, mutex));
+  blockedThreadPool.insert(make_pair(threadId, mutex->id));
 }
 
 bool MutexManager::tryToLockForBlockedThread(unsigned threadId, bool &isBlocked, string &errorMsg) {
-  map<unsigned, Mutex *>::iterator mi = blockedThreadPool.find(threadId);
+  map<unsigned, unsigned>::iterator mi = blockedThreadPool.find(threadId);
   if (mi == blockedThreadPool.end()) {
     errorMsg = "thread " + Transfer::uint64toString(threadId) + " does not blocked for mutex";
     return false;
   } else {
-    Mutex *mutex = mi->second;
+    Mutex *mutex = &mutexes[mi->second - 1];
     return lock(mutex, threadId, isBlocked, errorMsg);
   }
 }
@@ -0,0 +1,81 @@
+//===-- ReadyQueue.cpp ------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Thread/ReadyQueue.h"
+#include "klee/Thread/ThreadList.h"
+
+#include <cassert>
+
+namespace klee {
+
+ReadyQueue::ReadyQueue() : threads(1, nullptr), next(1, 0), prev(1, 0), count(0) {}
+
+void ReadyQueue::reserve(unsigned threadId) {
+  if (threadId < threads.size()) {
+    return;
+  }
+  unsigned size = threadId + 1 > 2 * threads.size() ? threadId + 1 : 2 * threads.size();
+  threads.resize(size, nullptr);
+  next.resize(size, 0);
+  prev.resize(size, 0);
+}
+
+void ReadyQueue::link(unsigned threadId, unsigned position) {
+  unsigned before = prev[position];
+  next[before] = threadId;
+  prev[threadId] = before;
+  next[threadId] = position;
+  prev[position] = threadId;
+  count++;
+}
+
+void ReadyQueue::pushBack(Thread *thread) {
+  insertBefore(nullptr, thread);
+}
+
+void ReadyQueue::pushFront(Thread *thread) {
+  insertBefore(empty() ? nullptr : front(), thread);
+}
+
+void ReadyQueue::insertBefore(Thread *position, Thread *thread) {
+  assert(thread->threadId && "thread id 0 is the head of the queue");
+  reserve(thread->threadId);
+  assert(!threads[thread->threadId] && "the thread is queued already");
+  assert((!position || contains(position)) && "the position is not queued");
+  threads[thread->threadId] = thread;
+  link(thread->threadId, position ? position->threadId : 0);
+}
+
+void ReadyQueue::remove(Thread *thread) {
+  if (!contains(thread)) {
+    return;
+  }
+  unsigned threadId = thread->threadId;
+  next[prev[threadId]] = next[threadId];
+  prev[next[threadId]] = prev[threadId];
+  threads[threadId] = nullptr;
+  count--;
+}
+
+void ReadyQueue::clear() {
+  for (unsigned threadId = next[0]; threadId; threadId = next[threadId]) {
+    threads[threadId] = nullptr;
+  }
+  next[0] = prev[0] = 0;
+  count = 0;
+}
+
+void ReadyQueue::rebind(ThreadList &threadList) {
+  for (unsigned threadId = next[0]; threadId; threadId = next[threadId]) {
+    threads[threadId] = threadList.findThreadById(threadId);
+    assert(threads[threadId] && "the queued thread is not in the thread list");
+  }
+}
+
+} // namespace klee
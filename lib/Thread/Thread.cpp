@@ -13,10 +13,7 @@ namespace klee {
 
 Thread::Thread(unsigned threadId, Thread *parentThread, KFunction *kf, AddressSpace *addressSpace)
     : pc(kf->instructions), prevPC(pc), incomingBBIndex(0), threadId(threadId), parentThread(parentThread),
-      threadState(Thread::RUNNABLE), addressSpace(addressSpace) {
-  for (unsigned i = 0; i < 17; i++) {
-    vectorClock.push_back(0);
-  }
+      threadState(Thread::RUNNABLE), addressSpace(addressSpace), refCount(1) {
   stack = new StackType(addressSpace);
   stack->realStack.reserve(10);
   stack->pushFrame(0, kf);
@@ -25,11 +22,9 @@ Thread::Thread(unsigned threadId, Thread *parentThread, KFunction *kf, AddressSp
 Thread::Thread(Thread &anotherThread, AddressSpace *addressSpace)
     : pc(anotherThread.pc), prevPC(anotherThread.prevPC), incomingBBIndex(anotherThread.incomingBBIndex),
       threadId(anotherThread.threadId), parentThread(anotherThread.parentThread),
-      threadState(anotherThread.threadState), addressSpace(addressSpace) {
+      threadState(anotherThread.threadState), addressSpace(addressSpace), vectorClock(anotherThread.vectorClock),
+      refCount(1) {
   stack = new StackType(addressSpace, anotherThread.stack);
-  for (unsigned i = 0; i < 17; i++) {
-    vectorClock.push_back(0);
-  }
 }
 
 Thread::Thread(const Thread& other) 
@@ -40,7 +35,8 @@ Thread::Thread(const Thread& other)
       parentThread(other.parentThread), //  Проверьте, нужно ли копировать или просто присвоить указатель
       threadState(other.threadState),
       addressSpace(other.addressSpace), // Проверьте, нужно ли копировать или просто присвоить указатель
-      vectorClock(other.vectorClock) // Копируем vectorClock
+      vectorClock(other.vectorClock), // Копируем vectorClock
+      refCount(1)
 {
     stack = new StackType(*other.stack); // Глубокое копирование StackType
 }
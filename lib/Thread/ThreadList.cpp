@@ -9,6 +9,7 @@
 
 #include "klee/Thread/ThreadList.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -17,26 +18,27 @@ namespace klee {
 
 ThreadList::ThreadList() : threadNum(0) {
   allThreads.resize(20, nullptr);
-  index.reserve(20);
 }
 
 ThreadList::~ThreadList() = default;
 
 ThreadList::iterator ThreadList::begin() { return iterator(this); }
 
-ThreadList::iterator ThreadList::end() { return iterator(this, threadNum); }
+ThreadList::iterator ThreadList::end() { return iterator(this, allThreads.size()); }
 
 ThreadList::iterator ThreadList::begin() const { return iterator(const_cast<ThreadList*>(this)); }
 
-ThreadList::iterator ThreadList::end() const { return iterator(const_cast<ThreadList*>(this), threadNum); }
+ThreadList::iterator ThreadList::end() const {
+  return iterator(const_cast<ThreadList*>(this), allThreads.size());
+}
 
 void ThreadList::addThread(Thread* thread) {
     if (allThreads.size() <= thread->threadId) {
-        allThreads.resize(thread->threadId * 2, nullptr);
+        // geometric growth, a thread pool creates threads one by one
+        allThreads.resize(std::max<size_t>(thread->threadId + 1, 2 * allThreads.size()), nullptr);
     }
     assert(!allThreads[thread->threadId] && "Thread with this ID already exists");
     allThreads[thread->threadId] = thread;
-    index.push_back(thread->threadId);
     threadNum++;
 }
 
@@ -63,30 +65,40 @@ Thread* ThreadList::findThreadById(unsigned threadId) {
 int ThreadList::getThreadNum() { return threadNum; }
 
 Thread* ThreadList::getLastThread() {
-    if (!index.empty()) {
-        return allThreads[index.back()];
-    } else {
-        return nullptr;  //  Или  бросьте  исключение
+    for (unsigned threadId = allThreads.size(); threadId > 0; threadId--) {
+        if (allThreads[threadId - 1]) {
+            return allThreads[threadId - 1];
+        }
     }
+    return nullptr;
 }
 
 // --- ThreadList::iterator ---
 
-ThreadList::iterator::iterator(ThreadList* threadList, unsigned pos) : threadList(threadList), currentPos(pos) {}
+ThreadList::iterator::iterator(ThreadList* threadList, unsigned pos) : threadList(threadList), currentPos(pos) {
+    skipEmpty();
+}
+
+void ThreadList::iterator::skipEmpty() {
+    while (currentPos < threadList->allThreads.size() && !threadList->allThreads[currentPos]) {
+        ++currentPos;
+    }
+}
 
 ThreadList::iterator& ThreadList::iterator::operator++() {
     ++currentPos;
+    skipEmpty();
     return *this;
 }//итератор префа
 
 ThreadList::iterator ThreadList::iterator::operator++(int) {
     iterator temp(*this);  // Создаем копию текущего состояния итератора
-    ++currentPos;          // Инкрементируем текущий итератор
+    ++*this;               // Инкрементируем текущий итератор
     return temp;          // Возвращаем копию до инкремента
 }
 
 Thread*& ThreadList::iterator::operator*() {
-    return threadList->allThreads[threadList->index[currentPos]];
+    return threadList->allThreads[currentPos];
 }
 
 bool ThreadList::iterator::operator==(const iterator& another) const {
@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 
@@ -44,6 +45,10 @@ ThreadScheduler* getThreadSchedulerByType(ThreadScheduler::ThreadSchedulerType t
     }
   }   
 }
+ThreadScheduler *ThreadScheduler::guide(ExecutionState *state, Prefix *prefix) {
+  return new GuidedThreadScheduler(state, this, prefix);
+}
+
 //ThreadScheduler::ThreadScheduler() {}
 
 //ThreadScheduler::~ThreadScheduler() {}
@@ -52,28 +57,21 @@ RRThreadScheduler::RRThreadScheduler() {
   count = 0;
 }
 
-// 拷贝构造，没用
-RRThreadScheduler::RRThreadScheduler(const RRThreadScheduler &scheduler) : count(scheduler.count) {
-  for (Thread *thread : scheduler.queue) {
-    queue.push_back(new Thread(*thread)); // Глубокое копирование
-  }
-}
-
-/*RRThreadScheduler::~RRThreadScheduler() {
-  for (Thread* thread : queue) {
-    delete thread;
-  }
-}*/
-
 ThreadScheduler::ThreadSchedulerType RRThreadScheduler::getType() const { return ThreadScheduler::RR; }
-const std::list<Thread*>& RRThreadScheduler::getQueue() const { return queue; }
+const ReadyQueue &RRThreadScheduler::getQueue() const { return queue; }
 ThreadScheduler* RRThreadScheduler::clone() const { return new RRThreadScheduler(*this); }
 
-void RRThreadScheduler::setQueue(std::list<Thread*> newQueue) {
-  queue = std::move(newQueue); // используем std::move для эффективности
+void RRThreadScheduler::rebind(ThreadList &threadList) {
+  queue.rebind(threadList);
+}
+
+void RRThreadScheduler::promote(Thread *item) {
+  if (queue.contains(item)) {
+    queue.remove(item);
+    queue.pushFront(item);
+  }
 }
 
-// 考虑使用迭代器而不是front();
 Thread *RRThreadScheduler::selectCurrentItem() {
   return queue.front();
 }
@@ -88,8 +86,8 @@ Thread *RRThreadScheduler::selectNextItem() {
 
 void RRThreadScheduler::popAllItem(vector<Thread *> &allItem) {
   allItem.reserve(queue.size());
-  for (list<Thread *>::iterator ti = queue.begin(), te = queue.end(); ti != te; ti++) {
-    allItem.push_back(*ti);
+  for (Thread *thread : queue) {
+    allItem.push_back(thread);
   }
   queue.clear();
 }
@@ -103,21 +101,15 @@ bool RRThreadScheduler::isSchedulerEmpty() {
 }
 
 void RRThreadScheduler::addItem(Thread *item) {
-  queue.push_back(item);
+  queue.pushBack(item);
 }
 
 void RRThreadScheduler::removeItem(Thread *item) {
-  for (list<Thread *>::iterator ti = queue.begin(), te = queue.end(); ti != te; ti++) {
-    if (*ti == item) {
-      queue.erase(ti);
-      break;
-    }
-  }
+  queue.remove(item);
 }
 
-void RRThreadScheduler::printAllItem(ostream &os) {
-  for (list<Thread *>::iterator ti = queue.begin(), te = queue.end(); ti != te; ti++) {
-    Thread *thread = *ti;
+static void printQueue(const ReadyQueue &queue, ostream &os) {
+  for (Thread *thread : queue) {
     os << thread->threadId << " state: " << thread->threadState
        << " current inst: " << thread->pc->inst->getOpcodeName() << " ";
     if (thread->threadState == Thread::TERMINATED) {
@@ -128,10 +120,14 @@ void RRThreadScheduler::printAllItem(ostream &os) {
   }
 }
 
+void RRThreadScheduler::printAllItem(ostream &os) {
+  printQueue(queue, os);
+}
+
 void RRThreadScheduler::reSchedule() {
   Thread *thread = queue.front();
-  queue.pop_front();
-  queue.push_back(thread);
+  queue.remove(thread);
+  queue.pushBack(thread);
   count = 0;
 }
 
@@ -141,24 +137,19 @@ void RRThreadScheduler::setCountZero() {
 
 FIFSThreadScheduler::FIFSThreadScheduler() {}
 
-FIFSThreadScheduler::FIFSThreadScheduler(const FIFSThreadScheduler& scheduler) {  // <<< ДОБАВЛЕНО
-  for (Thread* thread : scheduler.queue) {
-    queue.push_back(new Thread(*thread)); // Глубокое копирование
-  }
-}
-
-/*FIFSThreadScheduler::~FIFSThreadScheduler() {
-  for (Thread* thread : queue) {
-    delete thread;
-  }
-}*/
-
 ThreadScheduler::ThreadSchedulerType FIFSThreadScheduler::getType() const { return ThreadScheduler::FIFS; }
-const std::list<Thread*>& FIFSThreadScheduler::getQueue() const { return queue; }
+const ReadyQueue &FIFSThreadScheduler::getQueue() const { return queue; }
 ThreadScheduler* FIFSThreadScheduler::clone() const { return new FIFSThreadScheduler(*this); }
 
-void FIFSThreadScheduler::setQueue(std::list<Thread*> newQueue) {
-  queue = std::move(newQueue); 
+void FIFSThreadScheduler::rebind(ThreadList &threadList) {
+  queue.rebind(threadList);
+}
+
+void FIFSThreadScheduler::promote(Thread *item) {
+  if (queue.contains(item)) {
+    queue.remove(item);
+    queue.pushFront(item);
+  }
 }
 
 Thread *FIFSThreadScheduler::selectCurrentItem() {
@@ -171,8 +162,8 @@ Thread *FIFSThreadScheduler::selectNextItem() {
 
 void FIFSThreadScheduler::popAllItem(vector<Thread *> &allItem) {
   allItem.reserve(queue.size());
-  for (list<Thread *>::iterator ti = queue.begin(), te = queue.end(); ti != te; ti++) {
-    allItem.push_back(*ti);
+  for (Thread *thread : queue) {
+    allItem.push_back(thread);
   }
   queue.clear();
 }
@@ -186,57 +177,38 @@ bool FIFSThreadScheduler::isSchedulerEmpty() {
 }
 
 void FIFSThreadScheduler::addItem(Thread *item) {
-  queue.push_back(item);
+  queue.pushBack(item);
 }
 
 void FIFSThreadScheduler::removeItem(Thread *item) {
-  for (list<Thread *>::iterator ti = queue.begin(), te = queue.end(); ti != te; ti++) {
-    if (*ti == item) {
-      queue.erase(ti);
-      break;
-    }
-  }
+  queue.remove(item);
 }
 
 void FIFSThreadScheduler::printAllItem(ostream &os) {
-  for (list<Thread *>::iterator ti = queue.begin(), te = queue.end(); ti != te; ti++) {
-    Thread *thread = *ti;
-    os << thread->threadId << " state: " << thread->threadState
-       << " current inst: " << thread->pc->inst->getOpcodeName() << " ";
-    if (thread->threadState == Thread::TERMINATED) {
-      KInstruction *ki = thread->pc;
-      os << ki->info->file << " " << ki->info->line;
-    }
-    os << endl;
-  }
+  printQueue(queue, os);
 }
 
 void FIFSThreadScheduler::reSchedule() {
   Thread *thread = queue.front();
-  queue.pop_front();
-  queue.push_back(thread);
+  queue.remove(thread);
+  queue.pushBack(thread);
 }
 
 PreemptiveThreadScheduler::PreemptiveThreadScheduler() {}
 
-PreemptiveThreadScheduler::PreemptiveThreadScheduler(const PreemptiveThreadScheduler& scheduler) { // <<< ДОБАВЛЕНО
-  for (Thread* thread : scheduler.queue) {
-    queue.push_back(new Thread(*thread)); // Глубокое копирование
-  }
-}
-
-/*PreemptiveThreadScheduler::~PreemptiveThreadScheduler() {
-  for (Thread* thread : queue) {
-    delete thread;
-  }
-}*/
-
 ThreadScheduler::ThreadSchedulerType PreemptiveThreadScheduler::getType() const { return ThreadScheduler::Preemptive; }
-const std::list<Thread*>& PreemptiveThreadScheduler::getQueue() const { return queue; }
+const ReadyQueue &PreemptiveThreadScheduler::getQueue() const { return queue; }
 ThreadScheduler* PreemptiveThreadScheduler::clone() const { return new PreemptiveThreadScheduler(*this); }
 
-void PreemptiveThreadScheduler::setQueue(std::list<Thread*> newQueue) {
-  queue = std::move(newQueue);
+void PreemptiveThreadScheduler::rebind(ThreadList &threadList) {
+  queue.rebind(threadList);
+}
+
+void PreemptiveThreadScheduler::promote(Thread *item) {
+  if (queue.contains(item)) {
+    queue.remove(item);
+    queue.pushBack(item);
+  }
 }
 
 Thread *PreemptiveThreadScheduler::selectCurrentItem() {
@@ -249,8 +221,8 @@ Thread *PreemptiveThreadScheduler::selectNextItem() {
 
 void PreemptiveThreadScheduler::popAllItem(std::vector<Thread *> &allItem) {
   allItem.reserve(queue.size());
-  for (list<Thread *>::iterator ti = queue.begin(), te = queue.end(); ti != te; ti++) {
-    allItem.push_back(*ti);
+  for (Thread *thread : queue) {
+    allItem.push_back(thread);
   }
   queue.clear();
 }
@@ -264,22 +236,147 @@ bool PreemptiveThreadScheduler::isSchedulerEmpty() {
 }
 
 void PreemptiveThreadScheduler::addItem(Thread *item) {
-  queue.push_back(item);
+  queue.pushBack(item);
 }
 
 void PreemptiveThreadScheduler::removeItem(Thread *item) {
-  for (list<Thread *>::iterator ti = queue.begin(), te = queue.end(); ti != te; ti++) {
-    if (*ti == item) {
-      queue.erase(ti);
+  queue.remove(item);
+}
+
+void PreemptiveThreadScheduler::printAllItem(std::ostream &os) {
+  printQueue(queue, os);
+}
+
+void PreemptiveThreadScheduler::reSchedule() {
+  // the last thread goes right before the one which was queued before it
+  if (queue.size() < 2) {
+    return;
+  }
+  Thread *thread = queue.back();
+  queue.remove(thread);
+  queue.insertBefore(queue.back(), thread);
+}
+
+PCTThreadScheduler::PCTThreadScheduler(unsigned seed, unsigned depth, uint64_t steps)
+    : theRNG(seed), seed(seed), depth(depth), nextChangePoint(0), step(0), skipped(0), rescheduled(false),
+      lastThreadId(0) {
+  for (unsigned i = 1; i < depth; i++) {
+    changePoints.push_back(1 + theRNG.getInt32() % (steps ? steps : 1));
+  }
+  sort(changePoints.begin(), changePoints.end());
+}
+
+ThreadScheduler::ThreadSchedulerType PCTThreadScheduler::getType() const { return ThreadScheduler::PCT; }
+const ReadyQueue &PCTThreadScheduler::getQueue() const { return queue; }
+ThreadScheduler* PCTThreadScheduler::clone() const { return new PCTThreadScheduler(*this); }
+
+void PCTThreadScheduler::rebind(ThreadList &threadList) {
+  queue.rebind(threadList);
+}
+
+void PCTThreadScheduler::promote(Thread *item) {
+  // the priorities decide
+}
+
+void PCTThreadScheduler::insertByPriority(Thread *thread) {
+  uint64_t priority = priorities[thread->threadId];
+  // the first thread of a lower priority
+  auto position = byPriority.upper_bound(priority);
+  queue.insertBefore(position == byPriority.end() ? nullptr : queue.find(position->second), thread);
+  byPriority.emplace_hint(position, priority, thread->threadId);
+}
+
+void PCTThreadScheduler::removeByPriority(Thread *thread) {
+  if (!queue.contains(thread)) {
+    return;
+  }
+  auto range = byPriority.equal_range(priorities[thread->threadId]);
+  for (auto pi = range.first; pi != range.second; pi++) {
+    if (pi->second == thread->threadId) {
+      byPriority.erase(pi);
       break;
     }
   }
+  queue.remove(thread);
 }
 
-void PreemptiveThreadScheduler::printAllItem(std::ostream &os) {
-  for (list<Thread *>::iterator ti = queue.begin(), te = queue.end(); ti != te; ti++) {
-    Thread *thread = *ti;
-    os << thread->threadId << " state: " << thread->threadState
+Thread *PCTThreadScheduler::getSelected() {
+  if (queue.empty()) {
+    return nullptr;
+  }
+  ReadyQueue::iterator ti = queue.begin();
+  for (unsigned i = skipped % queue.size(); i; i--) {
+    ++ti;
+  }
+  lastThreadId = (*ti)->threadId;
+  return *ti;
+}
+
+Thread *PCTThreadScheduler::selectCurrentItem() {
+  return getSelected();
+}
+
+Thread *PCTThreadScheduler::selectNextItem() {
+  if (rescheduled) {
+    // the same step, the thread before is blocked
+    rescheduled = false;
+    return getSelected();
+  }
+  skipped = 0;
+  step++;
+  while (nextChangePoint < changePoints.size() && changePoints[nextChangePoint] <= step) {
+    // the thread which ran the step before drops below every initial priority, it is not queued any more if it has
+    // blocked or terminated since
+    Thread *running = lastThreadId ? queue.find(lastThreadId) : queue.front();
+    unsigned runningId = running ? running->threadId : lastThreadId;
+    if (running) {
+      removeByPriority(running);
+    }
+    if (runningId && runningId < priorities.size()) {
+      priorities[runningId] = nextChangePoint + 1;
+    }
+    nextChangePoint++;
+    if (running) {
+      insertByPriority(running);
+    }
+  }
+  return getSelected();
+}
+
+void PCTThreadScheduler::popAllItem(std::vector<Thread *> &allItem) {
+  allItem.reserve(queue.size());
+  for (Thread *thread : queue) {
+    allItem.push_back(thread);
+  }
+  queue.clear();
+  byPriority.clear();
+}
+
+int PCTThreadScheduler::itemNum() {
+  return queue.size();
+}
+
+bool PCTThreadScheduler::isSchedulerEmpty() {
+  return queue.empty();
+}
+
+void PCTThreadScheduler::addItem(Thread *item) {
+  if (priorities.size() <= item->threadId) {
+    priorities.resize(item->threadId + 1, 0);
+  }
+  if (!priorities[item->threadId]) {
+    priorities[item->threadId] = depth + (uint64_t)theRNG.getInt32();
+  }
+  insertByPriority(item);
+}
+
+void PCTThreadScheduler::removeItem(Thread *item) {
+  removeByPriority(item);
+}
+
+void PCTThreadScheduler::printAllItem(std::ostream &os) {
+  for (Thread *thread : queue) {
+    os << thread->threadId << " state: " << thread->threadState << " priority: " << priorities[thread->threadId]
        << " current inst: " << thread->pc->inst->getOpcodeName() << " ";
     if (thread->threadState == Thread::TERMINATED) {
       KInstruction *ki = thread->pc;
@@ -289,21 +386,21 @@ void PreemptiveThreadScheduler::printAllItem(std::ostream &os) {
   }
 }
 
-void PreemptiveThreadScheduler::reSchedule() {
-  Thread *thread = queue.back();
-  queue.pop_back();
-  list<Thread *>::iterator ti = queue.end();
-  ti--;
-  queue.insert(ti, thread);
+void PCTThreadScheduler::reSchedule() {
+  skipped++;
+  rescheduled = true;
 }
 
 GuidedThreadScheduler::GuidedThreadScheduler(ExecutionState *state, ThreadSchedulerType schedulerType, Prefix *prefix)
-    : prefix(prefix), state(state) {
+    : prefix(prefix), state(state), resumed(false) {
   subScheduler = getThreadSchedulerByType(schedulerType);
 }
 
+GuidedThreadScheduler::GuidedThreadScheduler(ExecutionState *state, ThreadScheduler *subScheduler, Prefix *prefix)
+    : prefix(prefix), subScheduler(subScheduler), state(state), resumed(false) {}
+
 GuidedThreadScheduler::GuidedThreadScheduler(const GuidedThreadScheduler &other) 
-    : prefix(other.prefix), state(other.state) {
+    : prefix(other.prefix), state(other.state), resumed(other.resumed) {
   subScheduler = other.subScheduler->clone();
 }
 
@@ -312,7 +409,7 @@ ThreadScheduler::ThreadSchedulerType GuidedThreadScheduler::getType() const { //
   return subScheduler->getType();
 }
 
-const std::list<Thread*>& GuidedThreadScheduler::getQueue() const {
+const ReadyQueue &GuidedThreadScheduler::getQueue() const {
   assert(subScheduler && "subScheduler is null");
   return subScheduler->getQueue();
 }
@@ -327,13 +424,19 @@ ThreadScheduler* GuidedThreadScheduler::clone() const {
     subScheduler = nullptr;
 }*/
 
-void GuidedThreadScheduler::setQueue(std::list<Thread*> newQueue) {
+void GuidedThreadScheduler::rebind(ThreadList &threadList) {
+  subScheduler->rebind(threadList);
+}
 
-    std::list<Thread*> copiedQueue;
-    for (Thread* thread : newQueue) {
-        copiedQueue.push_back(new Thread(*thread));  // Создаем новые копии потоков
-    }
-    subScheduler->setQueue(std::move(copiedQueue)); //  Обновляем очередь подпланировщика
+void GuidedThreadScheduler::promote(Thread *item) {
+  subScheduler->promote(item);
+}
+
+ThreadScheduler *GuidedThreadScheduler::guide(ExecutionState *state, Prefix *prefix) {
+  this->state = state;
+  this->prefix = prefix;
+  resumed = false;
+  return this;
 }
 
 Thread *GuidedThreadScheduler::selectCurrentItem() {
@@ -346,6 +449,14 @@ Thread *GuidedThreadScheduler::selectNextItem() {
     unsigned threadId = prefix->getCurrentEventThreadId();
     thread = state->findThreadById(threadId);
   } else {
+    if (!resumed && prefix->getBound() >= 0 && !prefix->getEventList()->empty()) {
+      // a bounded schedule keeps running the thread it switched to, going back to the queue front would be another
+      // preemption the bound does not count
+      resumed = true;
+      if (Thread *last = state->findThreadById(prefix->getEventList()->back()->threadId)) {
+        subScheduler->promote(last);
+      }
+    }
     thread = subScheduler->selectNextItem();
   }
   return thread;
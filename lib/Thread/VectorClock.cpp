@@ -0,0 +1,78 @@
+//===-- VectorClock.cpp -----------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Thread/VectorClock.h"
+
+#include <algorithm>
+
+namespace klee {
+
+std::vector<unsigned> &VectorClock::getWritable(unsigned size) {
+  if (!clock) {
+    clock = std::make_shared<std::vector<unsigned>>(size, 0);
+  } else if (clock.use_count() > 1) {
+    clock = std::make_shared<std::vector<unsigned>>(*clock);
+  }
+  if (clock->size() < size) {
+    clock->resize(size, 0);
+  }
+  return *clock;
+}
+
+void VectorClock::increment(unsigned threadId) {
+  getWritable(threadId + 1)[threadId]++;
+}
+
+void VectorClock::join(const VectorClock &other) {
+  if (!other.clock || clock == other.clock) {
+    return;
+  }
+  if (!clock) {
+    clock = other.clock;
+    return;
+  }
+  unsigned n = other.clock->size();
+  const unsigned *b = other.clock->data();
+  // check before copying a shared clock, joining an older clock changes nothing
+  bool changes = clock->size() < n;
+  for (unsigned i = 0, e = std::min<unsigned>(n, clock->size()); i < e && !changes; i++) {
+    changes = (*clock)[i] < b[i];
+  }
+  if (!changes) {
+    return;
+  }
+  unsigned *a = getWritable(n).data();
+  for (unsigned i = 0; i < n; i++) {
+    a[i] = std::max(a[i], b[i]);
+  }
+}
+
+bool VectorClock::happensBefore(const VectorClock &other) const {
+  if (clock == other.clock) {
+    return false;
+  }
+  unsigned sizeA = size(), sizeB = other.size();
+  unsigned n = std::min(sizeA, sizeB);
+  const unsigned *a = n ? clock->data() : NULL, *b = n ? other.clock->data() : NULL;
+  // no early exit, so the loop over the common components is vectorized
+  bool less = false, greater = false;
+  for (unsigned i = 0; i < n; i++) {
+    less |= a[i] < b[i];
+    greater |= a[i] > b[i];
+  }
+  for (unsigned i = n; i < sizeA; i++) {
+    greater |= (*clock)[i] != 0;
+  }
+  for (unsigned i = n; i < sizeB; i++) {
+    less |= (*other.clock)[i] != 0;
+  }
+  return less && !greater;
+}
+
+} /* namespace klee */
@@ -15,8 +15,8 @@ namespace klee {
 
 WaitParam::WaitParam() {}
 
-WaitParam::WaitParam(string mutexName, unsigned threadId) {
-  this->mutexName = mutexName;
+WaitParam::WaitParam(uint64_t mutexAddress, unsigned threadId) {
+  this->mutexAddress = mutexAddress;
   this->threadId = threadId;
 }
 
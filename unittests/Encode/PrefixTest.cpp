@@ -0,0 +1,147 @@
+//===-- PrefixTest.cpp ------------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Encode/Prefix.h"
+#include "klee/Encode/PrefixTrie.h"
+#include "klee/Module/InstructionInfoTable.h"
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace klee;
+
+namespace {
+
+// the instructions a prefix refers to by InstructionInfo::id, without a module
+class PrefixTest : public ::testing::Test {
+protected:
+  std::string file;
+  std::vector<std::unique_ptr<InstructionInfo>> infos;
+  std::vector<std::unique_ptr<KInstruction>> owned;
+  std::vector<KInstruction *> instructions;
+
+  void SetUp() override {
+    for (unsigned id = 0; id < 4; id++) {
+      infos.emplace_back(new InstructionInfo(id, file, 0, 0, 0));
+      owned.emplace_back(new KInstruction());
+      owned.back()->inst = nullptr;
+      owned.back()->info = infos.back().get();
+      owned.back()->operands = nullptr;
+      instructions.push_back(owned.back().get());
+    }
+  }
+};
+
+TEST_F(PrefixTest, SleepSetRoundTrip) {
+  Event first(1, 0, "E0", instructions[1], "", "", Event::NORMAL);
+  Event second(2, 1, "E1", instructions[3], "", "", Event::NORMAL);
+  second.isConditionInst = true;
+  second.brCondition = true;
+  std::vector<Event *> events = {&first, &second};
+  std::map<Event *, uint64_t> threadIdMap = {{&first, 2}};
+  Prefix prefix(events, threadIdMap, "Trace1-dpor-E0-T2");
+  prefix.setBound(3);
+  // the empty object of a joining thread must not swallow the next field
+  prefix.getSleepSet().push_back(SleepingThread{3, "", false, 4});
+  prefix.getSleepSet().push_back(SleepingThread{4, "counter", true, 0});
+
+  std::stringstream ss;
+  prefix.serialize(ss);
+  std::unique_ptr<Prefix> copy(Prefix::deserialize(ss, instructions));
+  ASSERT_NE(copy, nullptr);
+  EXPECT_EQ(copy->getName(), "Trace1-dpor-E0-T2");
+  EXPECT_EQ(copy->getBound(), 3);
+
+  std::vector<Event *> &copied = *copy->getEventList();
+  ASSERT_EQ(copied.size(), 2u);
+  EXPECT_EQ(copied[0]->threadId, 1u);
+  EXPECT_EQ(copied[0]->inst, instructions[1]);
+  EXPECT_EQ(copied[1]->inst, instructions[3]);
+  EXPECT_TRUE(copied[1]->isConditionInst);
+  EXPECT_TRUE(copied[1]->brCondition);
+  EXPECT_EQ(copy->getNextThreadId(), 2u);
+
+  std::vector<SleepingThread> &sleepSet = copy->getSleepSet();
+  ASSERT_EQ(sleepSet.size(), 2u);
+  EXPECT_EQ(sleepSet[0].threadId, 3u);
+  EXPECT_EQ(sleepSet[0].object, "");
+  EXPECT_FALSE(sleepSet[0].isWrite);
+  EXPECT_EQ(sleepSet[0].joined, 4u);
+  EXPECT_EQ(sleepSet[1].threadId, 4u);
+  EXPECT_EQ(sleepSet[1].object, "counter");
+  EXPECT_TRUE(sleepSet[1].isWrite);
+  EXPECT_EQ(sleepSet[1].joined, 0u);
+}
+
+TEST_F(PrefixTest, RejectsUnknownInstruction) {
+  Event event(1, 0, "E0", instructions[2], "", "", Event::NORMAL);
+  std::vector<Event *> events = {&event};
+  std::map<Event *, uint64_t> threadIdMap;
+  Prefix prefix(events, threadIdMap, "Trace1");
+
+  std::stringstream ss;
+  prefix.serialize(ss);
+  instructions.resize(2);
+  EXPECT_EQ(Prefix::deserialize(ss, instructions), nullptr);
+}
+
+TEST_F(PrefixTest, DuplicateIntersectsSleepSet) {
+  Event first(1, 0, "E0", instructions[1], "", "", Event::NORMAL);
+  Event second(2, 1, "E1", instructions[2], "", "", Event::NORMAL);
+  std::vector<Event *> events = {&first, &second};
+  std::map<Event *, uint64_t> threadIdMap;
+  Prefix *scheduled = new Prefix(events, threadIdMap, "Trace1-dpor-E0-T2");
+  scheduled->getSleepSet().push_back(SleepingThread{3, "x", true, 0});
+  scheduled->getSleepSet().push_back(SleepingThread{4, "y", false, 0});
+  Prefix duplicate(events, threadIdMap, "Trace2-dpor-E0-T2");
+  duplicate.getSleepSet().push_back(SleepingThread{4, "y", false, 0});
+  duplicate.getSleepSet().push_back(SleepingThread{5, "z", true, 0});
+
+  PrefixTrie trie;
+  EXPECT_TRUE(trie.addPrefix(scheduled));
+  EXPECT_FALSE(trie.addPrefix(&duplicate));
+  ASSERT_EQ(scheduled->getSleepSet().size(), 1u);
+  EXPECT_EQ(scheduled->getSleepSet()[0].threadId, 4u);
+
+  // once the scheduled prefix has left the schedule set, a duplicate no longer touches it
+  EXPECT_TRUE(trie.takePrefix(scheduled));
+  delete scheduled;
+  EXPECT_FALSE(trie.addPrefix(&duplicate));
+}
+
+TEST_F(PrefixTest, LowerBoundDuplicateIsScheduled) {
+  Event first(1, 0, "E0", instructions[1], "", "", Event::NORMAL);
+  Event second(2, 1, "E1", instructions[2], "", "", Event::NORMAL);
+  std::vector<Event *> events = {&first, &second};
+  std::map<Event *, uint64_t> threadIdMap;
+  Prefix *higher = new Prefix(events, threadIdMap, "Trace1-preemption2-E0-T2");
+  higher->setBound(2);
+  Prefix *lower = new Prefix(events, threadIdMap, "Trace2-preemption1-E0-T2");
+  lower->setBound(1);
+  Prefix same(events, threadIdMap, "Trace3-preemption1-E0-T2");
+  same.setBound(1);
+
+  PrefixTrie trie;
+  EXPECT_TRUE(trie.addPrefix(higher));
+  // the bounded exploration goes on further from the same path within a lower bound
+  EXPECT_TRUE(trie.addPrefix(lower));
+  EXPECT_FALSE(trie.addPrefix(&same));
+  // the duplicate of the higher bound is dropped when it is taken
+  EXPECT_FALSE(trie.takePrefix(higher));
+  EXPECT_TRUE(trie.takePrefix(lower));
+  delete higher;
+  delete lower;
+}
+
+} // namespace
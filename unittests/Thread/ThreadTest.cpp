@@ -0,0 +1,170 @@
+//===-- ThreadTest.cpp ------------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/ADT/RNG.h"
+#include "klee/Module/KModule.h"
+#include "klee/Thread/ReadyQueue.h"
+#include "klee/Thread/Thread.h"
+#include "klee/Thread/ThreadList.h"
+#include "klee/Thread/ThreadScheduler.h"
+
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <vector>
+
+using namespace klee;
+
+namespace {
+
+// threads 1..4 running an empty function, without a module or an address space
+class ThreadTest : public ::testing::Test {
+protected:
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> module;
+  std::unique_ptr<KFunction> kf;
+  std::vector<std::unique_ptr<Thread>> owned;
+  // thread id -> thread, threads[0] is NULL
+  std::vector<Thread *> threads;
+
+  void SetUp() override {
+    module.reset(new llvm::Module("ThreadTest", context));
+    llvm::Function *f = llvm::Function::Create(llvm::FunctionType::get(llvm::Type::getVoidTy(context), false),
+                                               llvm::Function::ExternalLinkage, "run", module.get());
+    llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", f));
+    builder.CreateRetVoid();
+    kf.reset(new KFunction(f, nullptr));
+    threads.push_back(nullptr);
+    for (unsigned threadId = 1; threadId <= 4; threadId++) {
+      owned.emplace_back(new Thread(threadId, nullptr, kf.get(), nullptr));
+      threads.push_back(owned.back().get());
+    }
+  }
+
+  static std::vector<unsigned> getIds(const ReadyQueue &queue) {
+    std::vector<unsigned> ids;
+    for (Thread *thread : queue) {
+      ids.push_back(thread->threadId);
+    }
+    return ids;
+  }
+
+  // the threads a PCT scheduler selects for the given number of steps
+  std::vector<unsigned> runPCT(unsigned seed, unsigned steps) {
+    PCTThreadScheduler scheduler(seed, 3, steps);
+    for (unsigned threadId = 1; threadId <= 4; threadId++) {
+      scheduler.addItem(threads[threadId]);
+    }
+    std::vector<unsigned> schedule;
+    for (unsigned step = 0; step < steps; step++) {
+      schedule.push_back(scheduler.selectNextItem()->threadId);
+    }
+    return schedule;
+  }
+};
+
+TEST_F(ThreadTest, ReadyQueueInsertRemove) {
+  ReadyQueue queue;
+  EXPECT_TRUE(queue.empty());
+  queue.pushBack(threads[1]);
+  queue.pushBack(threads[2]);
+  queue.pushFront(threads[3]);
+  queue.insertBefore(threads[2], threads[4]);
+  EXPECT_EQ(getIds(queue), std::vector<unsigned>({3, 1, 4, 2}));
+  EXPECT_EQ(queue.size(), 4u);
+  EXPECT_EQ(queue.front(), threads[3]);
+  EXPECT_EQ(queue.back(), threads[2]);
+  EXPECT_EQ(queue.find(4), threads[4]);
+
+  queue.remove(threads[4]);
+  queue.remove(threads[3]);
+  EXPECT_EQ(getIds(queue), std::vector<unsigned>({1, 2}));
+  EXPECT_FALSE(queue.contains(threads[4]));
+  EXPECT_EQ(queue.find(4), nullptr);
+  // removing a thread which is not queued does nothing
+  queue.remove(threads[4]);
+  EXPECT_EQ(queue.size(), 2u);
+
+  queue.pushFront(threads[4]);
+  EXPECT_EQ(getIds(queue), std::vector<unsigned>({4, 1, 2}));
+}
+
+TEST_F(ThreadTest, ReadyQueueClear) {
+  ReadyQueue queue;
+  queue.pushBack(threads[2]);
+  queue.pushBack(threads[1]);
+  queue.clear();
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.begin(), queue.end());
+  EXPECT_FALSE(queue.contains(threads[2]));
+
+  queue.pushBack(threads[1]);
+  queue.pushBack(threads[2]);
+  EXPECT_EQ(getIds(queue), std::vector<unsigned>({1, 2}));
+}
+
+TEST_F(ThreadTest, ReadyQueueRebind) {
+  ReadyQueue queue;
+  queue.pushBack(threads[3]);
+  queue.pushBack(threads[1]);
+
+  // the copied threads of another state, with the same ids
+  ThreadList threadList;
+  std::vector<std::unique_ptr<Thread>> copies;
+  for (unsigned threadId = 1; threadId <= 4; threadId++) {
+    copies.emplace_back(new Thread(*threads[threadId], nullptr));
+    threadList.addThread(copies.back().get());
+  }
+  ReadyQueue copy(queue);
+  copy.rebind(threadList);
+  EXPECT_EQ(getIds(copy), std::vector<unsigned>({3, 1}));
+  EXPECT_EQ(copy.front(), copies[2].get());
+  EXPECT_EQ(copy.back(), copies[0].get());
+  EXPECT_FALSE(copy.contains(threads[3]));
+  // the original still refers to its own threads
+  EXPECT_EQ(queue.front(), threads[3]);
+}
+
+TEST_F(ThreadTest, PCTSeedReproducesSchedule) {
+  EXPECT_EQ(runPCT(7, 50), runPCT(7, 50));
+  bool differs = false;
+  for (unsigned seed = 1; seed <= 10 && !differs; seed++) {
+    differs = runPCT(seed, 50) != runPCT(seed + 1, 50);
+  }
+  EXPECT_TRUE(differs);
+}
+
+TEST_F(ThreadTest, PCTChangePointLowersRunningThread) {
+  // a seed whose single change point of depth 2 over 2 steps is at step 2, drawn as the scheduler draws it
+  unsigned seed = 1;
+  while (RNG(seed).getInt32() % 2 != 1) {
+    seed++;
+  }
+  PCTThreadScheduler scheduler(seed, 2, 2);
+  for (unsigned threadId = 1; threadId <= 3; threadId++) {
+    scheduler.addItem(threads[threadId]);
+  }
+  Thread *first = scheduler.selectNextItem();
+  // the first thread blocks, the next one runs step 1
+  scheduler.reSchedule();
+  Thread *running = scheduler.selectNextItem();
+  ASSERT_NE(first, running);
+  // the thread which ran step 1 drops below the others, not the front of the queue
+  EXPECT_EQ(scheduler.selectNextItem(), first);
+  EXPECT_EQ(scheduler.getQueue().back(), running);
+}
+
+} // namespace